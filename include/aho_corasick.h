@@ -0,0 +1,58 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Counts every occurrence of several patterns in one pass over a text.  Each
+ * state keeps all 256 transitions, so scanning costs one table lookup per
+ * byte; the pattern sets are small enough that the tables stay small.  Matching
+ * folds ascii case, and empty patterns never match.
+ */
+class aho_corasick_t {
+	std::vector<std::array<uint32_t, 256>> m_next;
+	std::vector<uint32_t> m_fail;
+	// The patterns ending exactly at each state
+	std::vector<std::vector<size_t>> m_outputs;
+	// Breadth first, so counts fold from longer to shorter suffixes by walking it backwards
+	std::vector<uint32_t> m_order;
+	size_t m_pattern_count;
+
+  public:
+	explicit aho_corasick_t( std::vector<std::string> const &patterns );
+	~aho_corasick_t( ) = default;
+	aho_corasick_t( aho_corasick_t const & ) = default;
+	aho_corasick_t( aho_corasick_t && ) = default;
+	aho_corasick_t &operator=( aho_corasick_t const & ) = default;
+	aho_corasick_t &operator=( aho_corasick_t && ) = default;
+
+	size_t pattern_count( ) const noexcept;
+	// Occurrences of each pattern, by index, overlapping ones included
+	std::vector<size_t> count( boost::string_view text ) const;
+}; // aho_corasick_t
@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "string_hash.h"
+
+struct asset_bundle_error : public std::runtime_error {
+	explicit asset_bundle_error( std::string const &message );
+	~asset_bundle_error( );
+	asset_bundle_error( asset_bundle_error const & ) = default;
+	asset_bundle_error( asset_bundle_error && ) = default;
+	asset_bundle_error &operator=( asset_bundle_error const & ) = default;
+	asset_bundle_error &operator=( asset_bundle_error && ) = default;
+}; // asset_bundle_error
+
+// Views into the bundle they came from
+struct asset_t {
+	boost::string_view data;
+	boost::string_view mime_type;
+	// Strong, quoted, e.g. "\"0123456789abcdef\""
+	boost::string_view etag;
+}; // asset_t
+
+/**
+ * A directory of files packed into one image so it can be served from RAM.
+ * Layout, offsets from the start of the image and in host byte order:
+ *   asset_bundle_header_t
+ *   record_t[asset_count]
+ *   strings: names, mime types and etags
+ *   file data, each file 16 byte aligned
+ * Mime types and etags are worked out when packing.  A bundle read from a file
+ * is one heap allocation; a bundle over memory that is already loaded, such as
+ * one built into the binary, is not copied at all.
+ */
+class asset_bundle_t {
+	std::vector<char> m_arena;
+	boost::string_view m_image;
+	std::unordered_map<boost::string_view, asset_t, string_view_hash_t> m_assets;
+
+	void read_index( );
+
+  public:
+	// Reads the whole file, throws asset_bundle_error if it is not a bundle
+	explicit asset_bundle_t( std::string const &path );
+	// image must outlive the bundle
+	explicit asset_bundle_t( boost::string_view image );
+	~asset_bundle_t( );
+
+	// Assets are views into m_arena
+	asset_bundle_t( asset_bundle_t const & ) = delete;
+	asset_bundle_t( asset_bundle_t && ) = delete;
+	asset_bundle_t &operator=( asset_bundle_t const & ) = delete;
+	asset_bundle_t &operator=( asset_bundle_t && ) = delete;
+
+	// name is relative to the packed directory with / separators, e.g. css/site.css
+	boost::optional<asset_t> find( boost::string_view name ) const;
+	size_t size( ) const noexcept;
+	// Bytes held in memory
+	size_t image_size( ) const noexcept;
+}; // asset_bundle_t
+
+// Packs every regular file below directory into bundle_file
+void write_asset_bundle( std::string const &directory, std::string const &bundle_file );
+
+// The bundle image built in with -DASSET_BUNDLE=<file>, empty without one
+boost::string_view get_builtin_asset_bundle( );
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <daw/json/daw_json_link.h>
+
+/**
+ * The automation socket speaks newline delimited json, one request or
+ * response per line.  Requests may be pipelined; each response carries the id
+ * of its request.
+ *
+ *   {"id":1,"command":"navigate","argument":"https://example.com/"}
+ *   {"id":1,"is_ok":true,"result":"https://example.com/","error":""}
+ */
+enum class automation_command_t : uint8_t {
+	navigate,
+	run_script,
+	get_page_source,
+	get_page_text,
+	find,
+	set_zoom,
+	// The navigation latency histograms as json, see navigation_timing_snapshot_t
+	get_navigation_timing
+};
+
+boost::optional<automation_command_t> parse_automation_command( boost::string_view name );
+
+struct automation_request_t : public daw::json::JsonLink<automation_request_t> {
+	// Chosen by the client, echoed in the response
+	int64_t id;
+	std::string command;
+	// The url, script, search text or zoom level, depending on command
+	std::string argument;
+
+	automation_request_t( );
+	automation_request_t( int64_t request_id, std::string request_command, std::string request_argument );
+	automation_request_t( automation_request_t const &other );
+	automation_request_t( automation_request_t &&other );
+	automation_request_t &operator=( automation_request_t const &rhs );
+	automation_request_t &operator=( automation_request_t &&rhs );
+	~automation_request_t( );
+
+  private:
+	void link_json( );
+}; // automation_request_t
+
+struct automation_response_t : public daw::json::JsonLink<automation_response_t> {
+	int64_t id;
+	bool is_ok;
+	std::string result;
+	std::string error;
+
+	automation_response_t( );
+	automation_response_t( int64_t response_id, bool response_is_ok, std::string response_result,
+	                       std::string response_error );
+	automation_response_t( automation_response_t const &other );
+	automation_response_t( automation_response_t &&other );
+	automation_response_t &operator=( automation_response_t const &rhs );
+	automation_response_t &operator=( automation_response_t &&rhs );
+	~automation_response_t( );
+
+  private:
+	void link_json( );
+}; // automation_response_t
+
+automation_response_t make_automation_result( int64_t id, std::string result );
+automation_response_t make_automation_error( int64_t id, std::string error );
+
+// The response as one line, '\n' terminated
+std::string to_automation_line( automation_response_t const &response );
+
+// Splits a byte stream into lines
+class automation_line_reader_t {
+	std::string m_buffer;
+	size_t m_max_line_size;
+
+  public:
+	explicit automation_line_reader_t( size_t max_line_size );
+	~automation_line_reader_t( ) = default;
+	automation_line_reader_t( automation_line_reader_t const & ) = default;
+	automation_line_reader_t( automation_line_reader_t && ) = default;
+	automation_line_reader_t &operator=( automation_line_reader_t const & ) = default;
+	automation_line_reader_t &operator=( automation_line_reader_t && ) = default;
+
+	// Appends each line data completes to lines, without its line ending.  False
+	// once a line grows past max_line_size, the stream cannot be resynchronised
+	bool append( char const *data, size_t size, std::vector<std::string> &lines );
+}; // automation_line_reader_t
@@ -0,0 +1,93 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <wx/wx.h>
+
+#include <wx/socket.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "automation_protocol.h"
+
+// Sends the response to the connection the request came in on.  Safe to call
+// after the connection has closed, the response is then dropped
+//
+// The response is taken by value so an in process caller can keep its result without a copy
+using automation_reply_t = std::function<void( automation_response_t response )>;
+
+/**
+ * Accepts automation clients on a unix domain socket.  Every complete request
+ * line is handed to on_request as it arrives, without waiting for earlier
+ * requests to be answered; the handler replies when it is done.  Sockets are
+ * non blocking and driven by socket events, so a slow client only stalls
+ * itself.  GUI thread only.
+ */
+class automation_server_t : public wxEvtHandler {
+  public:
+	using request_handler_t = std::function<void( automation_request_t request, automation_reply_t reply )>;
+
+  private:
+	struct socket_deleter_t {
+		void operator( )( wxSocketBase *socket ) const;
+	};
+	using socket_ptr_t = std::unique_ptr<wxSocketBase, socket_deleter_t>;
+
+	struct connection_t {
+		socket_ptr_t socket;
+		automation_line_reader_t reader;
+		// Written as the socket accepts it
+		std::string output;
+	};
+
+	std::string m_path;
+	request_handler_t m_on_request;
+	std::unique_ptr<wxSocketServer, socket_deleter_t> m_server;
+	// By id rather than socket, a reply for a closed connection must not find a newer one
+	std::unordered_map<uint64_t, connection_t> m_connections;
+	uint64_t m_next_id;
+
+	void OnServerEvent( wxSocketEvent &evt );
+	void OnConnectionEvent( wxSocketEvent &evt );
+	void read( uint64_t id );
+	void send( uint64_t id, automation_response_t const &response );
+	void flush( uint64_t id );
+	void close( uint64_t id );
+
+  public:
+	automation_server_t( std::string path, request_handler_t on_request );
+	// Closes every connection and removes the socket file
+	~automation_server_t( ) override;
+
+	automation_server_t( automation_server_t const & ) = delete;
+	automation_server_t( automation_server_t && ) = delete;
+	automation_server_t &operator=( automation_server_t const & ) = delete;
+	automation_server_t &operator=( automation_server_t && ) = delete;
+
+	// Replaces a stale socket file at path.  False when the socket cannot be created
+	bool start( );
+}; // automation_server_t
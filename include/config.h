@@ -22,17 +22,27 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <boost/utility/string_view.hpp>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <daw/json/daw_json_link.h>
 
+#include "lru_cache.h"
+
 struct url_validation_t : public daw::json::JsonLink<url_validation_t> {
+	enum class kind_t : uint8_t { exact, regex, prefix };
+
 	bool is_regex;
+	// "exact", "regex" or "prefix".  is_regex = true always means regex
+	std::string match;
 	std::string url;
 
+	kind_t kind( ) const;
+
 	url_validation_t( );
 	url_validation_t( url_validation_t const &other );
 	url_validation_t( url_validation_t &&other );
@@ -44,10 +54,14 @@ struct url_validation_t : public daw::json::JsonLink<url_validation_t> {
 	void link_json( );
 }; // url_validation_t
 
+class url_validator_engine_t;
+
 struct config_t : public daw::json::JsonLink<config_t> {
 	std::string app_icon;
 	std::string app_title;
 	std::string home_url;
+	// Packed assets served by the memory: scheme, relative to the config file.  See --pack-bundle
+	std::string asset_bundle;
 	bool enable_clipboard;
 	bool enable_command_line;
 	bool enable_debug_window;
@@ -62,9 +76,40 @@ struct config_t : public daw::json::JsonLink<config_t> {
 	bool enable_view_source;
 	bool enable_view_text;
 	bool enable_zoom;
+	// Number of recent is_valid_url verdicts to remember, 0 disables the cache
+	int64_t url_cache_size;
+	// Bytes kept by the cache: scheme handler on disk, 0 disables storing
+	int64_t page_cache_size;
+	// Larger responses are served but not stored
+	int64_t page_cache_entry_size;
+	// Likely next pages to warm into the page cache after each load, 0 disables prefetch
+	int64_t prefetch_pages;
+	// Bytes per minute prefetch may download
+	int64_t prefetch_bandwidth;
+	// Hidden webviews kept ready for new frames, 0 creates each one when needed
+	int64_t webview_pool_size;
+	// Background tabs kept live beyond this many are suspended, 0 for no limit
+	int64_t max_live_tabs;
+	// Resident bytes of the browser and its content processes past which background
+	// tabs are suspended, 0 for no limit
+	int64_t tab_memory_limit;
+	// With --supervise, resident bytes past which a site process is restarted, 0 for no limit
+	int64_t child_memory_limit;
+	// With --supervise, percent of a core a site process may keep using before it is restarted, 0 for no limit
+	int64_t child_cpu_limit;
 	std::vector<url_validation_t> url_validators;
 
 	bool is_valid_url( boost::string_view url ) const;
+	// Cheap verdict from exact, prefix and cached entries.  Empty when a regex
+	// validator must run, see evaluate_url
+	boost::optional<bool> fast_url_verdict( boost::string_view url ) const;
+	// The expensive half of is_valid_url, safe to call from a worker thread
+	bool evaluate_url( boost::string_view url ) const;
+	lru_cache_stats_t url_cache_stats( ) const;
+
+	// Rebuild the lookup structures and verdict cache for url_validators.  Call
+	// after loading or changing url_validators or url_cache_size
+	void compile_url_validators( );
 
 	config_t( );
 	config_t( config_t const &other );
@@ -74,6 +119,8 @@ struct config_t : public daw::json::JsonLink<config_t> {
 	~config_t( );
 
   private:
+	std::shared_ptr<url_validator_engine_t const> m_url_engine;
+
 	void link_json( );
 };
 
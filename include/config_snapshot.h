@@ -0,0 +1,89 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "config.h"
+
+/**
+ * Binary image of a config_t that is mapped rather than parsed at startup.
+ *
+ * Layout, all offsets from the start of the file and in host byte order:
+ *   config_snapshot_header_t
+ *   string_ref_t[string_count]         app_icon, app_title, home_url, asset_bundle, then urls
+ *   validator_record_t[validator_count] grouped exact, prefix, regex
+ *   string data
+ *
+ * The header records the size and an FNV-1a hash of the bytes of the json
+ * config it was built from; a snapshot only counts as current while those
+ * still match.  The url validators are stored as text and compiled on load.
+ */
+struct config_snapshot_header_t {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t file_size;
+	uint64_t source_hash;
+	uint64_t source_size;
+	uint32_t flags;
+	uint32_t string_count;
+	uint32_t validator_count;
+	uint32_t reserved;
+	int64_t url_cache_size;
+	int64_t page_cache_size;
+	int64_t page_cache_entry_size;
+	int64_t prefetch_pages;
+	int64_t prefetch_bandwidth;
+	int64_t webview_pool_size;
+	int64_t max_live_tabs;
+	int64_t tab_memory_limit;
+	int64_t child_memory_limit;
+	int64_t child_cpu_limit;
+	uint64_t strings_offset;
+	uint64_t validators_offset;
+	uint64_t string_data_offset;
+	uint64_t string_data_size;
+}; // config_snapshot_header_t
+
+struct config_snapshot_error : public std::runtime_error {
+	explicit config_snapshot_error( std::string const &message );
+	~config_snapshot_error( );
+	config_snapshot_error( config_snapshot_error const & ) = default;
+	config_snapshot_error( config_snapshot_error && ) = default;
+	config_snapshot_error &operator=( config_snapshot_error const & ) = default;
+	config_snapshot_error &operator=( config_snapshot_error && ) = default;
+}; // config_snapshot_error
+
+std::string get_config_snapshot_file( std::string const &config_file );
+
+void write_config_snapshot( config_t const &config, std::string const &config_file,
+                            std::string const &snapshot_file );
+
+// Throws config_snapshot_error if the file is not a valid snapshot of this version
+config_t read_config_snapshot( std::string const &snapshot_file );
+
+// True when snapshot_file exists and was built from the current config_file
+bool is_config_snapshot_current( std::string const &snapshot_file, std::string const &config_file );
@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+
+#include "config.h"
+
+#define WBA_FEATURE_OFF 0
+#define WBA_FEATURE_ON 1
+#define WBA_FEATURE_RUNTIME 2
+
+#include "feature_profile.h"
+
+// For #if around code that only exists when a feature can be enabled,
+// e.g. #if WBA_HAS_FEATURE( ZOOM )
+#define WBA_HAS_FEATURE( name ) ( WBA_FEATURE_##name != WBA_FEATURE_OFF )
+
+enum class feature_state_t : uint8_t { off = WBA_FEATURE_OFF, on = WBA_FEATURE_ON, runtime = WBA_FEATURE_RUNTIME };
+
+/**
+ * The feature profile chosen at build time.  Only runtime features consult
+ * the config file, so checks against on and off features fold to constants
+ */
+namespace features {
+	constexpr feature_state_t const clipboard = static_cast<feature_state_t>( WBA_FEATURE_CLIPBOARD );
+	constexpr feature_state_t const command_line = static_cast<feature_state_t>( WBA_FEATURE_COMMAND_LINE );
+	constexpr feature_state_t const debug_window = static_cast<feature_state_t>( WBA_FEATURE_DEBUG_WINDOW );
+	constexpr feature_state_t const edit = static_cast<feature_state_t>( WBA_FEATURE_EDIT );
+	constexpr feature_state_t const navigation = static_cast<feature_state_t>( WBA_FEATURE_NAVIGATION );
+	constexpr feature_state_t const printing = static_cast<feature_state_t>( WBA_FEATURE_PRINTING );
+	constexpr feature_state_t const reload = static_cast<feature_state_t>( WBA_FEATURE_RELOAD );
+	constexpr feature_state_t const search = static_cast<feature_state_t>( WBA_FEATURE_SEARCH );
+	constexpr feature_state_t const select = static_cast<feature_state_t>( WBA_FEATURE_SELECT );
+	constexpr feature_state_t const title_change = static_cast<feature_state_t>( WBA_FEATURE_TITLE_CHANGE );
+	constexpr feature_state_t const toolbar = static_cast<feature_state_t>( WBA_FEATURE_TOOLBAR );
+	constexpr feature_state_t const view_source = static_cast<feature_state_t>( WBA_FEATURE_VIEW_SOURCE );
+	constexpr feature_state_t const view_text = static_cast<feature_state_t>( WBA_FEATURE_VIEW_TEXT );
+	constexpr feature_state_t const zoom = static_cast<feature_state_t>( WBA_FEATURE_ZOOM );
+} // namespace features
+
+// The state of a feature, indexed by config_denied_exception_kind
+feature_state_t get_feature_state( config_denied_exception_kind kind ) noexcept;
+
+constexpr bool is_enabled( feature_state_t state, bool config_value ) noexcept {
+	return state == feature_state_t::on || ( state == feature_state_t::runtime && config_value );
+}
+
+// Overwrite the enable_* values of features that are fixed at build time
+void apply_feature_profile( config_t &config );
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct find_options_t {
+	bool is_match_case;
+	bool is_whole_word;
+}; // find_options_t
+
+struct find_result_t {
+	size_t count;
+	// Byte offsets into the utf-8 text of the first matches, see max_find_positions
+	std::vector<size_t> positions;
+}; // find_result_t
+
+constexpr size_t const max_find_positions = 10000;
+
+// Offsets of the non overlapping matches of needle, up to max_positions of them, and the count of all.
+// Horspool, with memchr for a single byte needle.  Word boundaries are ascii; bytes of multibyte
+// characters count as word characters
+size_t find_all( boost::string_view haystack, boost::string_view needle, bool is_whole_word,
+                 std::vector<size_t> &positions, size_t max_positions );
+
+/**
+ * Searches a plain text snapshot of a page on a worker thread, so find as you
+ * type does not run the webview's own search for every keystroke.  Only the
+ * most recent search waits to run, a newer one replaces it.  Case folding is
+ * ascii only.
+ */
+class find_engine_t {
+  public:
+	// Called on the worker, marshal back to the GUI thread before touching widgets
+	using callback_t = std::function<void( find_result_t result )>;
+
+  private:
+	struct job_t {
+		std::string pattern;
+		find_options_t options;
+		callback_t on_result;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	boost::optional<job_t> m_job;
+	std::shared_ptr<std::string const> m_text;
+	bool m_is_stopping;
+	// Only touched by the worker.  The lower cased copy of m_folded_source
+	std::shared_ptr<std::string const> m_folded_source;
+	std::string m_folded;
+	std::thread m_worker;
+
+	void worker( );
+
+  public:
+	find_engine_t( );
+	// Joins the worker after the search running, if any.  A waiting search is dropped
+	~find_engine_t( );
+
+	find_engine_t( find_engine_t const & ) = delete;
+	find_engine_t( find_engine_t && ) = delete;
+	find_engine_t &operator=( find_engine_t const & ) = delete;
+	find_engine_t &operator=( find_engine_t && ) = delete;
+
+	// The utf-8 text later searches run over
+	void set_text( std::string text );
+	void search( std::string pattern, find_options_t options, callback_t on_result );
+}; // find_engine_t
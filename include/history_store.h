@@ -0,0 +1,138 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct history_entry_t {
+	std::string url;
+	std::string title;
+	// Milliseconds since the epoch
+	int64_t last_visit;
+	uint32_t visit_count;
+}; // history_entry_t
+
+/**
+ * Browsing history kept on disk beside the config as two files:
+ *   <base>.log    append-only visit records, each with a sequence number and crc
+ *   <base>.index  compacted entries and the last sequence number they include
+ * Opening loads the index and replays newer log records, stopping at the first
+ * torn or corrupt record so a crash loses at most the unwritten batch.  Visits
+ * are applied to the in memory index at once and written by a background
+ * thread in batches; the log is folded into a new index once it outgrows it.
+ * Queries never touch the disk.  Safe to share between threads.
+ */
+class history_store_t {
+	// Values are the keys of m_by_url, which stay put while their entry exists
+	using time_index_t = std::multimap<int64_t, std::string const *>;
+
+	struct entry_t {
+		std::string title;
+		int64_t last_visit;
+		uint32_t visit_count;
+		time_index_t::iterator by_time;
+	};
+	using url_index_t = std::map<std::string, entry_t>;
+
+	enum class record_kind_t : uint16_t { visit, clear, entry };
+
+	struct record_t {
+		record_kind_t kind;
+		uint64_t sequence;
+		int64_t time;
+		uint32_t visit_count;
+		std::string url;
+		std::string title;
+	};
+
+	std::string m_log_file;
+	std::string m_index_file;
+
+	mutable std::mutex m_mutex;
+	// Sorted by url for prefix queries, with a second index by last visit
+	url_index_t m_by_url;
+	time_index_t m_by_time;
+	uint64_t m_next_sequence;
+
+	std::condition_variable m_cv;
+	std::condition_variable m_written_cv;
+	std::vector<record_t> m_pending;
+	uint64_t m_written_sequence;
+	uint64_t m_failed_writes;
+	bool m_is_flush_requested;
+	bool m_is_stopping;
+
+	// Only used by the writer thread after construction
+	std::ofstream m_log;
+	size_t m_log_records;
+
+	std::thread m_writer;
+
+	void apply( record_t const &record );
+	void enqueue( record_t record );
+	// Returns the last sequence number in the index, 0 when there is none
+	uint64_t load_index( );
+	void replay_log( uint64_t index_sequence );
+	void write_batch( std::vector<record_t> const &batch );
+	void compact( );
+	void writer( );
+
+	static history_entry_t to_entry( url_index_t::value_type const &value );
+
+  public:
+	// base_path is the path without the .log or .index extension
+	explicit history_store_t( std::string const &base_path );
+	// Writes everything still queued
+	~history_store_t( );
+
+	history_store_t( history_store_t const & ) = delete;
+	history_store_t( history_store_t && ) = delete;
+	history_store_t &operator=( history_store_t const & ) = delete;
+	history_store_t &operator=( history_store_t && ) = delete;
+
+	void add_visit( std::string url, std::string title );
+	// Does not wait for the disk; the writer compacts the cleared urls out of
+	// the log in the background
+	void clear( );
+
+	// Entries whose url starts with prefix, in url order
+	std::vector<history_entry_t> find_prefix( boost::string_view prefix, size_t limit ) const;
+	// Most recently visited first
+	std::vector<history_entry_t> recent( size_t limit ) const;
+	size_t size( ) const;
+
+	// Blocks until every visit added so far is on disk or a write fails.
+	// Returns false when a write failed, the visits are then retried later
+	bool flush( );
+}; // history_store_t
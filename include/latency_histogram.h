@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <daw/json/daw_json_link.h>
+
+// Latencies are in microseconds, percentiles are the highest value of their bucket
+struct latency_summary_t : public daw::json::JsonLink<latency_summary_t> {
+	std::string name;
+	int64_t count;
+	int64_t mean_us;
+	int64_t p50_us;
+	int64_t p90_us;
+	int64_t p99_us;
+	int64_t max_us;
+
+	latency_summary_t( );
+	latency_summary_t( latency_summary_t const &other );
+	latency_summary_t( latency_summary_t &&other );
+	latency_summary_t &operator=( latency_summary_t const &rhs );
+	latency_summary_t &operator=( latency_summary_t &&rhs );
+	~latency_summary_t( );
+
+  private:
+	void link_json( );
+}; // latency_summary_t
+
+/**
+ * Lock free log-linear histogram in the manner of HdrHistogram.  Each power of
+ * two range of microseconds is split into 16 equal buckets, so a percentile is
+ * within 1/16 of the true value over the whole 64 bit range in under 8 KiB.
+ * record may run on any number of threads at once with summary.  A summary
+ * taken while records are landing may lag them by those records.
+ */
+class latency_histogram_t {
+	static constexpr size_t const sub_bucket_bits = 4;
+	static constexpr size_t const sub_bucket_count = 1u << sub_bucket_bits;
+	// Values below sub_bucket_count get a bucket each, then each power of two gets sub_bucket_count
+	static constexpr size_t const bucket_count = sub_bucket_count * ( 64 - sub_bucket_bits + 1 );
+
+	std::array<std::atomic<uint64_t>, bucket_count> m_buckets;
+	std::atomic<uint64_t> m_sum;
+	std::atomic<uint64_t> m_max;
+
+	static size_t get_bucket( uint64_t value ) noexcept;
+	static uint64_t get_highest_value( size_t bucket ) noexcept;
+
+  public:
+	latency_histogram_t( ) noexcept;
+	~latency_histogram_t( ) = default;
+	latency_histogram_t( latency_histogram_t const & ) = delete;
+	latency_histogram_t( latency_histogram_t && ) = delete;
+	latency_histogram_t &operator=( latency_histogram_t const & ) = delete;
+	latency_histogram_t &operator=( latency_histogram_t && ) = delete;
+
+	// Negative latencies count as zero
+	void record( std::chrono::microseconds latency ) noexcept;
+	latency_summary_t summary( std::string name ) const;
+}; // latency_histogram_t
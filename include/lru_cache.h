@@ -0,0 +1,153 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "string_hash.h"
+
+struct lru_cache_stats_t {
+	uint64_t hits;
+	uint64_t misses;
+	size_t size;
+	size_t capacity;
+}; // lru_cache_stats_t
+
+/**
+ * Bounded, thread safe least recently used map from string to Value.  Lookups
+ * take a string_view and do not allocate.  Each entry costs 1 of the capacity
+ * unless inserted with a cost of its own, e.g. its size in bytes.  A capacity
+ * of zero disables the cache.
+ */
+template<typename Value>
+class string_lru_cache_t {
+	struct entry_t {
+		std::string key;
+		Value value;
+		size_t cost;
+	};
+	using list_t = std::list<entry_t>;
+
+	mutable std::mutex m_mutex;
+	list_t m_entries;
+	std::unordered_map<boost::string_view, typename list_t::iterator, string_view_hash_t> m_index;
+	size_t m_capacity;
+	size_t m_cost;
+	mutable std::atomic<uint64_t> m_hits;
+	mutable std::atomic<uint64_t> m_misses;
+
+	void erase_entry( typename list_t::iterator entry ) {
+		m_index.erase( boost::string_view{entry->key.data( ), entry->key.size( )} );
+		m_cost -= entry->cost;
+		m_entries.erase( entry );
+	}
+
+  public:
+	explicit string_lru_cache_t( size_t capacity )
+	    : m_mutex{}, m_entries{}, m_index{}, m_capacity{capacity}, m_cost{0}, m_hits{0}, m_misses{0} {}
+
+	~string_lru_cache_t( ) = default;
+	string_lru_cache_t( string_lru_cache_t const & ) = delete;
+	string_lru_cache_t( string_lru_cache_t && ) = delete;
+	string_lru_cache_t &operator=( string_lru_cache_t const & ) = delete;
+	string_lru_cache_t &operator=( string_lru_cache_t && ) = delete;
+
+	boost::optional<Value> find( boost::string_view key ) {
+		if( m_capacity == 0 ) {
+			return boost::none;
+		}
+		std::lock_guard<std::mutex> lock{m_mutex};
+		auto pos = m_index.find( key );
+		if( pos == m_index.end( ) ) {
+			++m_misses;
+			return boost::none;
+		}
+		++m_hits;
+		m_entries.splice( m_entries.begin( ), m_entries, pos->second );
+		return pos->second->value;
+	}
+
+	// A value costing more than the whole capacity is not kept
+	void insert( boost::string_view key, Value value, size_t cost = 1 ) {
+		if( m_capacity == 0 ) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock{m_mutex};
+		auto pos = m_index.find( key );
+		if( pos != m_index.end( ) ) {
+			erase_entry( pos->second );
+		}
+		if( cost > m_capacity ) {
+			return;
+		}
+		while( !m_entries.empty( ) && m_cost + cost > m_capacity ) {
+			erase_entry( std::prev( m_entries.end( ) ) );
+		}
+		m_entries.push_front( entry_t{key.to_string( ), std::move( value ), cost} );
+		m_cost += cost;
+		auto const &stored = m_entries.front( ).key;
+		m_index.emplace( boost::string_view{stored.data( ), stored.size( )}, m_entries.begin( ) );
+	}
+
+	void erase( boost::string_view key ) {
+		std::lock_guard<std::mutex> lock{m_mutex};
+		auto pos = m_index.find( key );
+		if( pos != m_index.end( ) ) {
+			erase_entry( pos->second );
+		}
+	}
+
+	void clear( ) {
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_index.clear( );
+		m_entries.clear( );
+		m_cost = 0;
+	}
+
+	// Copies of the values, most recently used first
+	std::vector<Value> values( ) const {
+		std::lock_guard<std::mutex> lock{m_mutex};
+		std::vector<Value> result;
+		result.reserve( m_entries.size( ) );
+		for( auto const &entry : m_entries ) {
+			result.push_back( entry.value );
+		}
+		return result;
+	}
+
+	lru_cache_stats_t stats( ) const {
+		std::lock_guard<std::mutex> lock{m_mutex};
+		return lru_cache_stats_t{m_hits.load( ), m_misses.load( ), m_cost, m_capacity};
+	}
+}; // string_lru_cache_t
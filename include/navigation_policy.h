@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+
+/**
+ * Evaluates url policy on a pool of worker threads so that expensive regex
+ * validators do not run on the GUI thread.  Callbacks are invoked on a worker;
+ * marshal back to the GUI thread (e.g. with CallAfter) before touching widgets.
+ */
+class navigation_policy_t {
+  public:
+	using callback_t = std::function<void( std::string url, bool is_allowed )>;
+	using decide_t = std::function<bool( std::string const &url )>;
+
+  private:
+	struct job_t {
+		decide_t decide;
+		std::string url;
+		callback_t on_verdict;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<job_t> m_jobs;
+	bool m_is_stopping;
+	std::vector<std::thread> m_workers;
+
+	void worker( );
+
+  public:
+	explicit navigation_policy_t( size_t worker_count );
+	// Stops accepting work and joins the workers.  Queued jobs are dropped
+	~navigation_policy_t( );
+
+	navigation_policy_t( navigation_policy_t const & ) = delete;
+	navigation_policy_t( navigation_policy_t && ) = delete;
+	navigation_policy_t &operator=( navigation_policy_t const & ) = delete;
+	navigation_policy_t &operator=( navigation_policy_t && ) = delete;
+
+	// The job keeps config alive, so a reload may publish a new config while it is queued
+	void submit( std::shared_ptr<config_t const> config, std::string url, callback_t on_verdict );
+	// For other checks too slow for the GUI thread, decide is called on a worker
+	void submit( decide_t decide, std::string url, callback_t on_verdict );
+}; // navigation_policy_t
@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <daw/json/daw_json_link.h>
+
+#include "latency_histogram.h"
+
+struct navigation_timing_snapshot_t : public daw::json::JsonLink<navigation_timing_snapshot_t> {
+	// commit, render, load and error, see navigation_timing_t
+	std::vector<latency_summary_t> phases;
+
+	navigation_timing_snapshot_t( );
+	navigation_timing_snapshot_t( navigation_timing_snapshot_t const &other );
+	navigation_timing_snapshot_t( navigation_timing_snapshot_t &&other );
+	navigation_timing_snapshot_t &operator=( navigation_timing_snapshot_t const &rhs );
+	navigation_timing_snapshot_t &operator=( navigation_timing_snapshot_t &&rhs );
+	~navigation_timing_snapshot_t( );
+
+  private:
+	void link_json( );
+}; // navigation_timing_snapshot_t
+
+/**
+ * Times main frame navigations on the steady clock, matching the webview's
+ * events by url:
+ *   commit  request to navigation complete, the server's part
+ *   render  navigation complete to document loaded
+ *   load    request to document loaded, what the user waits for
+ *   error   request to error
+ * A redirect is timed from the request of its last hop.  The event calls are
+ * for the GUI thread; snapshot may be taken from any thread.
+ */
+class navigation_timing_t {
+  public:
+	using clock_t = std::chrono::steady_clock;
+
+  private:
+	struct pending_t {
+		clock_t::time_point requested;
+		boost::optional<clock_t::time_point> committed;
+	};
+
+	// Requests that never finish, a denied or replaced navigation, age out or are dropped oldest first
+	std::unordered_map<std::string, pending_t> m_pending;
+	latency_histogram_t m_commit;
+	latency_histogram_t m_render;
+	latency_histogram_t m_load;
+	latency_histogram_t m_error;
+
+	void evict( clock_t::time_point now );
+
+  public:
+	navigation_timing_t( );
+	~navigation_timing_t( ) = default;
+	navigation_timing_t( navigation_timing_t const & ) = delete;
+	navigation_timing_t( navigation_timing_t && ) = delete;
+	navigation_timing_t &operator=( navigation_timing_t const & ) = delete;
+	navigation_timing_t &operator=( navigation_timing_t && ) = delete;
+
+	// A navigation resumed after a policy check asks again, it keeps its first request time
+	void on_request( std::string const &url );
+	void on_complete( std::string const &url );
+	// The load time, if the request was seen
+	boost::optional<std::chrono::microseconds> on_loaded( std::string const &url );
+	void on_error( std::string const &url );
+
+	navigation_timing_snapshot_t snapshot( ) const;
+	latency_summary_t load_summary( ) const;
+}; // navigation_timing_t
@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "string_hash.h"
+
+// Pages under cache://host/path are served from the page cache as http://host/path
+constexpr char const page_cache_scheme[] = "cache";
+
+// The url that policy and fetching apply to; url itself unless it is a cache: url
+std::string get_page_cache_target( boost::string_view url );
+
+struct page_cache_hit_t {
+	// Null for an empty body, which cannot be mapped
+	std::shared_ptr<boost::iostreams::mapped_file_source const> body;
+	std::string mime_type;
+}; // page_cache_hit_t
+
+/**
+ * Response bodies kept on disk under a directory, for serving pages without
+ * the network.  Bodies are stored once per distinct content under a name
+ * derived from their hash and size, so urls with the same body share a file,
+ * and read back through a memory mapping.  Urls are evicted least recently
+ * used first once the bodies exceed the size limit.  Each url carries the
+ * time it stops being fresh; past it the url is treated as missing until it is
+ * stored again.  The url index is rewritten beside the bodies on every change.  Safe to share between
+ * threads.
+ */
+class page_cache_t {
+	struct entry_t {
+		std::string url;
+		std::string object;
+		std::string mime_type;
+		// Seconds since the epoch
+		std::time_t expires;
+	};
+	using list_t = std::list<entry_t>;
+
+	struct object_t {
+		uint64_t size;
+		size_t refs;
+	};
+
+	mutable std::mutex m_mutex;
+	boost::filesystem::path m_root;
+	// Most recently used first
+	list_t m_entries;
+	std::unordered_map<boost::string_view, list_t::iterator, string_view_hash_t> m_index;
+	std::unordered_map<std::string, object_t> m_objects;
+	uint64_t m_size;
+	uint64_t m_size_limit;
+	uint64_t m_entry_size_limit;
+	// Hits reorder the entries without saving the index each time
+	bool m_is_dirty;
+
+	boost::filesystem::path get_object_path( std::string const &object ) const;
+	void load_index( );
+	void save_index( );
+	void remove_orphans( );
+	void erase( list_t::iterator entry );
+	void evict( );
+	// Name of a stored object holding exactly data, writing it when missing.
+	// Empty when a different body already has the name
+	std::string store_object( char const *data, size_t size );
+
+  public:
+	page_cache_t( boost::filesystem::path root, uint64_t size_limit, uint64_t entry_size_limit );
+	// Saves the recency order
+	~page_cache_t( );
+
+	page_cache_t( page_cache_t const & ) = delete;
+	page_cache_t( page_cache_t && ) = delete;
+	page_cache_t &operator=( page_cache_t const & ) = delete;
+	page_cache_t &operator=( page_cache_t && ) = delete;
+
+	// Empty when url is missing or no longer fresh
+	boost::optional<page_cache_hit_t> find( boost::string_view url );
+	// Unlike find, does not count as a use of url
+	bool contains( boost::string_view url ) const;
+	// False when the body is over the entry limit or could not be written.
+	// The entry is fresh until expires
+	bool insert( boost::string_view url, std::string const &mime_type, char const *data, size_t size,
+	             std::time_t expires );
+	// Evicts down to a smaller size_limit at once
+	void set_limits( uint64_t size_limit, uint64_t entry_size_limit );
+	uint64_t size( ) const;
+	uint64_t entry_size_limit( ) const;
+}; // page_cache_t
+
+/**
+ * The cache: urls frames were last asked to load as their document, so that a
+ * miss on one can be told from a miss on a sub-resource.  Only the most recent
+ * few are kept.  Safe to share between threads.
+ */
+class page_cache_documents_t {
+	std::mutex m_mutex;
+	std::deque<std::string> m_urls;
+
+  public:
+	page_cache_documents_t( );
+
+	void expect( std::string url );
+	// Forgets url, false when it was not expected
+	bool take( boost::string_view url );
+}; // page_cache_documents_t
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aho_corasick.h"
+
+// The utf-8 text of a page as it was when it finished loading
+struct page_text_t {
+	std::string url;
+	std::string title;
+	std::string text;
+}; // page_text_t
+
+struct page_hits_t {
+	std::string url;
+	std::string title;
+	// By pattern, in the order given to search
+	std::vector<size_t> counts;
+	size_t total;
+}; // page_hits_t
+
+/**
+ * Counts several terms across a set of page texts on a worker thread, one
+ * Aho-Corasick pass a page.  Results arrive a page at a time, and pages that
+ * load while a search is current are scanned as they are added, so a result
+ * list fills in incrementally.  Starting a new search drops pages still queued
+ * for the old one.
+ */
+class page_search_t {
+  public:
+	// Called on the worker for every page scanned, marshal back to the GUI thread before touching widgets
+	using callback_t = std::function<void( uint64_t generation, page_hits_t hits )>;
+
+  private:
+	struct job_t {
+		uint64_t generation;
+		std::shared_ptr<aho_corasick_t const> automaton;
+		std::shared_ptr<page_text_t const> page;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<job_t> m_jobs;
+	std::shared_ptr<aho_corasick_t const> m_automaton;
+	uint64_t m_generation;
+	bool m_is_stopping;
+	callback_t m_on_hits;
+	std::thread m_worker;
+
+	void worker( );
+
+  public:
+	explicit page_search_t( callback_t on_hits );
+	// Joins the worker after the page being scanned, if any.  Queued pages are dropped
+	~page_search_t( );
+
+	page_search_t( page_search_t const & ) = delete;
+	page_search_t( page_search_t && ) = delete;
+	page_search_t &operator=( page_search_t const & ) = delete;
+	page_search_t &operator=( page_search_t && ) = delete;
+
+	// Starts scanning pages for patterns and returns the generation its results carry.  No
+	// patterns ends the current search
+	uint64_t search( std::vector<std::string> const &patterns, std::vector<std::shared_ptr<page_text_t const>> pages );
+	// Scans a newly loaded page for the current search, if there is one
+	void add_page( std::shared_ptr<page_text_t const> page );
+}; // page_search_t
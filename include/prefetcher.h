@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "config.h"
+#include "page_cache.h"
+#include "transition_model.h"
+
+/**
+ * Learns which page usually follows which and warms the likeliest next cache:
+ * pages into the page cache while the current one is on screen.  Predictions
+ * must pass the config's url validators, and downloads are held to
+ * prefetch_bandwidth bytes a minute; a single page may overdraw the allowance,
+ * which then holds back later prefetches.  Each navigation replaces the
+ * predictions still queued from the last one.  Pages missing from the cache
+ * when they were asked for are filled ahead of predictions, are kept across
+ * navigations and are not held to the allowance, though their bytes count
+ * against it.  Warming happens on a single worker thread.
+ */
+class prefetcher_t {
+  public:
+	// Downloads url, stores it in the page cache and returns the bytes downloaded.
+	// Bodies over max_size are to be abandoned
+	using warm_t = std::function<uint64_t( std::string const &url, uint64_t max_size )>;
+
+  private:
+	using clock_type = std::chrono::steady_clock;
+
+	struct job_t {
+		std::shared_ptr<config_t const> config;
+		std::string url;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<job_t> m_jobs;
+	std::deque<job_t> m_fills;
+	bool m_is_stopping;
+	transition_model_t m_model;
+	page_cache_t *m_page_cache;
+	warm_t m_warm;
+	// Only touched by the worker
+	double m_allowance;
+	clock_type::time_point m_allowance_time;
+	std::thread m_worker;
+
+	bool has_allowance( int64_t bandwidth );
+	void worker( );
+
+  public:
+	prefetcher_t( page_cache_t &page_cache, warm_t warm );
+	// Joins the worker after the page being warmed, if any.  Queued pages are dropped
+	~prefetcher_t( );
+
+	prefetcher_t( prefetcher_t const & ) = delete;
+	prefetcher_t( prefetcher_t && ) = delete;
+	prefetcher_t &operator=( prefetcher_t const & ) = delete;
+	prefetcher_t &operator=( prefetcher_t && ) = delete;
+
+	// Records that from led to to, then queues the pages likeliest to follow to.
+	// from is empty for the first page
+	void on_navigation( std::shared_ptr<config_t const> config, std::string const &from, std::string const &to );
+
+	// Queues a cache: url that was asked for and missed, so its next load is a hit
+	void fill( std::shared_ptr<config_t const> config, std::string url );
+}; // prefetcher_t
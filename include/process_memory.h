@@ -0,0 +1,46 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstdint>
+
+// Bytes of this process held in physical memory, empty where the platform
+// does not say
+boost::optional<uint64_t> get_resident_size( );
+
+// Bytes in physical memory of this process and every process it started,
+// directly or not.  WebKit2 and WebView2 keep page memory in such content
+// processes.  On macOS the WebKit content processes are started by launchd and
+// are not counted
+boost::optional<uint64_t> get_process_tree_resident_size( );
+
+struct process_usage_t {
+	uint64_t resident_size;
+	// User and system time used so far
+	double cpu_seconds;
+}; // process_usage_t
+
+// Usage of another process, empty when it is gone or the platform does not say
+boost::optional<process_usage_t> get_process_usage( long pid );
@@ -0,0 +1,59 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+/**
+ * The url_validators entries split into sites.  Exact and prefix validators
+ * with the same scheme, host and port form one group; each regex validator is
+ * a group of its own since what it matches cannot be told from its text.
+ */
+struct site_group_t {
+	// scheme://host[:port] for exact and prefix groups, the pattern for a regex group
+	std::string name;
+	// The page a process for the group opens on, empty for a regex group
+	std::string start_url;
+	// The config limited to the group's validators, compiled
+	std::shared_ptr<config_t const> config;
+	bool is_regex;
+}; // site_group_t
+
+// Groups in the order their first validator appears.  The group holding the
+// home url starts there
+std::vector<site_group_t> make_site_groups( config_t const &config );
+
+// scheme://host[:port] of url in lower case, the name of the group for its site
+std::string get_url_site( boost::string_view url );
+
+// The first group that allows url, though the group named for url's site goes
+// ahead of the rest
+boost::optional<size_t> find_site_group( std::vector<site_group_t> const &groups, boost::string_view url );
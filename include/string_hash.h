@@ -0,0 +1,44 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a.  Every hash in the app that is not cryptographic uses it, e.g. page
+// cache object names, asset etags and the containers below.  A hash can be
+// passed back in to continue it over more bytes
+constexpr uint64_t const fnv1a_offset_basis = 14695981039346656037ULL;
+
+inline uint64_t fnv1a_append( uint64_t hash, unsigned char byte ) noexcept {
+	return ( hash ^ byte ) * 1099511628211ULL;
+}
+
+uint64_t fnv1a_hash( char const *data, size_t size, uint64_t hash = fnv1a_offset_basis ) noexcept;
+
+// Hash for unordered containers keyed by string_view, e.g. views into strings
+// the container owns elsewhere
+struct string_view_hash_t {
+	size_t operator( )( boost::string_view str ) const noexcept;
+}; // string_view_hash_t
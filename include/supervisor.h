@@ -0,0 +1,156 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <wx/wx.h>
+
+#include <wx/ipc.h>
+#include <wx/process.h>
+#include <wx/timer.h>
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "config.h"
+#include "site_groups.h"
+
+// The IPC service name a supervisor with process id pid listens on
+std::string get_supervisor_service( long pid );
+
+/**
+ * Runs one browser process per site group and restarts any that goes over
+ * child_memory_limit or stays over child_cpu_limit.  Children connect back
+ * over wxWidgets IPC, a unix socket or DDE on Windows.  They report each page
+ * they load so a restarted child resumes there, and hand over urls of other
+ * site groups, which are routed to the owning child, starting it if needed.
+ * The home url's group starts at once, others when first needed.  The session
+ * ends when the user has closed every child.  GUI thread only.
+ */
+class supervisor_t : public wxServer {
+	using clock_type = std::chrono::steady_clock;
+
+	class connection_t;
+	class process_t;
+
+	// One per site group, by the same index
+	struct child_t {
+		// Where the child starts, or resumes after a restart
+		std::string resume_url;
+		process_t *process;
+		connection_t *connection;
+		long pid;
+		clock_type::time_point started;
+		clock_type::time_point exited;
+		clock_type::time_point checked;
+		// Set once a restart has asked the process to end
+		boost::optional<clock_type::time_point> kill_requested;
+		double cpu_seconds;
+		unsigned cpu_strikes;
+		bool is_wanted;
+		// resume_url is to be sent as soon as the child connects
+		bool has_pending_url;
+	};
+
+	std::shared_ptr<config_t const> m_config;
+	std::string m_service;
+	std::vector<site_group_t> m_groups;
+	std::vector<child_t> m_children;
+	wxTimer m_check_timer;
+
+	bool spawn( size_t index );
+	void restart( size_t index, char const *reason );
+	void route( std::string const &url );
+	void send_pending_url( size_t index );
+	void OnCheckTimer( wxTimerEvent &evt );
+	void on_child_message( size_t index, wxString const &item, wxString const &data );
+	void on_child_disconnected( size_t index );
+	void on_child_exited( size_t index, int status );
+
+  public:
+	supervisor_t( std::shared_ptr<config_t const> config, std::string service );
+	// Asks the children to end
+	~supervisor_t( ) override;
+
+	supervisor_t( supervisor_t const & ) = delete;
+	supervisor_t( supervisor_t && ) = delete;
+	supervisor_t &operator=( supervisor_t const & ) = delete;
+	supervisor_t &operator=( supervisor_t && ) = delete;
+
+	// Listens and starts the home url's group.  False when the service cannot be created
+	// or no group allows the home url
+	bool start( );
+	// Only the limits follow a reload, the site groups are fixed at startup
+	void set_config( std::shared_ptr<config_t const> config );
+	wxConnectionBase *OnAcceptConnection( wxString const &topic ) override;
+}; // supervisor_t
+
+/**
+ * A child's end of the channel to its supervisor.  Urls outside the child's
+ * site group are handed over rather than loaded, and urls routed to the child
+ * are passed to on_navigate.  The child exits when the supervisor goes away.
+ */
+class supervisor_link_t : public wxConnection {
+  public:
+	using navigate_t = std::function<void( std::string const &url )>;
+
+  private:
+	std::vector<site_group_t> m_groups;
+	// The group named for each site, most urls are settled there without a regex
+	std::unordered_map<std::string, size_t> m_sites;
+	size_t m_group;
+	navigate_t m_on_navigate;
+
+  public:
+	supervisor_link_t( std::vector<site_group_t> groups, size_t group, navigate_t on_navigate );
+	~supervisor_link_t( ) override;
+
+	supervisor_link_t( supervisor_link_t const & ) = delete;
+	supervisor_link_t( supervisor_link_t && ) = delete;
+	supervisor_link_t &operator=( supervisor_link_t const & ) = delete;
+	supervisor_link_t &operator=( supervisor_link_t && ) = delete;
+
+	// False only when another group allows url; urls no group allows stay to be denied locally.
+	// Safe to call from any thread
+	bool is_own_url( boost::string_view url ) const;
+	// Like is_own_url without running a regex validator, empty when one has to run
+	boost::optional<bool> fast_is_own_url( boost::string_view url ) const;
+	void hand_off( std::string const &url );
+	void report_loaded( std::string const &url );
+
+	bool OnAdvise( wxString const &topic, wxString const &item, void const *data, size_t size,
+	               wxIPCFormat format ) override;
+	bool OnDisconnect( ) override;
+}; // supervisor_link_t
+
+// Null when there is no supervisor listening on service
+std::unique_ptr<supervisor_link_t> connect_to_supervisor( std::string const &service,
+                                                          std::vector<site_group_t> groups, size_t group,
+                                                          supervisor_link_t::navigate_t on_navigate );
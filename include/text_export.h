@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Writes page texts, already utf-8, to a file or pipe on a thread of its own
+ * so a slow reader does not stall the GUI.  Records are written in the order
+ * they were added, each as a line with the byte count and url, then the text
+ * and a line break:
+ *
+ *   <size> <url>\n<text>\n
+ *
+ * Text is written in chunks straight from the string it was handed over in.
+ */
+class text_export_t {
+	struct record_t {
+		std::string url;
+		std::string text;
+	};
+
+	std::FILE *m_file;
+	bool m_is_owned;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<record_t> m_records;
+	// Text queued and not written yet.  add waits while this is over the limit
+	size_t m_pending_size;
+	bool m_is_stopping;
+	bool m_has_failed;
+	std::thread m_writer;
+
+	void writer( );
+
+  public:
+	// path "-" is standard output.  Throws std::runtime_error when path cannot be opened
+	explicit text_export_t( std::string const &path );
+	// Calls finish
+	~text_export_t( );
+
+	text_export_t( text_export_t const & ) = delete;
+	text_export_t( text_export_t && ) = delete;
+	text_export_t &operator=( text_export_t const & ) = delete;
+	text_export_t &operator=( text_export_t && ) = delete;
+
+	// Blocks while too much text is waiting to be written, so a slow reader holds back its producer
+	void add( std::string url, std::string text );
+	// Writes everything queued and closes the output.  False if any write failed
+	bool finish( );
+}; // text_export_t
@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct transition_prediction_t {
+	std::string url;
+	// Share of the navigations away from the source that went to url
+	double probability;
+}; // transition_prediction_t
+
+/**
+ * Counts which page follows which.  Counts for a source are halved once they
+ * pass a limit so the model follows changes in how the app is used, and the
+ * number of sources and of targets per source are bounded, dropping the least
+ * used.  Not thread safe.
+ */
+class transition_model_t {
+	struct targets_t {
+		std::unordered_map<std::string, uint32_t> counts;
+		uint32_t total;
+	};
+
+	std::unordered_map<std::string, targets_t> m_sources;
+	size_t m_max_sources;
+	size_t m_max_targets;
+
+  public:
+	transition_model_t( size_t max_sources, size_t max_targets );
+	~transition_model_t( );
+	transition_model_t( transition_model_t const & ) = default;
+	transition_model_t( transition_model_t && ) = default;
+	transition_model_t &operator=( transition_model_t const & ) = default;
+	transition_model_t &operator=( transition_model_t && ) = default;
+
+	void record( std::string const &from, std::string const &to );
+	// Likeliest targets after from, most likely first
+	std::vector<transition_prediction_t> predict( std::string const &from, size_t limit ) const;
+	size_t size( ) const noexcept;
+}; // transition_model_t
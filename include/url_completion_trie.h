@@ -0,0 +1,122 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct url_completion_t {
+	std::string url;
+	uint32_t weight;
+}; // url_completion_t
+
+/**
+ * Compressed radix trie of urls, each with a weight, for completing what is
+ * typed into the url bar.  Labels are ranges of one character arena, so
+ * splitting an edge never copies, and every node records the largest weight
+ * below it.  complete( ) descends to the prefix and then expands the
+ * heaviest subtree first, so its cost follows the prefix length and the
+ * number of results asked for rather than the number of urls.
+ */
+class url_completion_trie_t {
+	struct node_t {
+		uint32_t label_offset;
+		uint32_t label_size;
+		uint32_t parent;
+		uint32_t first_child;
+		uint32_t next_sibling;
+		uint32_t weight;
+		uint32_t max_weight;
+		bool is_terminal;
+	};
+
+	// A subtree to expand, or a url ready to be returned
+	struct heap_item_t {
+		uint32_t weight;
+		uint32_t node;
+		bool is_result;
+	};
+
+	std::string m_chars;
+	std::vector<node_t> m_nodes;
+	size_t m_size;
+
+	boost::string_view label( node_t const &node ) const noexcept;
+	uint32_t find_child( uint32_t parent, char c ) const noexcept;
+	uint32_t add_node( uint32_t parent, uint32_t label_offset, uint32_t label_size );
+	uint32_t split( uint32_t node, uint32_t at );
+	std::string get_key( uint32_t node ) const;
+
+  public:
+	url_completion_trie_t( );
+	~url_completion_trie_t( );
+	url_completion_trie_t( url_completion_trie_t const & ) = default;
+	url_completion_trie_t( url_completion_trie_t && ) = default;
+	url_completion_trie_t &operator=( url_completion_trie_t const & ) = default;
+	url_completion_trie_t &operator=( url_completion_trie_t && ) = default;
+
+	// Adds weight to url, inserting it when new
+	void add( boost::string_view url, uint32_t weight );
+	// Urls starting with prefix, heaviest first.  accept is called on each
+	// candidate in that order and at most max_checks times
+	template<typename Predicate>
+	std::vector<url_completion_t> complete( boost::string_view prefix, size_t limit, size_t max_checks,
+	                                        Predicate accept ) const;
+	std::vector<url_completion_t> complete( boost::string_view prefix, size_t limit ) const;
+	void clear( );
+	bool empty( ) const noexcept;
+	size_t size( ) const noexcept;
+
+  private:
+	// Node whose subtree holds every key starting with prefix, or no_node
+	uint32_t find_prefix( boost::string_view prefix ) const noexcept;
+	// Next url below the subtrees in heap by weight, expanding subtrees as needed
+	bool pop_heaviest( std::vector<heap_item_t> &heap, uint32_t &node ) const;
+
+  public:
+	static constexpr uint32_t const no_node = static_cast<uint32_t>( -1 );
+}; // url_completion_trie_t
+
+template<typename Predicate>
+std::vector<url_completion_t> url_completion_trie_t::complete( boost::string_view prefix, size_t limit,
+                                                               size_t max_checks, Predicate accept ) const {
+	std::vector<url_completion_t> result;
+	auto const start = find_prefix( prefix );
+	if( start == no_node || limit == 0 ) {
+		return result;
+	}
+	std::vector<heap_item_t> heap{heap_item_t{m_nodes[start].max_weight, start, false}};
+	uint32_t node = 0;
+	while( result.size( ) < limit && max_checks > 0 && pop_heaviest( heap, node ) ) {
+		auto key = get_key( node );
+		--max_checks;
+		if( accept( boost::string_view{key} ) ) {
+			result.push_back( url_completion_t{std::move( key ), m_nodes[node].weight} );
+		}
+	}
+	return result;
+}
@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <string>
+
+/**
+ * Views into the pieces of a url.  No copies are made, the parts are only
+ * valid as long as the string that was parsed.
+ * scheme://userinfo@host:port/path?query#fragment
+ *
+ * Like the WebView, a backslash counts as a slash and the authority ends at
+ * the first of / \ ? or #.
+ */
+struct url_parts_t {
+	boost::string_view scheme;
+	boost::string_view host;
+	boost::string_view port;
+	boost::string_view path;
+	boost::string_view query;
+	boost::string_view fragment;
+}; // url_parts_t
+
+url_parts_t parse_url( boost::string_view url ) noexcept;
+
+// Path as the server sees it, for comparing paths.  Backslashes become
+// slashes, escaped unreserved characters are decoded, other escapes are upper
+// cased and empty, . and .. segments are resolved, e.g. /docs/%2e%2e/admin is
+// /admin
+std::string normalize_path( boost::string_view path );
+
+// Port with the scheme default removed, e.g. https://a:443 has no port
+boost::string_view effective_port( url_parts_t const &parts ) noexcept;
+
+bool iequal( boost::string_view lhs, boost::string_view rhs ) noexcept;
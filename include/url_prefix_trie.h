@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "url_parts.h"
+
+/**
+ * Set of url prefixes keyed on scheme, host labels (reversed) and path
+ * segments.  "https://www.example.com/docs" allows any path at or below /docs
+ * on that host, and a leftmost host label of * allows any subdomain.  Lookup
+ * cost depends on the length of the url being checked, not on the number of
+ * prefixes.
+ *
+ * Scheme and host compare case insensitively, paths are case sensitive and
+ * compared after normalize_path.  A prefix without a port only allows the
+ * default port of its scheme.
+ */
+class url_prefix_trie_t {
+	struct edge_key_t {
+		uint32_t parent;
+		boost::string_view label;
+	};
+
+	struct edge_hash_t {
+		bool ignore_case;
+		size_t operator( )( edge_key_t const &key ) const noexcept;
+	};
+
+	struct edge_equal_t {
+		bool ignore_case;
+		bool operator( )( edge_key_t const &lhs, edge_key_t const &rhs ) const noexcept;
+	};
+
+	using edge_map_t = std::unordered_map<edge_key_t, uint32_t, edge_hash_t, edge_equal_t>;
+
+	std::deque<std::string> m_labels;
+	std::vector<uint8_t> m_terminal;
+	edge_map_t m_host_edges;
+	edge_map_t m_port_edges;
+	edge_map_t m_path_edges;
+	size_t m_size;
+
+	uint32_t add_edge( edge_map_t &edges, uint32_t parent, boost::string_view label );
+	uint32_t find_edge( edge_map_t const &edges, uint32_t parent, boost::string_view label ) const noexcept;
+	bool match_host( uint32_t node, boost::string_view host, url_parts_t const &parts ) const;
+	bool match_path( uint32_t node, url_parts_t const &parts ) const;
+
+  public:
+	url_prefix_trie_t( );
+	~url_prefix_trie_t( );
+
+	// Edges hold views into m_labels
+	url_prefix_trie_t( url_prefix_trie_t const & ) = delete;
+	url_prefix_trie_t &operator=( url_prefix_trie_t const & ) = delete;
+	url_prefix_trie_t( url_prefix_trie_t && ) = default;
+	url_prefix_trie_t &operator=( url_prefix_trie_t && ) = default;
+
+	// Throws std::invalid_argument if prefix has no scheme or host
+	void add( boost::string_view prefix );
+	bool is_match( boost::string_view url ) const;
+	bool empty( ) const noexcept;
+	size_t size( ) const noexcept;
+}; // url_prefix_trie_t
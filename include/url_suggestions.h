@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "history_store.h"
+#include "url_completion_trie.h"
+
+/**
+ * Url bar suggestions drawn from the visited urls in the history store and the
+ * exact and prefix urls of the config's validators, each in its own trie so a
+ * config reload only rebuilds the small one.  Only urls that the current
+ * config's is_valid_url accepts are offered.  The history trie is filled on
+ * the first query and then kept up to date by add_visit.  Safe to share
+ * between threads.
+ */
+class url_suggestions_t {
+	mutable std::mutex m_mutex;
+	history_store_t const *m_history_store;
+	bool m_is_history_loaded;
+	url_completion_trie_t m_visited;
+	url_completion_trie_t m_allowed;
+	std::shared_ptr<config_t const> m_config;
+
+	void load_history( );
+
+  public:
+	// history_store may be null, it must outlive this
+	url_suggestions_t( history_store_t const *history_store, std::shared_ptr<config_t const> config );
+	~url_suggestions_t( );
+
+	url_suggestions_t( url_suggestions_t const & ) = delete;
+	url_suggestions_t( url_suggestions_t && ) = delete;
+	url_suggestions_t &operator=( url_suggestions_t const & ) = delete;
+	url_suggestions_t &operator=( url_suggestions_t && ) = delete;
+
+	void add_visit( boost::string_view url );
+	// Forgets the visited urls, for when the history store is cleared
+	void clear( );
+	void set_config( std::shared_ptr<config_t const> config );
+	// Best matches for what has been typed so far, most visited first.  Input
+	// without a scheme also matches urls under http:// and https://
+	std::vector<std::string> complete( boost::string_view typed, size_t limit );
+}; // url_suggestions_t
@@ -0,0 +1,79 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "lru_cache.h"
+#include "string_hash.h"
+#include "url_prefix_trie.h"
+
+struct url_validation_t;
+
+/**
+ * The compiled form of config_t::url_validators.  Built once when the config
+ * is loaded; exact entries live in a hash set, prefix entries in a trie and
+ * each regex entry is compiled once, on its own, with the ECMAScript grammar.
+ * The regexes are still backtracking searches tried one after another, which
+ * is why their verdicts are kept in a bounded LRU keyed by the url.  Urls with
+ * a fragment or over 2KiB are not cached.  A new engine is built whenever
+ * url_validators change, which also discards the old verdicts.  Safe to share
+ * between threads.
+ */
+class url_validator_engine_t {
+	std::vector<std::string> m_exact_urls;
+	std::unordered_set<boost::string_view, string_view_hash_t> m_exact;
+	url_prefix_trie_t m_prefixes;
+	std::vector<std::regex> m_regexes;
+	bool m_allow_all;
+	mutable string_lru_cache_t<bool> m_verdicts;
+
+  public:
+	// Throws std::invalid_argument if a prefix or regex entry is malformed
+	url_validator_engine_t( std::vector<url_validation_t> const &validators, size_t verdict_cache_size );
+	~url_validator_engine_t( );
+
+	// m_exact holds views into m_exact_urls, so the engine cannot be relocated
+	url_validator_engine_t( url_validator_engine_t const & ) = delete;
+	url_validator_engine_t( url_validator_engine_t && ) = delete;
+	url_validator_engine_t &operator=( url_validator_engine_t const & ) = delete;
+	url_validator_engine_t &operator=( url_validator_engine_t && ) = delete;
+
+	bool is_match( boost::string_view url ) const;
+
+	// Answers from the exact set, prefix trie and verdict cache only.  Empty
+	// when a regex has to run to decide
+	boost::optional<bool> fast_match( boost::string_view url ) const;
+
+	// Evaluates every validator without consulting the verdict cache and then
+	// caches the verdict
+	bool slow_match( boost::string_view url ) const;
+
+	lru_cache_stats_t cache_stats( ) const;
+}; // url_validator_engine_t
@@ -28,24 +28,118 @@
 #error "A wxWebView backend is required by this sample"
 #endif
 
+#include <wx/aui/auibook.h>
+#include <wx/fswatcher.h>
+#include <wx/gauge.h>
 #include <wx/infobar.h>
+#include <wx/listctrl.h>
 #include <wx/stc/stc.h>
+#include <wx/timer.h>
 #include <wx/webview.h>
 #include <wx/webviewarchivehandler.h>
 
+#include <array>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "asset_bundle.h"
+#include "automation_server.h"
 #include "config.h"
-
-// We map menu items to their history items
-WX_DECLARE_HASH_MAP( int, wxSharedPtr<wxWebViewHistoryItem>, wxIntegerHash, wxIntegerEqual, wxMenuHistoryMap );
+#include "find_engine.h"
+#include "history_store.h"
+#include "lru_cache.h"
+#include "navigation_policy.h"
+#include "navigation_timing.h"
+#include "page_cache.h"
+#include "page_search.h"
+#include "prefetcher.h"
+#include "supervisor.h"
+#include "text_export.h"
+#include "url_suggestions.h"
+#include "webview_pool.h"
 
 class WebFrame;
+struct PageSearchDialog;
 
 class WebApp : public wxApp {
+	enum class run_mode_t : uint8_t {
+		browser,
+		compile_config,
+		benchmark_config,
+		benchmark_archive,
+		pack_bundle,
+		supervise,
+		dump_text
+	};
+
 	wxString m_url;
+	// Set when the command line holds a url or a switch of the user's, which the
+	// config has to allow with enable_command_line
+	bool m_has_user_arguments;
 	WebFrame *m_frame;
-	config_t m_app_config;
+	// Replaced as a whole on reload, frames and queued policy checks keep the
+	// snapshot they started with
+	std::shared_ptr<config_t const> m_app_config;
+	std::string m_config_file;
+	run_mode_t m_run_mode;
+	// The zip read by benchmark_archive or the directory packed by pack_bundle
+	std::string m_mode_path;
+	// Set by modes that finish inside OnInit; OnRun then exits with it
+	boost::optional<int> m_exit_code;
+	// Set when this is a site process started by a supervisor
+	boost::optional<size_t> m_site_group;
+	std::string m_supervisor_service;
+	// Set by --automation, the frame then stays hidden and is driven over this socket
+	std::string m_automation_path;
+	// --dump-text loads each of these in turn and writes its text to m_dump_output, "-" for stdout
+	std::vector<std::string> m_dump_urls;
+	std::string m_dump_output;
+	size_t m_dump_failures;
+
+#if wxUSE_FSWATCHER
+	std::unique_ptr<wxFileSystemWatcher> m_config_watcher;
+#endif
+	// Editors often write a file several times in a row, reload once it settles.
+	// Created with the watcher, timers need the app to be running
+	std::unique_ptr<wxTimer> m_reload_timer;
+	std::thread m_reload_thread;
+	bool m_is_reloading;
+	// Null when the history files cannot be opened, history is then not kept
+	std::unique_ptr<history_store_t> m_history_store;
+	// Url bar completion shared by all frames
+	std::unique_ptr<url_suggestions_t> m_url_suggestions;
+	// Null unless page_cache_size was set at startup
+	std::unique_ptr<page_cache_t> m_page_cache;
+	// Warms the page cache, null without one
+	std::unique_ptr<prefetcher_t> m_prefetcher;
+	// The config's asset_bundle, else the built in one.  Null without either
+	std::unique_ptr<asset_bundle_t> m_asset_bundle;
+	std::unique_ptr<webview_pool_t> m_webview_pool;
+	// Only one of these, in --supervise mode and in its site processes respectively
+	std::unique_ptr<supervisor_t> m_supervisor;
+	std::unique_ptr<supervisor_link_t> m_supervisor_link;
+	std::unique_ptr<automation_server_t> m_automation_server;
+	std::unique_ptr<text_export_t> m_text_export;
+	// Load latencies of every frame, read over automation with get_navigation_timing
+	std::unique_ptr<navigation_timing_t> m_navigation_timing;
+
+#if wxUSE_FSWATCHER
+	void OnConfigFileChanged( wxFileSystemWatcherEvent &evt );
+#endif
+	void OnReloadTimer( wxTimerEvent &evt );
+	void StartConfigReload( );
+	void OnConfigReloaded( std::shared_ptr<config_t const> config, std::string const &error );
+	// Queues a navigate and a get_page_text automation request per dump url on the frame
+	void StartTextDump( );
 
   public:
 	WebApp( );
@@ -56,13 +150,123 @@ class WebApp : public wxApp {
 	WebApp &operator=( WebApp && ) = default;
 
 	bool OnInit( ) override;
+	int OnRun( ) override;
+	int OnExit( ) override;
+	void OnEventLoopEnter( wxEventLoopBase *loop ) override;
 	void OnInitCmdLine( wxCmdLineParser &parser ) override;
 	bool OnCmdLineParsed( wxCmdLineParser &parser ) override;
+
+	std::shared_ptr<config_t const> GetConfig( ) const;
 }; // WebApp
 
+wxDECLARE_APP( WebApp );
+
+// App wide services a frame uses.  Owned by WebApp, any of them may be null
+struct frame_services_t {
+	history_store_t *history_store;
+	url_suggestions_t *url_suggestions;
+	page_cache_t *page_cache;
+	prefetcher_t *prefetcher;
+	asset_bundle_t const *asset_bundle;
+	webview_pool_t *webview_pool;
+	// Set in a site process, urls of other site groups are handed to it
+	supervisor_link_t *supervisor_link;
+	navigation_timing_t *navigation_timing;
+}; // frame_services_t
+
+// The last values pushed to the toolbar, title and cursor.  Widgets are only
+// touched when one of these changes
+struct ui_state_t {
+	bool can_go_back;
+	bool can_go_forward;
+	bool is_busy;
+	wxString url;
+	wxString title;
+}; // ui_state_t
+
 class WebFrame : public wxFrame {
+	// Tools menu items have fixed ids so that a single Bind over the range
+	// covers the whole menu
+	enum tools_menu_id_t : int {
+		id_tools_first = wxID_HIGHEST + 1,
+		id_print = id_tools_first,
+		id_view_source,
+		id_view_text,
+		id_zoom_layout,
+		id_zoom_tiny,
+		id_zoom_small,
+		id_zoom_medium,
+		id_zoom_large,
+		id_zoom_largest,
+		id_handle_navigation,
+		id_handle_new_window,
+		id_find,
+		id_find_in_pages,
+		id_clear_history,
+		id_enable_history,
+		id_cut,
+		id_copy,
+		id_paste,
+		id_undo,
+		id_redo,
+		id_edit_mode,
+		id_scroll_line_up,
+		id_scroll_line_down,
+		id_scroll_page_up,
+		id_scroll_page_down,
+		id_run_script,
+		id_selection_clear,
+		id_selection_delete,
+		id_select_all,
+		id_load_scheme,
+		id_use_memory_fs,
+		id_context_menu,
+		id_new_tab,
+		id_close_tab,
+		id_tools_end,
+		// One id per visible history entry, see history_page_size
+		id_history_first = id_tools_end,
+		id_history_end = id_history_first + 25,
+		id_history_older = id_history_end,
+		id_history_newer
+	};
+	static size_t const history_page_size = id_history_end - id_history_first;
+	using menu_handler_t = void ( WebFrame::* )( wxCommandEvent & );
+
+	// A tab keeps its notebook page while suspended, only the view is destroyed
+	struct tab_t {
+		wxPanel *page;
+		// Null while suspended
+		wxWebView *view;
+		// Where a suspended tab resumes, and the scroll offset to restore once it has loaded
+		wxString url;
+		boost::optional<wxPoint> scroll;
+		// m_tab_clock as of the last time the tab was selected
+		uint64_t last_active;
+		// Waiting on its scroll offset before the view goes.  Selecting the tab cancels it
+		bool is_suspending;
+	};
+
 	wxTextCtrl *m_url;
+	// The selected tab's view
 	wxWebView *m_browser;
+	wxAuiNotebook *m_tabs;
+	std::vector<tab_t> m_tab_states;
+	uint64_t m_tab_clock;
+
+	// wxWebView::RunScript cannot return a value, so a probe script reports one
+	// through document.title.  Backends that run scripts asynchronously only
+	// show it in a later title change, so results are always delivered from the
+	// event loop, empty when the view went away or the deadline passed
+	using title_probe_handler_t = std::function<void( boost::optional<wxString> )>;
+	struct title_probe_t {
+		uint64_t id;
+		wxWebView *view;
+		std::chrono::steady_clock::time_point deadline;
+		title_probe_handler_t on_result;
+	};
+	std::vector<title_probe_t> m_title_probes;
+	uint64_t m_title_probe_count;
 
 	wxToolBar *m_toolbar;
 	wxToolBarToolBase *m_toolbar_back;
@@ -105,20 +309,138 @@ class WebFrame : public wxFrame {
 	wxMenuItem *m_selection_delete;
 	wxMenuItem *m_find;
 	wxMenuItem *m_context_menu;
+	// Indexed by id - id_tools_first, empty for items without a handler
+	std::array<menu_handler_t, id_tools_end - id_tools_first> m_tools_handlers;
 
 	wxInfoBar *m_info;
 	// wxStaticText *m_info_text;
+	wxPanel *m_find_panel;
 	wxTextCtrl *m_find_ctrl;
 	wxToolBar *m_find_toolbar;
+	wxLogWindow *m_log_window;
 
-	wxMenuHistoryMap m_histMenuItems;
+	// The webview history as of the last sync and the page of it shown in the
+	// History menu.  m_history_slots holds the label of each slot in the menu
+	std::vector<wxSharedPtr<wxWebViewHistoryItem>> m_history;
+	size_t m_history_current;
+	size_t m_history_page_start;
+	std::vector<wxString> m_history_slots;
+	boost::optional<size_t> m_history_checked;
+	size_t m_history_slot_pos;
+	wxMenuItem *m_history_older;
+	wxMenuItem *m_history_newer;
+	frame_services_t m_services;
+	// The main frame url last loaded, where the next navigation comes from
+	std::string m_last_loaded_url;
 	wxString m_findText;
 	int m_findFlags;
 	int m_findCount;
-	config_t const *m_app_config;
+	// Typing into the find box is debounced, then searched for in a text snapshot
+	// of the page off the GUI thread.  Only a settled query that matches reaches
+	// the webview's own Find, for its highlight.  The snapshot is retaken after a
+	// load, a tab switch or reopening the find bar.  Created on first use
+	std::unique_ptr<find_engine_t> m_find_engine;
+	wxTimer m_find_timer;
+	uint64_t m_find_generation;
+	bool m_is_find_snapshot_stale;
+	// Text of the main frame documents loaded last, in any tab, for Find in Pages, bounded
+	// by bytes.  Only captured while search is enabled and once the dialog has been opened
+	string_lru_cache_t<std::shared_ptr<page_text_t const>> m_page_texts;
+	// Modeless, created on first use.  Closing it only hides it
+	PageSearchDialog *m_page_search;
+
+	void CapturePageText( wxWebView &view );
+	std::shared_ptr<config_t const> m_app_config;
+
+	ui_state_t m_ui_state;
+	// Catches state changes that arrive without a webview event
+	wxTimer m_state_timer;
+
+	void SetBusy( bool is_busy );
+	void BuildToolbar( wxSizer *sizer );
+	void BuildToolsMenu( );
+	wxMenuItem *AppendTool( wxMenu *menu, tools_menu_id_t id, wxString const &label, menu_handler_t handler,
+	                        wxItemKind kind = wxITEM_NORMAL );
+	void OnToolsMenu( wxCommandEvent &evt );
+	void SyncHistory( );
+	void UpdateHistoryMenu( );
+	void OnHistoryPage( wxCommandEvent &evt );
+	// The toolbar may exist but be hidden after a reload turned it off
+	bool HasToolbar( ) const;
+
+	// Evaluates expression in view and passes its value as a string to on_result
+	void RunTitleProbe( wxWebView &view, wxString const &expression, title_probe_handler_t on_result );
+	// True when title is a probe result rather than the page's own title
+	bool CompleteTitleProbe( wxWebView *view, wxString const &title );
+	// Answers the probes of a view that is going away, or of every view past its deadline
+	void DropTitleProbes( wxWebView const *view );
+	void ExpireTitleProbes( );
+
+	// A view with the scheme handlers and webview events in place, nothing loaded yet
+	wxWebView *CreateView( wxWindow *parent );
+	void AddTab( wxString const &url, bool is_selected );
+	void CloseTab( wxWindow *page );
+	tab_t *FindTab( wxObject const *page_or_view );
+	void SelectTab( tab_t &tab );
+	// Starts reading the scroll offset, FinishSuspendTab destroys the view once it is in
+	void SuspendTab( tab_t &tab );
+	void FinishSuspendTab( wxWebView *view, boost::optional<wxString> const &scroll );
+	void ResumeTab( tab_t &tab );
+	// Suspends the least recently selected background tabs while there are more
+	// than max_live_tabs, and one more each call while over tab_memory_limit
+	void GovernTabs( );
+	// The tab bar is only shown once there is a second tab
+	void UpdateTabBar( );
+	void OnTabChanged( wxAuiNotebookEvent &evt );
+	void OnTabClose( wxAuiNotebookEvent &evt );
+
+	// Url policy that needs a regex is decided off the GUI thread.  Only the
+	// most recent request (m_nav_generation) may resume a navigation, and the
+	// resumed url is let through once without being checked again
+	std::unique_ptr<navigation_policy_t> m_nav_policy;
+	uint64_t m_nav_generation;
+	std::string m_approved_url;
+	// Likewise for the site group check under a supervisor
+	std::string m_owned_url;
+	// Shared with the page cache handler of every view
+	std::shared_ptr<page_cache_documents_t> m_cache_documents;
+
+	void RequestNavigation( std::string url );
+	void SubmitPolicyCheck( std::string url );
+	void OnPolicyVerdict( uint64_t generation, std::shared_ptr<config_t const> const &config, std::string const &url,
+	                      bool is_allowed );
+	void SubmitOwnershipCheck( std::string url );
+	void OnOwnershipVerdict( uint64_t generation, std::string const &url, bool is_own );
+	void LoadApprovedURL( std::string const &url );
+
+	int GetFindFlags( bool is_backwards ) const;
+	void InvalidateFindSnapshot( );
+	void OnFindTextChanged( wxCommandEvent &evt );
+	void OnFindTimer( wxTimerEvent &evt );
+	void OnFindResult( uint64_t generation, find_result_t const &result );
+
+	// Automation requests run one at a time in arrival order, so a pipelined
+	// request sees the page of every navigate sent before it
+	struct automation_job_t {
+		automation_request_t request;
+		automation_reply_t reply;
+		// Set once a navigate has started loading, it fails if the page is not in by then
+		boost::optional<std::chrono::steady_clock::time_point> deadline;
+		// Set while a run_script waits for the page to report its result
+		bool is_running_script;
+	};
+	std::deque<automation_job_t> m_automation_jobs;
+
+	// Runs jobs from the front of the queue until one has to wait for a page
+	void RunAutomationJobs( );
+	automation_response_t RunAutomationCommand( automation_command_t command, automation_request_t const &request );
+	// Answers the navigate waiting at the front of the queue, if any, and moves on
+	void FinishAutomationNavigation( bool is_ok, std::string message );
+	// Answers the run_script waiting at the front of the queue, empty when it timed out
+	void FinishAutomationScript( boost::optional<wxString> const &value );
 
   public:
-	WebFrame( wxString const &url, config_t const &app_config );
+	WebFrame( wxString const &url, std::shared_ptr<config_t const> app_config, frame_services_t services );
 	virtual ~WebFrame( );
 	WebFrame( WebFrame && ) = default;
 	WebFrame &operator=( WebFrame && ) = default;
@@ -126,7 +448,15 @@ class WebFrame : public wxFrame {
 	WebFrame &operator=( WebFrame const & ) = default;
 
 	void UpdateState( );
-	void OnIdle( wxIdleEvent &evt );
+	// Load url, subject to the navigation policy, and bring the frame forward
+	void Navigate( std::string const &url );
+	// The page texts Find in Pages searches, most recently loaded first
+	std::vector<std::shared_ptr<page_text_t const>> GetPageTexts( ) const;
+	// Queues an automation request, reply is called once it has run
+	void RunAutomation( automation_request_t request, automation_reply_t reply );
+	// Switch to a reloaded config.  Widgets the old config did not create are built on demand
+	void ApplyConfig( std::shared_ptr<config_t const> app_config );
+	void OnStateTimer( wxTimerEvent &evt );
 	void OnUrl( wxCommandEvent &evt );
 	void OnBack( wxCommandEvent &evt );
 	void OnForward( wxCommandEvent &evt );
@@ -166,15 +496,69 @@ class WebFrame : public wxFrame {
 	void OnFind( wxCommandEvent &evt );
 	void OnFindDone( wxCommandEvent &evt );
 	void OnFindText( wxCommandEvent &evt );
+	void OnFindInPages( wxCommandEvent &evt );
 	// void OnFindOptions( wxCommandEvent &evt );
 	void OnEnableContextMenu( wxCommandEvent &evt );
+	void OnNewTab( wxCommandEvent &evt );
+	void OnCloseTab( wxCommandEvent &evt );
 }; // WebFrame
 
+// Opens at once and fills in while shown.  The source is converted and split
+// into chunks on a thread of its own, the GUI thread only appends them, and
+// the lexer only styles what is scrolled into view.  Shows page text too, with
+// wxSTC_LEX_NULL
 struct SourceViewDialog : wxDialog {
-	SourceViewDialog( wxWindow *parent, wxString source );
+  private:
+	wxStyledTextCtrl *m_text;
+	wxGauge *m_progress;
+	std::thread m_loader;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	// Chunks posted to the GUI thread and not appended yet.  The loader stays at
+	// most a couple ahead, so the event queue never holds the whole page
+	size_t m_chunks_in_flight;
+	bool m_is_stopping;
+
+	void LoadSource( wxString source );
+	void AppendChunk( std::string const &chunk, size_t loaded, size_t total );
+
+  public:
+	SourceViewDialog( wxWindow *parent, wxString const &title, wxString source, int lexer );
+	// Stops the loader, chunks still queued are dropped with the dialog
 	virtual ~SourceViewDialog( );
-	SourceViewDialog( SourceViewDialog const & ) = default;
-	SourceViewDialog &operator=( SourceViewDialog const & ) = default;
-	SourceViewDialog( SourceViewDialog && ) = default;
-	SourceViewDialog &operator=( SourceViewDialog && ) = default;
+	SourceViewDialog( SourceViewDialog const & ) = delete;
+	SourceViewDialog &operator=( SourceViewDialog const & ) = delete;
+	SourceViewDialog( SourceViewDialog && ) = delete;
+	SourceViewDialog &operator=( SourceViewDialog && ) = delete;
 }; // SourceViewDialog
+
+// Counts comma separated terms across the pages the frame loaded last, one row
+// a page with any hits.  Rows fill in as the worker gets through the pages,
+// and a page that loads while the dialog is open is rescanned on its own.
+// Activating a row navigates to it
+struct PageSearchDialog : wxDialog {
+  private:
+	WebFrame *m_frame;
+	wxTextCtrl *m_terms;
+	wxListCtrl *m_results;
+	std::vector<std::string> m_patterns;
+	// Results of an older search can still be queued behind a newer one
+	uint64_t m_generation;
+	std::unique_ptr<page_search_t> m_search;
+
+	void OnSearch( wxCommandEvent &evt );
+	void OnActivated( wxListEvent &evt );
+	void OnHits( uint64_t generation, page_hits_t const &hits );
+
+  public:
+	explicit PageSearchDialog( WebFrame *frame );
+	// Joins the worker, results still queued are dropped with the dialog
+	virtual ~PageSearchDialog( );
+	PageSearchDialog( PageSearchDialog const & ) = delete;
+	PageSearchDialog &operator=( PageSearchDialog const & ) = delete;
+	PageSearchDialog( PageSearchDialog && ) = delete;
+	PageSearchDialog &operator=( PageSearchDialog && ) = delete;
+
+	// Rescans a page that finished loading for the current terms
+	void AddPage( std::shared_ptr<page_text_t const> page );
+}; // PageSearchDialog
@@ -0,0 +1,78 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <wx/wx.h>
+
+#include <wx/webview.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Hidden wxWebView instances created ahead of time, so a new frame attaches to
+ * a view whose engine is already initialised instead of paying for
+ * wxWebView::New.  Parked views are children of a frame that is never shown
+ * and are refilled one per idle event, so the GUI stays responsive while the
+ * pool fills.  Views are handed out blank and never come back.  GUI thread
+ * only.
+ */
+class webview_pool_t {
+	// Never shown, and does not keep the app running once the last frame closes
+	class parking_frame_t : public wxFrame {
+	  public:
+		parking_frame_t( );
+		~parking_frame_t( ) override;
+
+		parking_frame_t( parking_frame_t const & ) = delete;
+		parking_frame_t( parking_frame_t && ) = delete;
+		parking_frame_t &operator=( parking_frame_t const & ) = delete;
+		parking_frame_t &operator=( parking_frame_t && ) = delete;
+
+		bool ShouldPreventAppExit( ) const override;
+	};
+
+	parking_frame_t *m_parking;
+	std::vector<wxWebView *> m_views;
+	size_t m_size;
+
+	void OnIdle( wxIdleEvent &evt );
+
+  public:
+	explicit webview_pool_t( size_t size );
+	// Destroys the parked views
+	~webview_pool_t( );
+
+	webview_pool_t( webview_pool_t const & ) = delete;
+	webview_pool_t( webview_pool_t && ) = delete;
+	webview_pool_t &operator=( webview_pool_t const & ) = delete;
+	webview_pool_t &operator=( webview_pool_t && ) = delete;
+
+	// A blank view moved under parent, created on the spot when none is parked.
+	// The caller registers handlers before loading anything
+	wxWebView *acquire( wxWindow *parent );
+	// Destroys parked views over a smaller size at once, a larger one fills on idle
+	void set_size( size_t size );
+	size_t available( ) const noexcept;
+}; // webview_pool_t
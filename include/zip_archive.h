@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lru_cache.h"
+#include "string_hash.h"
+
+struct zip_archive_error : public std::runtime_error {
+	explicit zip_archive_error( std::string const &message );
+	~zip_archive_error( );
+	zip_archive_error( zip_archive_error const & ) = default;
+	zip_archive_error( zip_archive_error && ) = default;
+	zip_archive_error &operator=( zip_archive_error const & ) = default;
+	zip_archive_error &operator=( zip_archive_error && ) = default;
+}; // zip_archive_error
+
+// Contents of an archive member.  owner keeps the memory behind data alive
+struct zip_blob_t {
+	boost::string_view contents;
+	std::shared_ptr<void const> owner;
+
+	char const *data( ) const noexcept;
+	size_t size( ) const noexcept;
+}; // zip_blob_t
+
+/**
+ * Read only zip archive mapped into memory once.  The central directory is
+ * parsed when opening into a hash index from member name to the member's data,
+ * so a lookup touches neither the file system nor the directory again.
+ * Stored members are returned as views into the mapping.  Deflated members
+ * are inflated and checked against their crc, and small ones are kept in an
+ * lru cache.  Zip64 archives are supported, encrypted members are not.  Safe
+ * to share between threads.
+ */
+class zip_archive_t {
+	struct member_t {
+		uint64_t data_offset;
+		uint64_t compressed_size;
+		uint64_t size;
+		uint32_t crc;
+		uint16_t method;
+	};
+
+	std::shared_ptr<boost::iostreams::mapped_file_source const> m_file;
+	// Keys are views of the names in the central directory
+	std::unordered_map<boost::string_view, member_t, string_view_hash_t> m_members;
+	string_lru_cache_t<std::shared_ptr<std::string const>> m_inflated;
+
+	void read_directory( );
+	std::shared_ptr<std::string const> inflate( boost::string_view name, member_t const &member ) const;
+
+  public:
+	// Throws zip_archive_error if path is not a readable zip
+	zip_archive_t( std::string const &path, size_t inflated_cache_size );
+	~zip_archive_t( );
+
+	zip_archive_t( zip_archive_t const & ) = delete;
+	zip_archive_t( zip_archive_t && ) = delete;
+	zip_archive_t &operator=( zip_archive_t const & ) = delete;
+	zip_archive_t &operator=( zip_archive_t && ) = delete;
+
+	// Empty when there is no such file member.  Throws zip_archive_error when
+	// the member is damaged or uses an unsupported compression method
+	boost::optional<zip_blob_t> read( boost::string_view name );
+	std::vector<std::string> names( ) const;
+	size_t size( ) const noexcept;
+}; // zip_archive_t
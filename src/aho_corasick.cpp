@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <deque>
+
+#include "aho_corasick.h"
+
+namespace {
+	unsigned char fold( char c ) noexcept {
+		auto const u = static_cast<unsigned char>( c );
+		return u >= 'A' && u <= 'Z' ? static_cast<unsigned char>( u - 'A' + 'a' ) : u;
+	}
+
+	std::array<uint32_t, 256> make_state( ) {
+		std::array<uint32_t, 256> result;
+		result.fill( 0 );
+		return result;
+	}
+} // namespace
+
+aho_corasick_t::aho_corasick_t( std::vector<std::string> const &patterns )
+    : m_next{}, m_fail{}, m_outputs{}, m_order{}, m_pattern_count{patterns.size( )} {
+
+	// The trie first, 0 is the root and doubles as "no child" since nothing points back to it
+	m_next.push_back( make_state( ) );
+	m_outputs.emplace_back( );
+	for( size_t n = 0; n < patterns.size( ); ++n ) {
+		if( patterns[n].empty( ) ) {
+			continue;
+		}
+		uint32_t state = 0;
+		for( auto const c : patterns[n] ) {
+			auto &next = m_next[state][fold( c )];
+			if( next == 0 ) {
+				next = static_cast<uint32_t>( m_next.size( ) );
+				m_next.push_back( make_state( ) );
+				m_outputs.emplace_back( );
+			}
+			state = m_next[state][fold( c )];
+		}
+		m_outputs[state].push_back( n );
+	}
+
+	// Then fail links, breadth first, turning missing children into the fail state's transition
+	m_fail.resize( m_next.size( ), 0 );
+	m_order.reserve( m_next.size( ) );
+	std::deque<uint32_t> queue;
+	for( auto const child : m_next[0] ) {
+		if( child != 0 ) {
+			queue.push_back( child );
+		}
+	}
+	while( !queue.empty( ) ) {
+		auto const state = queue.front( );
+		queue.pop_front( );
+		m_order.push_back( state );
+		for( size_t c = 0; c < 256; ++c ) {
+			auto const child = m_next[state][c];
+			auto const fallback = m_next[m_fail[state]][c];
+			if( child != 0 ) {
+				m_fail[child] = fallback;
+				queue.push_back( child );
+			} else {
+				m_next[state][c] = fallback;
+			}
+		}
+	}
+}
+
+size_t aho_corasick_t::pattern_count( ) const noexcept {
+	return m_pattern_count;
+}
+
+std::vector<size_t> aho_corasick_t::count( boost::string_view text ) const {
+	// Count visits to each state, then credit each state's visits to every
+	// shorter suffix of it, which also ended there
+	std::vector<size_t> visits( m_next.size( ), 0 );
+	uint32_t state = 0;
+	for( auto const c : text ) {
+		state = m_next[state][fold( c )];
+		++visits[state];
+	}
+	for( auto pos = m_order.rbegin( ); pos != m_order.rend( ); ++pos ) {
+		visits[m_fail[*pos]] += visits[*pos];
+	}
+	std::vector<size_t> result( m_pattern_count, 0 );
+	for( size_t n = 1; n < m_outputs.size( ); ++n ) {
+		for( auto const pattern : m_outputs[n] ) {
+			result[pattern] += visits[n];
+		}
+	}
+	return result;
+}
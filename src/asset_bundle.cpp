@@ -0,0 +1,267 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+#include "asset_bundle.h"
+#include "string_hash.h"
+#include "url_parts.h"
+
+namespace {
+	constexpr char const bundle_magic[8] = {'W', 'B', 'A', 'B', 'N', 'D', 'L', '\0'};
+	constexpr uint32_t const bundle_version = 1;
+	constexpr uint32_t const bundle_byte_order = 0x01020304;
+	constexpr uint64_t const data_alignment = 16;
+
+	struct asset_bundle_header_t {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint64_t file_size;
+		uint32_t asset_count;
+		uint32_t reserved;
+		uint64_t records_offset;
+		uint64_t strings_offset;
+		uint64_t strings_size;
+	};
+
+	// String offsets are from strings_offset, data_offset from the start
+	struct record_t {
+		uint64_t data_offset;
+		uint64_t data_size;
+		uint32_t name_offset;
+		uint32_t name_size;
+		uint32_t mime_offset;
+		uint32_t mime_size;
+		uint32_t etag_offset;
+		uint32_t etag_size;
+	};
+
+	struct mime_type_t {
+		char const *extension;
+		char const *mime_type;
+	};
+
+	constexpr mime_type_t const mime_types[] = {
+	    {".css", "text/css"},        {".gif", "image/gif"},         {".htm", "text/html"},
+	    {".html", "text/html"},      {".ico", "image/x-icon"},      {".jpeg", "image/jpeg"},
+	    {".jpg", "image/jpeg"},      {".js", "text/javascript"},    {".json", "application/json"},
+	    {".mp4", "video/mp4"},       {".png", "image/png"},         {".svg", "image/svg+xml"},
+	    {".ttf", "font/ttf"},        {".txt", "text/plain"},        {".wasm", "application/wasm"},
+	    {".webp", "image/webp"},     {".woff", "font/woff"},        {".woff2", "font/woff2"},
+	    {".xml", "application/xml"},
+	};
+
+	std::string get_mime_type( boost::filesystem::path const &path ) {
+		auto const extension = path.extension( ).string( );
+		for( auto const &type : mime_types ) {
+			if( iequal( extension, type.extension ) ) {
+				return type.mime_type;
+			}
+		}
+		return "application/octet-stream";
+	}
+
+	std::string get_etag( std::string const &data ) {
+		auto const hash = fnv1a_hash( data.data( ), data.size( ) );
+		std::ostringstream ss;
+		ss << '"' << std::hex << std::setfill( '0' ) << std::setw( 16 ) << hash << '"';
+		return ss.str( );
+	}
+
+	bool is_in_bounds( uint64_t offset, uint64_t count, uint64_t size ) noexcept {
+		return offset <= size && count <= size - offset;
+	}
+
+	template<typename T>
+	void append_bytes( std::vector<char> &buffer, T const &value ) {
+		auto const ptr = reinterpret_cast<char const *>( &value );
+		buffer.insert( buffer.end( ), ptr, ptr + sizeof( T ) );
+	}
+} // namespace
+
+asset_bundle_error::asset_bundle_error( std::string const &message ) : std::runtime_error{message} {}
+
+asset_bundle_error::~asset_bundle_error( ) {}
+
+asset_bundle_t::asset_bundle_t( std::string const &path ) : m_arena{}, m_image{}, m_assets{} {
+	std::ifstream in{path, std::ios::binary | std::ios::ate};
+	if( !in ) {
+		throw asset_bundle_error{"Error opening asset bundle; path='" + path + "'"};
+	}
+	m_arena.resize( static_cast<size_t>( in.tellg( ) ) );
+	in.seekg( 0 );
+	if( !in.read( m_arena.data( ), static_cast<std::streamsize>( m_arena.size( ) ) ) ) {
+		throw asset_bundle_error{"Error reading asset bundle; path='" + path + "'"};
+	}
+	m_image = boost::string_view{m_arena.data( ), m_arena.size( )};
+	read_index( );
+}
+
+asset_bundle_t::asset_bundle_t( boost::string_view image ) : m_arena{}, m_image{image}, m_assets{} {
+	read_index( );
+}
+
+asset_bundle_t::~asset_bundle_t( ) {}
+
+void asset_bundle_t::read_index( ) {
+	auto const data = m_image.data( );
+	auto const size = static_cast<uint64_t>( m_image.size( ) );
+	asset_bundle_header_t header;
+	if( size < sizeof( header ) ) {
+		throw asset_bundle_error{"Asset bundle is truncated"};
+	}
+	std::memcpy( &header, data, sizeof( header ) );
+	if( std::memcmp( header.magic, bundle_magic, sizeof( bundle_magic ) ) != 0 ) {
+		throw asset_bundle_error{"Not an asset bundle"};
+	}
+	if( header.version != bundle_version || header.byte_order != bundle_byte_order ) {
+		throw asset_bundle_error{"Asset bundle was packed by a different version or byte order"};
+	}
+	if( header.file_size != size || header.records_offset > size ||
+	    header.asset_count > ( size - header.records_offset ) / sizeof( record_t ) ||
+	    !is_in_bounds( header.strings_offset, header.strings_size, size ) ) {
+		throw asset_bundle_error{"Asset bundle is corrupt"};
+	}
+
+	auto const get_string = [&]( uint32_t offset, uint32_t count ) {
+		if( !is_in_bounds( offset, count, header.strings_size ) ) {
+			throw asset_bundle_error{"Asset bundle string out of range"};
+		}
+		return boost::string_view{data + header.strings_offset + offset, count};
+	};
+	m_assets.reserve( header.asset_count );
+	for( uint32_t n = 0; n < header.asset_count; ++n ) {
+		record_t record;
+		std::memcpy( &record, data + header.records_offset + n * sizeof( record_t ), sizeof( record ) );
+		if( !is_in_bounds( record.data_offset, record.data_size, size ) ) {
+			throw asset_bundle_error{"Asset bundle data out of range"};
+		}
+		m_assets.emplace( get_string( record.name_offset, record.name_size ),
+		                  asset_t{boost::string_view{data + record.data_offset, static_cast<size_t>( record.data_size )},
+		                          get_string( record.mime_offset, record.mime_size ),
+		                          get_string( record.etag_offset, record.etag_size )} );
+	}
+}
+
+boost::optional<asset_t> asset_bundle_t::find( boost::string_view name ) const {
+	auto const pos = m_assets.find( name );
+	if( pos == m_assets.end( ) ) {
+		return boost::none;
+	}
+	return pos->second;
+}
+
+size_t asset_bundle_t::size( ) const noexcept {
+	return m_assets.size( );
+}
+
+size_t asset_bundle_t::image_size( ) const noexcept {
+	return m_image.size( );
+}
+
+void write_asset_bundle( std::string const &directory, std::string const &bundle_file ) {
+	namespace fs = boost::filesystem;
+	fs::path const root{directory};
+	std::vector<fs::path> files;
+	for( fs::recursive_directory_iterator pos{root}, last; pos != last; ++pos ) {
+		if( fs::is_regular_file( pos->status( ) ) ) {
+			files.push_back( pos->path( ) );
+		}
+	}
+	std::sort( files.begin( ), files.end( ) );
+
+	std::string strings;
+	std::vector<record_t> records;
+	std::vector<std::string> contents;
+	records.reserve( files.size( ) );
+	contents.reserve( files.size( ) );
+	auto const add_string = [&strings]( std::string const &str, uint32_t &offset, uint32_t &size ) {
+		offset = static_cast<uint32_t>( strings.size( ) );
+		size = static_cast<uint32_t>( str.size( ) );
+		strings += str;
+	};
+	for( auto const &file : files ) {
+		std::ifstream in{file.string( ), std::ios::binary};
+		contents.emplace_back( std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{} );
+		if( in.bad( ) ) {
+			throw asset_bundle_error{"Error reading asset; path='" + file.string( ) + "'"};
+		}
+		// Names always use / so they match the url path
+		auto name = file.lexically_relative( root ).generic_string( );
+		record_t record;
+		std::memset( &record, 0, sizeof( record ) );
+		record.data_size = contents.back( ).size( );
+		add_string( name, record.name_offset, record.name_size );
+		add_string( get_mime_type( file ), record.mime_offset, record.mime_size );
+		add_string( get_etag( contents.back( ) ), record.etag_offset, record.etag_size );
+		records.push_back( record );
+	}
+
+	auto const align = []( uint64_t offset ) { return ( offset + data_alignment - 1 ) / data_alignment * data_alignment; };
+	asset_bundle_header_t header;
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.magic, bundle_magic, sizeof( bundle_magic ) );
+	header.version = bundle_version;
+	header.byte_order = bundle_byte_order;
+	header.asset_count = static_cast<uint32_t>( records.size( ) );
+	header.records_offset = sizeof( header );
+	header.strings_offset = header.records_offset + records.size( ) * sizeof( record_t );
+	header.strings_size = strings.size( );
+	auto offset = header.strings_offset + header.strings_size;
+	for( size_t n = 0; n < records.size( ); ++n ) {
+		offset = align( offset );
+		records[n].data_offset = offset;
+		offset += records[n].data_size;
+	}
+	header.file_size = offset;
+
+	std::vector<char> buffer;
+	buffer.reserve( static_cast<size_t>( header.file_size ) );
+	append_bytes( buffer, header );
+	for( auto const &record : records ) {
+		append_bytes( buffer, record );
+	}
+	buffer.insert( buffer.end( ), strings.begin( ), strings.end( ) );
+	for( size_t n = 0; n < records.size( ); ++n ) {
+		buffer.resize( static_cast<size_t>( records[n].data_offset ), '\0' );
+		buffer.insert( buffer.end( ), contents[n].begin( ), contents[n].end( ) );
+	}
+
+	auto const tmp_file = bundle_file + ".tmp";
+	{
+		std::ofstream out{tmp_file, std::ios::binary | std::ios::trunc};
+		out.write( buffer.data( ), static_cast<std::streamsize>( buffer.size( ) ) );
+		if( !out ) {
+			throw asset_bundle_error{"Error writing asset bundle; path='" + tmp_file + "'"};
+		}
+	}
+	fs::rename( tmp_file, bundle_file );
+}
@@ -0,0 +1,207 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <utility>
+
+#include "automation_protocol.h"
+
+boost::optional<automation_command_t> parse_automation_command( boost::string_view name ) {
+	if( name == "navigate" ) {
+		return automation_command_t::navigate;
+	}
+	if( name == "run_script" ) {
+		return automation_command_t::run_script;
+	}
+	if( name == "get_page_source" ) {
+		return automation_command_t::get_page_source;
+	}
+	if( name == "get_page_text" ) {
+		return automation_command_t::get_page_text;
+	}
+	if( name == "find" ) {
+		return automation_command_t::find;
+	}
+	if( name == "set_zoom" ) {
+		return automation_command_t::set_zoom;
+	}
+	if( name == "get_navigation_timing" ) {
+		return automation_command_t::get_navigation_timing;
+	}
+	return boost::none;
+}
+
+automation_request_t::automation_request_t( )
+    : daw::json::JsonLink<automation_request_t>{}, id{0}, command{}, argument{} {
+	link_json( );
+}
+
+automation_request_t::automation_request_t( int64_t request_id, std::string request_command,
+                                            std::string request_argument )
+    : daw::json::JsonLink<automation_request_t>{}
+    , id{request_id}
+    , command{std::move( request_command )}
+    , argument{std::move( request_argument )} {
+
+	link_json( );
+}
+
+automation_request_t::automation_request_t( automation_request_t const &other )
+    : daw::json::JsonLink<automation_request_t>{}, id{other.id}, command{other.command}, argument{other.argument} {
+
+	link_json( );
+}
+
+automation_request_t::automation_request_t( automation_request_t &&other )
+    : daw::json::JsonLink<automation_request_t>{}
+    , id{std::move( other.id )}
+    , command{std::move( other.command )}
+    , argument{std::move( other.argument )} {
+
+	link_json( );
+}
+
+automation_request_t &automation_request_t::operator=( automation_request_t const &rhs ) {
+	id = rhs.id;
+	command = rhs.command;
+	argument = rhs.argument;
+	return *this;
+}
+
+automation_request_t &automation_request_t::operator=( automation_request_t &&rhs ) {
+	id = std::move( rhs.id );
+	command = std::move( rhs.command );
+	argument = std::move( rhs.argument );
+	return *this;
+}
+
+automation_request_t::~automation_request_t( ) {}
+
+void automation_request_t::link_json( ) {
+	this->link_integral( "id", id );
+	this->link_string( "command", command );
+	this->link_string( "argument", argument );
+}
+
+automation_response_t::automation_response_t( )
+    : daw::json::JsonLink<automation_response_t>{}, id{0}, is_ok{false}, result{}, error{} {
+	link_json( );
+}
+
+automation_response_t::automation_response_t( int64_t response_id, bool response_is_ok, std::string response_result,
+                                              std::string response_error )
+    : daw::json::JsonLink<automation_response_t>{}
+    , id{response_id}
+    , is_ok{response_is_ok}
+    , result{std::move( response_result )}
+    , error{std::move( response_error )} {
+
+	link_json( );
+}
+
+automation_response_t::automation_response_t( automation_response_t const &other )
+    : daw::json::JsonLink<automation_response_t>{}
+    , id{other.id}
+    , is_ok{other.is_ok}
+    , result{other.result}
+    , error{other.error} {
+
+	link_json( );
+}
+
+automation_response_t::automation_response_t( automation_response_t &&other )
+    : daw::json::JsonLink<automation_response_t>{}
+    , id{std::move( other.id )}
+    , is_ok{std::move( other.is_ok )}
+    , result{std::move( other.result )}
+    , error{std::move( other.error )} {
+
+	link_json( );
+}
+
+automation_response_t &automation_response_t::operator=( automation_response_t const &rhs ) {
+	id = rhs.id;
+	is_ok = rhs.is_ok;
+	result = rhs.result;
+	error = rhs.error;
+	return *this;
+}
+
+automation_response_t &automation_response_t::operator=( automation_response_t &&rhs ) {
+	id = std::move( rhs.id );
+	is_ok = std::move( rhs.is_ok );
+	result = std::move( rhs.result );
+	error = std::move( rhs.error );
+	return *this;
+}
+
+automation_response_t::~automation_response_t( ) {}
+
+void automation_response_t::link_json( ) {
+	this->link_integral( "id", id );
+	this->link_boolean( "is_ok", is_ok );
+	this->link_string( "result", result );
+	this->link_string( "error", error );
+}
+
+automation_response_t make_automation_result( int64_t id, std::string result ) {
+	return automation_response_t{id, true, std::move( result ), std::string{}};
+}
+
+automation_response_t make_automation_error( int64_t id, std::string error ) {
+	return automation_response_t{id, false, std::string{}, std::move( error )};
+}
+
+std::string to_automation_line( automation_response_t const &response ) {
+	auto result = response.to_json_string( );
+	// Raw line breaks can only be formatting, inside a json string they are escaped
+	result.erase( std::remove_if( result.begin( ), result.end( ), []( char c ) { return c == '\n' || c == '\r'; } ),
+	              result.end( ) );
+	result += '\n';
+	return result;
+}
+
+automation_line_reader_t::automation_line_reader_t( size_t max_line_size )
+    : m_buffer{}, m_max_line_size{max_line_size} {}
+
+bool automation_line_reader_t::append( char const *data, size_t size, std::vector<std::string> &lines ) {
+	auto const last = data + size;
+	while( data != last ) {
+		auto const eol = std::find( data, last, '\n' );
+		m_buffer.append( data, eol );
+		if( m_buffer.size( ) > m_max_line_size ) {
+			return false;
+		}
+		if( eol == last ) {
+			break;
+		}
+		if( !m_buffer.empty( ) && m_buffer.back( ) == '\r' ) {
+			m_buffer.pop_back( );
+		}
+		if( !m_buffer.empty( ) ) {
+			lines.push_back( std::move( m_buffer ) );
+		}
+		m_buffer.clear( );
+		data = eol + 1;
+	}
+	return true;
+}
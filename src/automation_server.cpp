@@ -0,0 +1,222 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <boost/filesystem.hpp>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "automation_server.h"
+
+namespace {
+	constexpr int const server_socket_id = wxID_HIGHEST + 1;
+	constexpr int const connection_socket_id = wxID_HIGHEST + 2;
+	// A script is the largest thing a client sends
+	constexpr size_t const max_request_size = 16 * 1024 * 1024;
+	// Page sources are the largest thing sent back.  A client this far behind is dropped
+	constexpr size_t const max_pending_output = 256 * 1024 * 1024;
+	// Read per input event, the rest waits for the next one so other events get a turn
+	constexpr size_t const max_read_per_event = 256 * 1024;
+
+	uint64_t get_connection_id( wxSocketBase const &socket ) {
+		return static_cast<uint64_t>( reinterpret_cast<uintptr_t>( socket.GetClientData( ) ) );
+	}
+} // namespace
+
+void automation_server_t::socket_deleter_t::operator( )( wxSocketBase *socket ) const {
+	// Sockets may still have events queued, Destroy defers the delete until they are handled
+	socket->Destroy( );
+}
+
+automation_server_t::automation_server_t( std::string path, request_handler_t on_request )
+    : wxEvtHandler{}
+    , m_path{std::move( path )}
+    , m_on_request{std::move( on_request )}
+    , m_server{}
+    , m_connections{}
+    , m_next_id{1} {
+
+	Bind( wxEVT_SOCKET, &automation_server_t::OnServerEvent, this, server_socket_id );
+	Bind( wxEVT_SOCKET, &automation_server_t::OnConnectionEvent, this, connection_socket_id );
+}
+
+automation_server_t::~automation_server_t( ) {
+	m_connections.clear( );
+	if( m_server ) {
+		m_server.reset( );
+		boost::system::error_code ec;
+		boost::filesystem::remove( m_path, ec );
+	}
+}
+
+bool automation_server_t::start( ) {
+#ifdef wxHAS_UNIX_DOMAIN_SOCKETS
+	wxSocketBase::Initialize( );
+	// A socket is left behind by a run that did not exit cleanly, anything else
+	// at the path is not ours to remove
+	boost::system::error_code ec;
+	auto const existing = boost::filesystem::symlink_status( m_path, ec ).type( );
+	if( existing == boost::filesystem::socket_file ) {
+		boost::filesystem::remove( m_path, ec );
+	} else if( existing != boost::filesystem::file_not_found ) {
+		std::cerr << "Error creating automation socket, the path is taken by something else; path='" << m_path
+		          << "'\n";
+		return false;
+	}
+
+	wxUNIXaddress address;
+	address.Filename( m_path );
+	// Anyone who can connect can drive the browser, so the socket is the owner's
+	// alone from the moment it is bound
+	auto const old_mask = umask( 077 );
+	std::unique_ptr<wxSocketServer, socket_deleter_t> server{new wxSocketServer{address, wxSOCKET_NOWAIT}};
+	umask( old_mask );
+	if( !server->IsOk( ) ) {
+		std::cerr << "Error creating automation socket; path='" << m_path << "'\n";
+		return false;
+	}
+	server->SetEventHandler( *this, server_socket_id );
+	server->SetNotify( wxSOCKET_CONNECTION_FLAG );
+	server->Notify( true );
+	m_server = std::move( server );
+	return true;
+#else
+	std::cerr << "Automation needs unix domain sockets, which this platform lacks; path='" << m_path << "'\n";
+	return false;
+#endif
+}
+
+void automation_server_t::OnServerEvent( wxSocketEvent &WXUNUSED( evt ) ) {
+	while( true ) {
+		socket_ptr_t socket{m_server->Accept( false )};
+		if( !socket ) {
+			return;
+		}
+		auto const id = m_next_id++;
+		socket->SetFlags( wxSOCKET_NOWAIT );
+		socket->SetClientData( reinterpret_cast<void *>( static_cast<uintptr_t>( id ) ) );
+		socket->SetEventHandler( *this, connection_socket_id );
+		socket->SetNotify( wxSOCKET_INPUT_FLAG | wxSOCKET_OUTPUT_FLAG | wxSOCKET_LOST_FLAG );
+		socket->Notify( true );
+		m_connections.emplace( id,
+		                       connection_t{std::move( socket ), automation_line_reader_t{max_request_size}, {}} );
+	}
+}
+
+void automation_server_t::OnConnectionEvent( wxSocketEvent &evt ) {
+	auto const id = get_connection_id( *evt.GetSocket( ) );
+	switch( evt.GetSocketEvent( ) ) {
+	case wxSOCKET_INPUT:
+		read( id );
+		break;
+	case wxSOCKET_OUTPUT:
+		flush( id );
+		break;
+	case wxSOCKET_LOST:
+		close( id );
+		break;
+	default:
+		break;
+	}
+}
+
+void automation_server_t::read( uint64_t id ) {
+	std::vector<std::string> lines;
+	{
+		auto const pos = m_connections.find( id );
+		if( pos == m_connections.end( ) ) {
+			return;
+		}
+		auto &connection = pos->second;
+		char buffer[16 * 1024];
+		size_t total = 0;
+		while( total < max_read_per_event ) {
+			connection.socket->Read( buffer, sizeof( buffer ) );
+			auto const count = static_cast<size_t>( connection.socket->LastCount( ) );
+			if( count == 0 ) {
+				break;
+			}
+			total += count;
+			if( !connection.reader.append( buffer, count, lines ) ) {
+				std::cerr << "Automation request too large, closing the connection\n";
+				close( id );
+				return;
+			}
+		}
+	}
+	// A handler may reply at once, which can close the connection
+	for( auto &line : lines ) {
+		automation_request_t request;
+		try {
+			request.from_json_string( line );
+		} catch( std::exception const &ex ) {
+			send( id, make_automation_error( 0, std::string{"Malformed request; message='"} + ex.what( ) + "'" ) );
+			continue;
+		}
+		m_on_request( std::move( request ),
+		              [this, id]( automation_response_t response ) { send( id, response ); } );
+	}
+}
+
+void automation_server_t::send( uint64_t id, automation_response_t const &response ) {
+	auto const pos = m_connections.find( id );
+	if( pos == m_connections.end( ) ) {
+		return;
+	}
+	pos->second.output += to_automation_line( response );
+	if( pos->second.output.size( ) > max_pending_output ) {
+		std::cerr << "Automation client is not reading its responses, closing the connection\n";
+		close( id );
+		return;
+	}
+	flush( id );
+}
+
+void automation_server_t::flush( uint64_t id ) {
+	auto const pos = m_connections.find( id );
+	if( pos == m_connections.end( ) ) {
+		return;
+	}
+	auto &connection = pos->second;
+	while( !connection.output.empty( ) ) {
+		connection.socket->Write( connection.output.data( ), static_cast<wxUint32>( connection.output.size( ) ) );
+		auto const count = static_cast<size_t>( connection.socket->LastCount( ) );
+		connection.output.erase( 0, count );
+		if( count == 0 ) {
+			if( !connection.socket->Error( ) || connection.socket->LastError( ) == wxSOCKET_WOULDBLOCK ) {
+				// The rest goes on the next output event
+				return;
+			}
+			close( id );
+			return;
+		}
+	}
+}
+
+void automation_server_t::close( uint64_t id ) {
+	m_connections.erase( id );
+}
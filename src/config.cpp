@@ -20,42 +20,64 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <regex>
+#include <stdexcept>
 #include <string>
 
 #include "config.h"
+#include "url_validator.h"
 
 config_t::~config_t( ) {}
 
 bool config_t::is_valid_url( boost::string_view url ) const {
-	if( url_validators.empty( ) ) {
-		return true;
+	if( !m_url_engine ) {
+		// Not compiled yet, pay for a one off engine
+		return url_validator_engine_t{url_validators, 0}.is_match( url );
 	}
-	for( auto const & url_validator: url_validators ) {
-		if( url_validator.is_regex ) {
-			std::regex r{ url_validator.url };
-			if( std::regex_match( url.to_string( ), r ) ) {
-				return true;
-			}
-		} else {
-			return url_validator.url == url;
-		}
+	return m_url_engine->is_match( url );
+}
+
+boost::optional<bool> config_t::fast_url_verdict( boost::string_view url ) const {
+	if( !m_url_engine ) {
+		return boost::none;
+	}
+	return m_url_engine->fast_match( url );
+}
+
+bool config_t::evaluate_url( boost::string_view url ) const {
+	if( !m_url_engine ) {
+		return is_valid_url( url );
+	}
+	return m_url_engine->slow_match( url );
+}
+
+lru_cache_stats_t config_t::url_cache_stats( ) const {
+	if( !m_url_engine ) {
+		return lru_cache_stats_t{0, 0, 0, 0};
 	}
-	return false;
+	return m_url_engine->cache_stats( );
 }
 
-url_validation_t::url_validation_t( ) : daw::json::JsonLink<url_validation_t>{}, is_regex{false}, url{""} {
+void config_t::compile_url_validators( ) {
+	auto const cache_size = url_cache_size > 0 ? static_cast<size_t>( url_cache_size ) : 0;
+	m_url_engine = std::make_shared<url_validator_engine_t const>( url_validators, cache_size );
+}
+
+url_validation_t::url_validation_t( )
+    : daw::json::JsonLink<url_validation_t>{}, is_regex{false}, match{"exact"}, url{""} {
 	link_json( );
 }
 
 url_validation_t::url_validation_t( url_validation_t const &other )
-    : daw::json::JsonLink<url_validation_t>{}, is_regex{other.is_regex}, url{other.url} {
+    : daw::json::JsonLink<url_validation_t>{}, is_regex{other.is_regex}, match{other.match}, url{other.url} {
 
 	link_json( );
 }
 
 url_validation_t::url_validation_t( url_validation_t &&other )
-    : daw::json::JsonLink<url_validation_t>{}, is_regex{std::move( other.is_regex )}, url{std::move( other.url )} {
+    : daw::json::JsonLink<url_validation_t>{}
+    , is_regex{std::move( other.is_regex )}
+    , match{std::move( other.match )}
+    , url{std::move( other.url )} {
 
 	link_json( );
 }
@@ -76,8 +98,22 @@ url_validation_t &url_validation_t::operator=( url_validation_t &&rhs ) {
 
 url_validation_t::~url_validation_t( ) {}
 
+url_validation_t::kind_t url_validation_t::kind( ) const {
+	if( is_regex || match == "regex" ) {
+		return kind_t::regex;
+	}
+	if( match == "prefix" ) {
+		return kind_t::prefix;
+	}
+	if( match.empty( ) || match == "exact" ) {
+		return kind_t::exact;
+	}
+	throw std::invalid_argument( "Unknown url validator match '" + match + "'; url='" + url + "'" );
+}
+
 void url_validation_t::link_json( ) {
 	this->link_boolean( "is_regex", is_regex );
+	this->link_string( "match", match );
 	this->link_string( "url", url );
 }
 
@@ -86,6 +122,7 @@ config_t::config_t( )
     , app_icon{}
     , app_title{}
     , home_url{}
+    , asset_bundle{}
     , enable_clipboard{true}
     , enable_command_line{true}
     , enable_debug_window{true}
@@ -100,7 +137,18 @@ config_t::config_t( )
     , enable_view_source{true}
     , enable_view_text{true}
     , enable_zoom{true}
-    , url_validators{} {
+    , url_cache_size{256}
+    , page_cache_size{256 * 1024 * 1024}
+    , page_cache_entry_size{16 * 1024 * 1024}
+    , prefetch_pages{0}
+    , prefetch_bandwidth{4 * 1024 * 1024}
+    , webview_pool_size{0}
+    , max_live_tabs{0}
+    , tab_memory_limit{0}
+    , child_memory_limit{0}
+    , child_cpu_limit{0}
+    , url_validators{}
+    , m_url_engine{} {
 
 	link_json( );
 }
@@ -110,6 +158,7 @@ config_t::config_t( config_t const &other )
     , app_icon{other.app_icon}
     , app_title{other.app_title}
     , home_url{other.home_url}
+    , asset_bundle{other.asset_bundle}
     , enable_clipboard{other.enable_clipboard}
     , enable_command_line{other.enable_command_line}
     , enable_debug_window{other.enable_debug_window}
@@ -124,7 +173,18 @@ config_t::config_t( config_t const &other )
     , enable_view_source{other.enable_view_source}
     , enable_view_text{other.enable_view_text}
     , enable_zoom{other.enable_zoom}
-    , url_validators{other.url_validators} {
+    , url_cache_size{other.url_cache_size}
+    , page_cache_size{other.page_cache_size}
+    , page_cache_entry_size{other.page_cache_entry_size}
+    , prefetch_pages{other.prefetch_pages}
+    , prefetch_bandwidth{other.prefetch_bandwidth}
+    , webview_pool_size{other.webview_pool_size}
+    , max_live_tabs{other.max_live_tabs}
+    , tab_memory_limit{other.tab_memory_limit}
+    , child_memory_limit{other.child_memory_limit}
+    , child_cpu_limit{other.child_cpu_limit}
+    , url_validators{other.url_validators}
+    , m_url_engine{other.m_url_engine} {
 
 	link_json( );
 }
@@ -134,6 +194,7 @@ config_t::config_t( config_t &&other )
     , app_icon{std::move( other.app_icon )}
     , app_title{std::move( other.app_title )}
     , home_url{std::move( other.home_url )}
+    , asset_bundle{std::move( other.asset_bundle )}
     , enable_clipboard{std::move( other.enable_clipboard )}
     , enable_command_line{std::move( other.enable_command_line )}
     , enable_debug_window{std::move( other.enable_debug_window )}
@@ -148,7 +209,18 @@ config_t::config_t( config_t &&other )
     , enable_view_source{std::move( other.enable_view_source )}
     , enable_view_text{std::move( other.enable_view_text )}
     , enable_zoom{std::move( other.enable_zoom )}
-    , url_validators{std::move( other.url_validators )} {
+    , url_cache_size{std::move( other.url_cache_size )}
+    , page_cache_size{std::move( other.page_cache_size )}
+    , page_cache_entry_size{std::move( other.page_cache_entry_size )}
+    , prefetch_pages{std::move( other.prefetch_pages )}
+    , prefetch_bandwidth{std::move( other.prefetch_bandwidth )}
+    , webview_pool_size{std::move( other.webview_pool_size )}
+    , max_live_tabs{std::move( other.max_live_tabs )}
+    , tab_memory_limit{std::move( other.tab_memory_limit )}
+    , child_memory_limit{std::move( other.child_memory_limit )}
+    , child_cpu_limit{std::move( other.child_cpu_limit )}
+    , url_validators{std::move( other.url_validators )}
+    , m_url_engine{std::move( other.m_url_engine )} {
 
 	link_json( );
 }
@@ -157,6 +229,7 @@ config_t &config_t::operator=( config_t const &rhs ) {
 	app_icon = rhs.app_icon;
 	app_title = rhs.app_title;
 	home_url = rhs.home_url;
+	asset_bundle = rhs.asset_bundle;
 	url_validators = rhs.url_validators;
 	enable_clipboard = rhs.enable_clipboard;
 	enable_command_line = rhs.enable_command_line;
@@ -172,7 +245,18 @@ config_t &config_t::operator=( config_t const &rhs ) {
 	enable_view_source = rhs.enable_view_source;
 	enable_view_text = rhs.enable_view_text;
 	enable_zoom = rhs.enable_zoom;
+	url_cache_size = rhs.url_cache_size;
+	page_cache_size = rhs.page_cache_size;
+	page_cache_entry_size = rhs.page_cache_entry_size;
+	prefetch_pages = rhs.prefetch_pages;
+	prefetch_bandwidth = rhs.prefetch_bandwidth;
+	webview_pool_size = rhs.webview_pool_size;
+	max_live_tabs = rhs.max_live_tabs;
+	tab_memory_limit = rhs.tab_memory_limit;
+	child_memory_limit = rhs.child_memory_limit;
+	child_cpu_limit = rhs.child_cpu_limit;
 	url_validators = rhs.url_validators;
+	m_url_engine = rhs.m_url_engine;
 	return *this;
 }
 
@@ -180,6 +264,7 @@ config_t &config_t::operator=( config_t &&rhs ) {
 	app_icon = std::move( rhs.app_icon );
 	app_title = std::move( rhs.app_title );
 	home_url = std::move( rhs.home_url );
+	asset_bundle = std::move( rhs.asset_bundle );
 	url_validators = std::move( rhs.url_validators );
 	enable_clipboard = std::move( rhs.enable_clipboard );
 	enable_command_line = std::move( rhs.enable_command_line );
@@ -195,7 +280,18 @@ config_t &config_t::operator=( config_t &&rhs ) {
 	enable_view_source = std::move( rhs.enable_view_source );
 	enable_view_text = std::move( rhs.enable_view_text );
 	enable_zoom = std::move( rhs.enable_zoom );
+	url_cache_size = std::move( rhs.url_cache_size );
+	page_cache_size = std::move( rhs.page_cache_size );
+	page_cache_entry_size = std::move( rhs.page_cache_entry_size );
+	prefetch_pages = std::move( rhs.prefetch_pages );
+	prefetch_bandwidth = std::move( rhs.prefetch_bandwidth );
+	webview_pool_size = std::move( rhs.webview_pool_size );
+	max_live_tabs = std::move( rhs.max_live_tabs );
+	tab_memory_limit = std::move( rhs.tab_memory_limit );
+	child_memory_limit = std::move( rhs.child_memory_limit );
+	child_cpu_limit = std::move( rhs.child_cpu_limit );
 	url_validators = std::move( rhs.url_validators );
+	m_url_engine = std::move( rhs.m_url_engine );
 	return *this;
 }
 
@@ -203,6 +299,7 @@ void config_t::link_json( ) {
 	this->link_string( "app_icon", app_icon );
 	this->link_string( "app_title", app_title );
 	this->link_string( "home_url", home_url );
+	this->link_string( "asset_bundle", asset_bundle );
 	this->link_boolean( "enable_clipboard", enable_clipboard );
 	this->link_boolean( "enable_command_line", enable_command_line );
 	this->link_boolean( "enable_debug_window", enable_debug_window );
@@ -217,6 +314,16 @@ void config_t::link_json( ) {
 	this->link_boolean( "enable_view_source", enable_view_source );
 	this->link_boolean( "enable_view_text", enable_view_text );
 	this->link_boolean( "enable_zoom", enable_zoom );
+	this->link_integral( "url_cache_size", url_cache_size );
+	this->link_integral( "page_cache_size", page_cache_size );
+	this->link_integral( "page_cache_entry_size", page_cache_entry_size );
+	this->link_integral( "prefetch_pages", prefetch_pages );
+	this->link_integral( "prefetch_bandwidth", prefetch_bandwidth );
+	this->link_integral( "webview_pool_size", webview_pool_size );
+	this->link_integral( "max_live_tabs", max_live_tabs );
+	this->link_integral( "tab_memory_limit", tab_memory_limit );
+	this->link_integral( "child_memory_limit", child_memory_limit );
+	this->link_integral( "child_cpu_limit", child_cpu_limit );
 	this->link_array( "url_validators", url_validators );
 }
 
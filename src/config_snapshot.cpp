@@ -0,0 +1,290 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "config_snapshot.h"
+#include "string_hash.h"
+
+namespace {
+	constexpr char const snapshot_magic[8] = {'W', 'B', 'A', 'C', 'O', 'N', 'F', '\0'};
+	constexpr uint32_t const snapshot_version = 8;
+	constexpr uint32_t const snapshot_byte_order = 0x01020304;
+
+	struct string_ref_t {
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct validator_record_t {
+		uint32_t string_index;
+		uint8_t kind;
+		uint8_t reserved[3];
+	};
+
+	// Bit n of the flags is the feature config_denied_exception_kind( n )
+	constexpr bool config_t::*const flag_members[] = {
+	    &config_t::enable_clipboard,  &config_t::enable_command_line, &config_t::enable_debug_window,
+	    &config_t::enable_edit,       &config_t::enable_navigation,   &config_t::enable_printing,
+	    &config_t::enable_reload,     &config_t::enable_search,       &config_t::enable_select,
+	    &config_t::enable_title_change, &config_t::enable_toolbar,    &config_t::enable_view_source,
+	    &config_t::enable_view_text,  &config_t::enable_zoom,
+	};
+
+	constexpr url_validation_t::kind_t const kind_order[] = {
+	    url_validation_t::kind_t::exact, url_validation_t::kind_t::prefix, url_validation_t::kind_t::regex};
+
+	bool is_in_bounds( uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size ) noexcept {
+		if( offset > file_size ) {
+			return false;
+		}
+		return count <= ( file_size - offset ) / element_size;
+	}
+
+	template<typename T>
+	void append_bytes( std::vector<char> &buffer, T const &value ) {
+		auto const ptr = reinterpret_cast<char const *>( &value );
+		buffer.insert( buffer.end( ), ptr, ptr + sizeof( T ) );
+	}
+
+	bool hash_file( std::string const &path, uint64_t &hash, uint64_t &size ) {
+		std::ifstream in{path, std::ios::binary};
+		if( !in ) {
+			return false;
+		}
+		hash = fnv1a_offset_basis;
+		size = 0;
+		char buffer[4096];
+		while( in.read( buffer, sizeof( buffer ) ) || in.gcount( ) > 0 ) {
+			auto const count = static_cast<size_t>( in.gcount( ) );
+			hash = fnv1a_hash( buffer, count, hash );
+			size += count;
+		}
+		return in.eof( );
+	}
+
+	config_snapshot_header_t read_header( char const *data, size_t size ) {
+		config_snapshot_header_t header;
+		if( size < sizeof( header ) ) {
+			throw config_snapshot_error{"Config snapshot is truncated"};
+		}
+		std::memcpy( &header, data, sizeof( header ) );
+		if( std::memcmp( header.magic, snapshot_magic, sizeof( snapshot_magic ) ) != 0 ) {
+			throw config_snapshot_error{"Not a config snapshot"};
+		}
+		if( header.version != snapshot_version ) {
+			throw config_snapshot_error{"Unsupported config snapshot version " + std::to_string( header.version )};
+		}
+		if( header.byte_order != snapshot_byte_order ) {
+			throw config_snapshot_error{"Config snapshot was built on a machine with a different byte order"};
+		}
+		return header;
+	}
+} // namespace
+
+config_snapshot_error::config_snapshot_error( std::string const &message ) : std::runtime_error{message} {}
+
+config_snapshot_error::~config_snapshot_error( ) {}
+
+std::string get_config_snapshot_file( std::string const &config_file ) {
+	return config_file + ".snapshot";
+}
+
+void write_config_snapshot( config_t const &config, std::string const &config_file,
+                            std::string const &snapshot_file ) {
+	std::vector<std::string const *> strings = {&config.app_icon, &config.app_title, &config.home_url,
+	                                            &config.asset_bundle};
+	std::vector<validator_record_t> validators;
+	validators.reserve( config.url_validators.size( ) );
+	for( auto const kind : kind_order ) {
+		for( auto const &validator : config.url_validators ) {
+			if( validator.kind( ) == kind ) {
+				validators.push_back(
+				    validator_record_t{static_cast<uint32_t>( strings.size( ) ), static_cast<uint8_t>( kind ), {}} );
+				strings.push_back( &validator.url );
+			}
+		}
+	}
+
+	std::vector<string_ref_t> string_refs;
+	string_refs.reserve( strings.size( ) );
+	uint64_t string_data_size = 0;
+	for( auto const str : strings ) {
+		string_refs.push_back(
+		    string_ref_t{static_cast<uint32_t>( string_data_size ), static_cast<uint32_t>( str->size( ) )} );
+		string_data_size += str->size( );
+	}
+
+	config_snapshot_header_t header;
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.magic, snapshot_magic, sizeof( snapshot_magic ) );
+	header.version = snapshot_version;
+	header.byte_order = snapshot_byte_order;
+	if( !hash_file( config_file, header.source_hash, header.source_size ) ) {
+		throw config_snapshot_error{"Error reading config; path='" + config_file + "'"};
+	}
+	for( size_t n = 0; n < sizeof( flag_members ) / sizeof( flag_members[0] ); ++n ) {
+		if( config.*flag_members[n] ) {
+			header.flags |= 1u << n;
+		}
+	}
+	header.string_count = static_cast<uint32_t>( string_refs.size( ) );
+	header.validator_count = static_cast<uint32_t>( validators.size( ) );
+	header.url_cache_size = config.url_cache_size;
+	header.page_cache_size = config.page_cache_size;
+	header.page_cache_entry_size = config.page_cache_entry_size;
+	header.prefetch_pages = config.prefetch_pages;
+	header.prefetch_bandwidth = config.prefetch_bandwidth;
+	header.webview_pool_size = config.webview_pool_size;
+	header.max_live_tabs = config.max_live_tabs;
+	header.tab_memory_limit = config.tab_memory_limit;
+	header.child_memory_limit = config.child_memory_limit;
+	header.child_cpu_limit = config.child_cpu_limit;
+	header.strings_offset = sizeof( header );
+	header.validators_offset = header.strings_offset + string_refs.size( ) * sizeof( string_ref_t );
+	header.string_data_offset = header.validators_offset + validators.size( ) * sizeof( validator_record_t );
+	header.string_data_size = string_data_size;
+	header.file_size = header.string_data_offset + string_data_size;
+
+	std::vector<char> buffer;
+	buffer.reserve( static_cast<size_t>( header.file_size ) );
+	append_bytes( buffer, header );
+	for( auto const &ref : string_refs ) {
+		append_bytes( buffer, ref );
+	}
+	for( auto const &validator : validators ) {
+		append_bytes( buffer, validator );
+	}
+	for( auto const str : strings ) {
+		buffer.insert( buffer.end( ), str->begin( ), str->end( ) );
+	}
+
+	// Write beside the target and rename so a reader never maps a partial file
+	auto const tmp_file = snapshot_file + ".tmp";
+	{
+		std::ofstream out{tmp_file, std::ios::binary | std::ios::trunc};
+		out.write( buffer.data( ), static_cast<std::streamsize>( buffer.size( ) ) );
+		if( !out ) {
+			throw config_snapshot_error{"Error writing config snapshot; path='" + tmp_file + "'"};
+		}
+	}
+	boost::filesystem::rename( tmp_file, snapshot_file );
+}
+
+config_t read_config_snapshot( std::string const &snapshot_file ) {
+	boost::iostreams::mapped_file_source file{snapshot_file};
+	auto const data = file.data( );
+	auto const size = static_cast<uint64_t>( file.size( ) );
+	auto const header = read_header( data, file.size( ) );
+
+	if( header.file_size != size ||
+	    !is_in_bounds( header.strings_offset, header.string_count, sizeof( string_ref_t ), size ) ||
+	    !is_in_bounds( header.validators_offset, header.validator_count, sizeof( validator_record_t ), size ) ||
+	    !is_in_bounds( header.string_data_offset, header.string_data_size, 1, size ) || header.string_count < 4 ) {
+		throw config_snapshot_error{"Config snapshot is corrupt; path='" + snapshot_file + "'"};
+	}
+
+	auto const get_string = [&]( uint32_t index ) {
+		if( index >= header.string_count ) {
+			throw config_snapshot_error{"Config snapshot string index out of range"};
+		}
+		string_ref_t ref;
+		std::memcpy( &ref, data + header.strings_offset + index * sizeof( string_ref_t ), sizeof( ref ) );
+		if( static_cast<uint64_t>( ref.offset ) + ref.size > header.string_data_size ) {
+			throw config_snapshot_error{"Config snapshot string out of range"};
+		}
+		return std::string( data + header.string_data_offset + ref.offset, ref.size );
+	};
+
+	config_t result;
+	result.app_icon = get_string( 0 );
+	result.app_title = get_string( 1 );
+	result.home_url = get_string( 2 );
+	result.asset_bundle = get_string( 3 );
+	for( size_t n = 0; n < sizeof( flag_members ) / sizeof( flag_members[0] ); ++n ) {
+		result.*flag_members[n] = ( header.flags & ( 1u << n ) ) != 0;
+	}
+	result.url_cache_size = header.url_cache_size;
+	result.page_cache_size = header.page_cache_size;
+	result.page_cache_entry_size = header.page_cache_entry_size;
+	result.prefetch_pages = header.prefetch_pages;
+	result.prefetch_bandwidth = header.prefetch_bandwidth;
+	result.webview_pool_size = header.webview_pool_size;
+	result.max_live_tabs = header.max_live_tabs;
+	result.tab_memory_limit = header.tab_memory_limit;
+	result.child_memory_limit = header.child_memory_limit;
+	result.child_cpu_limit = header.child_cpu_limit;
+
+	result.url_validators.resize( header.validator_count );
+	for( uint32_t n = 0; n < header.validator_count; ++n ) {
+		validator_record_t record;
+		std::memcpy( &record, data + header.validators_offset + n * sizeof( validator_record_t ), sizeof( record ) );
+		auto &validator = result.url_validators[n];
+		validator.url = get_string( record.string_index );
+		switch( static_cast<url_validation_t::kind_t>( record.kind ) ) {
+		case url_validation_t::kind_t::exact:
+			validator.match = "exact";
+			break;
+		case url_validation_t::kind_t::prefix:
+			validator.match = "prefix";
+			break;
+		case url_validation_t::kind_t::regex:
+			validator.is_regex = true;
+			validator.match = "regex";
+			break;
+		default:
+			throw config_snapshot_error{"Config snapshot has an unknown validator kind"};
+		}
+	}
+	return result;
+}
+
+bool is_config_snapshot_current( std::string const &snapshot_file, std::string const &config_file ) {
+	boost::system::error_code ec;
+	if( !boost::filesystem::exists( snapshot_file, ec ) || !boost::filesystem::exists( config_file, ec ) ) {
+		return false;
+	}
+	std::ifstream in{snapshot_file, std::ios::binary};
+	char data[sizeof( config_snapshot_header_t )];
+	if( !in.read( data, sizeof( data ) ) ) {
+		return false;
+	}
+	try {
+		auto const header = read_header( data, sizeof( data ) );
+		// Cheap reject on size before reading the whole config
+		boost::system::error_code size_ec;
+		auto const size = boost::filesystem::file_size( config_file, size_ec );
+		if( size_ec || header.source_size != static_cast<uint64_t>( size ) ) {
+			return false;
+		}
+		uint64_t hash = 0;
+		uint64_t hashed_size = 0;
+		return hash_file( config_file, hash, hashed_size ) && hash == header.source_hash &&
+		       hashed_size == header.source_size;
+	} catch( config_snapshot_error const & ) {
+		return false;
+	}
+}
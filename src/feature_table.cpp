@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstddef>
+
+#include "feature_table.h"
+
+namespace {
+	// In config_denied_exception_kind order
+	constexpr feature_state_t const feature_table[] = {
+	    features::clipboard,    features::command_line, features::debug_window, features::edit,
+	    features::navigation,   features::printing,     features::reload,       features::search,
+	    features::select,       features::title_change, features::toolbar,      features::view_source,
+	    features::view_text,    features::zoom,
+	};
+
+	constexpr bool config_t::*const feature_members[] = {
+	    &config_t::enable_clipboard,    &config_t::enable_command_line, &config_t::enable_debug_window,
+	    &config_t::enable_edit,         &config_t::enable_navigation,   &config_t::enable_printing,
+	    &config_t::enable_reload,       &config_t::enable_search,       &config_t::enable_select,
+	    &config_t::enable_title_change, &config_t::enable_toolbar,      &config_t::enable_view_source,
+	    &config_t::enable_view_text,    &config_t::enable_zoom,
+	};
+
+	static_assert( sizeof( feature_table ) / sizeof( feature_table[0] ) ==
+	                   sizeof( feature_members ) / sizeof( feature_members[0] ),
+	               "Every feature needs a config member" );
+} // namespace
+
+feature_state_t get_feature_state( config_denied_exception_kind kind ) noexcept {
+	return feature_table[static_cast<size_t>( kind )];
+}
+
+void apply_feature_profile( config_t &config ) {
+	for( size_t n = 0; n < sizeof( feature_table ) / sizeof( feature_table[0] ); ++n ) {
+		switch( feature_table[n] ) {
+		case feature_state_t::on:
+			config.*feature_members[n] = true;
+			break;
+		case feature_state_t::off:
+			config.*feature_members[n] = false;
+			break;
+		case feature_state_t::runtime:
+			break;
+		}
+	}
+}
@@ -0,0 +1,171 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "find_engine.h"
+
+namespace {
+	bool is_word_char( char c ) noexcept {
+		auto const u = static_cast<unsigned char>( c );
+		return u >= 0x80 || u == '_' || ( u >= '0' && u <= '9' ) || ( u >= 'a' && u <= 'z' ) ||
+		       ( u >= 'A' && u <= 'Z' );
+	}
+
+	bool is_whole_word_at( boost::string_view haystack, size_t pos, size_t size ) noexcept {
+		return ( pos == 0 || !is_word_char( haystack[pos - 1] ) ) &&
+		       ( pos + size == haystack.size( ) || !is_word_char( haystack[pos + size] ) );
+	}
+
+	char to_lower_ascii( char c ) noexcept {
+		return c >= 'A' && c <= 'Z' ? static_cast<char>( c - 'A' + 'a' ) : c;
+	}
+
+	std::string to_lower_ascii( boost::string_view text ) {
+		std::string result( text.size( ), '\0' );
+		std::transform( text.begin( ), text.end( ), result.begin( ), []( char c ) { return to_lower_ascii( c ); } );
+		return result;
+	}
+} // namespace
+
+size_t find_all( boost::string_view haystack, boost::string_view needle, bool is_whole_word,
+                 std::vector<size_t> &positions, size_t max_positions ) {
+	positions.clear( );
+	auto const size = needle.size( );
+	if( size == 0 || size > haystack.size( ) ) {
+		return 0;
+	}
+	size_t count = 0;
+	// True when the match at pos counts
+	auto const record = [&]( size_t pos ) {
+		if( is_whole_word && !is_whole_word_at( haystack, pos, size ) ) {
+			return false;
+		}
+		if( positions.size( ) < max_positions ) {
+			positions.push_back( pos );
+		}
+		++count;
+		return true;
+	};
+
+	auto const data = haystack.data( );
+	if( size == 1 ) {
+		// The C library vectorises memchr
+		auto const last = data + haystack.size( );
+		auto pos = data;
+		while( true ) {
+			pos = static_cast<char const *>( std::memchr( pos, needle[0], static_cast<size_t>( last - pos ) ) );
+			if( pos == nullptr ) {
+				return count;
+			}
+			record( static_cast<size_t>( pos - data ) );
+			++pos;
+		}
+	}
+
+	std::array<size_t, 256> shift;
+	shift.fill( size );
+	for( size_t n = 0; n + 1 < size; ++n ) {
+		shift[static_cast<unsigned char>( needle[n] )] = size - 1 - n;
+	}
+	auto const last_char = needle[size - 1];
+	auto const end = haystack.size( ) - size;
+	size_t pos = 0;
+	while( pos <= end ) {
+		auto const c = data[pos + size - 1];
+		if( c == last_char && std::memcmp( data + pos, needle.data( ), size - 1 ) == 0 ) {
+			// Matches do not overlap, as with the webview's own find
+			pos += record( pos ) ? size : 1;
+		} else {
+			pos += shift[static_cast<unsigned char>( c )];
+		}
+	}
+	return count;
+}
+
+find_engine_t::find_engine_t( )
+    : m_mutex{}
+    , m_cv{}
+    , m_job{}
+    , m_text{std::make_shared<std::string const>( )}
+    , m_is_stopping{false}
+    , m_folded_source{}
+    , m_folded{}
+    , m_worker{[this]( ) { worker( ); }} {}
+
+find_engine_t::~find_engine_t( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+		m_job = boost::none;
+	}
+	m_cv.notify_all( );
+	m_worker.join( );
+}
+
+void find_engine_t::set_text( std::string text ) {
+	auto snapshot = std::make_shared<std::string const>( std::move( text ) );
+	std::lock_guard<std::mutex> lock{m_mutex};
+	m_text = std::move( snapshot );
+}
+
+void find_engine_t::search( std::string pattern, find_options_t options, callback_t on_result ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_job = job_t{std::move( pattern ), options, std::move( on_result )};
+	}
+	m_cv.notify_one( );
+}
+
+void find_engine_t::worker( ) {
+	while( true ) {
+		job_t job;
+		std::shared_ptr<std::string const> text;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || m_job; } );
+			if( m_is_stopping ) {
+				return;
+			}
+			job = std::move( *m_job );
+			m_job = boost::none;
+			text = m_text;
+		}
+		find_result_t result{0, {}};
+		if( job.options.is_match_case ) {
+			result.count =
+			    find_all( *text, job.pattern, job.options.is_whole_word, result.positions, max_find_positions );
+		} else {
+			// Folded once per snapshot, while the user keeps typing into the same page
+			if( m_folded_source != text ) {
+				m_folded = to_lower_ascii( *text );
+				m_folded_source = text;
+			}
+			result.count = find_all( m_folded, to_lower_ascii( job.pattern ), job.options.is_whole_word,
+			                         result.positions, max_find_positions );
+		}
+		job.on_result( std::move( result ) );
+	}
+}
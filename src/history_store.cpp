@@ -0,0 +1,437 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "history_store.h"
+
+namespace {
+	constexpr char const index_magic[8] = {'W', 'B', 'A', 'H', 'I', 'S', 'T', '\0'};
+	constexpr uint32_t const index_version = 1;
+	// Anything longer is treated as corruption rather than allocated
+	constexpr uint32_t const max_string_size = 1024 * 1024;
+	// Write when this many visits are queued or the interval passes
+	constexpr size_t const batch_size = 64;
+	constexpr auto const batch_interval = std::chrono::milliseconds{500};
+	// Fold the log into the index once it holds this many records and more
+	// records than the index has entries
+	constexpr size_t const min_compact_records = 4096;
+
+	struct index_header_t {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+		uint64_t last_sequence;
+	};
+
+	struct record_header_t {
+		uint32_t crc;
+		uint16_t kind;
+		uint16_t reserved;
+		uint64_t sequence;
+		int64_t time;
+		uint32_t visit_count;
+		uint32_t url_size;
+		uint32_t title_size;
+		uint32_t reserved2;
+	};
+
+	enum class read_result_t { ok, end, corrupt };
+
+	uint32_t get_crc( record_header_t header, char const *payload, size_t payload_size ) {
+		header.crc = 0;
+		boost::crc_32_type crc;
+		crc.process_bytes( &header, sizeof( header ) );
+		crc.process_bytes( payload, payload_size );
+		return crc.checksum( );
+	}
+
+	int64_t now_ms( ) {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+		           std::chrono::system_clock::now( ).time_since_epoch( ) )
+		    .count( );
+	}
+} // namespace
+
+history_entry_t history_store_t::to_entry( url_index_t::value_type const &value ) {
+	return history_entry_t{value.first, value.second.title, value.second.last_visit, value.second.visit_count};
+}
+
+namespace {
+	template<typename Record>
+	void append_record( std::string &buffer, Record const &record, uint16_t kind ) {
+		record_header_t header;
+		std::memset( &header, 0, sizeof( header ) );
+		header.kind = kind;
+		header.sequence = record.sequence;
+		header.time = record.time;
+		header.visit_count = record.visit_count;
+		header.url_size = static_cast<uint32_t>( record.url.size( ) );
+		header.title_size = static_cast<uint32_t>( record.title.size( ) );
+		auto const payload = record.url + record.title;
+		header.crc = get_crc( header, payload.data( ), payload.size( ) );
+		buffer.append( reinterpret_cast<char const *>( &header ), sizeof( header ) );
+		buffer.append( payload );
+	}
+
+	template<typename Record>
+	read_result_t read_record( std::istream &in, Record &record, uint16_t &kind ) {
+		record_header_t header;
+		if( !in.read( reinterpret_cast<char *>( &header ), sizeof( header ) ) ) {
+			return in.gcount( ) == 0 ? read_result_t::end : read_result_t::corrupt;
+		}
+		if( header.url_size > max_string_size || header.title_size > max_string_size ) {
+			return read_result_t::corrupt;
+		}
+		std::string payload( header.url_size + header.title_size, '\0' );
+		if( !in.read( &payload[0], static_cast<std::streamsize>( payload.size( ) ) ) ||
+		    get_crc( header, payload.data( ), payload.size( ) ) != header.crc ) {
+			return read_result_t::corrupt;
+		}
+		kind = header.kind;
+		record.sequence = header.sequence;
+		record.time = header.time;
+		record.visit_count = header.visit_count;
+		record.url = payload.substr( 0, header.url_size );
+		record.title = payload.substr( header.url_size );
+		return read_result_t::ok;
+	}
+} // namespace
+
+history_store_t::history_store_t( std::string const &base_path )
+    : m_log_file{base_path + ".log"}
+    , m_index_file{base_path + ".index"}
+    , m_mutex{}
+    , m_by_url{}
+    , m_by_time{}
+    , m_next_sequence{1}
+    , m_cv{}
+    , m_written_cv{}
+    , m_pending{}
+    , m_written_sequence{0}
+    , m_failed_writes{0}
+    , m_is_flush_requested{false}
+    , m_is_stopping{false}
+    , m_log{}
+    , m_log_records{0}
+    , m_writer{} {
+
+	auto const index_sequence = load_index( );
+	m_next_sequence = std::max( m_next_sequence, index_sequence + 1 );
+	replay_log( index_sequence );
+	m_written_sequence = m_next_sequence - 1;
+
+	m_log.open( m_log_file, std::ios::binary | std::ios::app );
+	if( !m_log ) {
+		throw std::runtime_error{"Error opening history log; path='" + m_log_file + "'"};
+	}
+	m_writer = std::thread{[this]( ) { writer( ); }};
+}
+
+history_store_t::~history_store_t( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+	}
+	m_cv.notify_all( );
+	m_writer.join( );
+}
+
+void history_store_t::apply( record_t const &record ) {
+	switch( record.kind ) {
+	case record_kind_t::clear:
+		m_by_time.clear( );
+		m_by_url.clear( );
+		return;
+	case record_kind_t::visit:
+	case record_kind_t::entry: {
+		auto pos = m_by_url.find( record.url );
+		if( pos == m_by_url.end( ) ) {
+			pos = m_by_url.emplace( record.url, entry_t{std::string{}, 0, 0, m_by_time.end( )} ).first;
+		} else {
+			m_by_time.erase( pos->second.by_time );
+		}
+		auto &entry = pos->second;
+		if( record.kind == record_kind_t::entry ) {
+			entry.visit_count = record.visit_count;
+			entry.title = record.title;
+		} else {
+			++entry.visit_count;
+			// Keep the last known title when a page has none yet
+			if( !record.title.empty( ) ) {
+				entry.title = record.title;
+			}
+		}
+		entry.last_visit = record.time;
+		entry.by_time = m_by_time.emplace( record.time, &pos->first );
+		return;
+	}
+	}
+}
+
+uint64_t history_store_t::load_index( ) {
+	std::ifstream in{m_index_file, std::ios::binary};
+	if( !in ) {
+		return 0;
+	}
+	index_header_t header;
+	if( !in.read( reinterpret_cast<char *>( &header ), sizeof( header ) ) ||
+	    std::memcmp( header.magic, index_magic, sizeof( index_magic ) ) != 0 || header.version != index_version ) {
+		std::cerr << "Ignoring unreadable history index; path='" << m_index_file << "'\n";
+		return 0;
+	}
+	record_t record{};
+	uint16_t kind = 0;
+	read_result_t result;
+	while( ( result = read_record( in, record, kind ) ) == read_result_t::ok ) {
+		record.kind = record_kind_t::entry;
+		apply( record );
+	}
+	if( result == read_result_t::corrupt ) {
+		// The index is written whole and renamed into place, so this is damage
+		// from outside.  Keep what was read
+		std::cerr << "History index is corrupt, some entries were lost; path='" << m_index_file << "'\n";
+	}
+	return header.last_sequence;
+}
+
+void history_store_t::replay_log( uint64_t index_sequence ) {
+	std::ifstream in{m_log_file, std::ios::binary};
+	if( !in ) {
+		return;
+	}
+	std::streamoff good_size = 0;
+	record_t record{};
+	uint16_t kind = 0;
+	read_result_t result;
+	while( ( result = read_record( in, record, kind ) ) == read_result_t::ok ) {
+		good_size = in.tellg( );
+		++m_log_records;
+		if( kind != static_cast<uint16_t>( record_kind_t::visit ) &&
+		    kind != static_cast<uint16_t>( record_kind_t::clear ) ) {
+			continue;
+		}
+		// Records up to index_sequence are already part of the index
+		if( record.sequence <= index_sequence ) {
+			continue;
+		}
+		record.kind = static_cast<record_kind_t>( kind );
+		apply( record );
+		m_next_sequence = std::max( m_next_sequence, record.sequence + 1 );
+	}
+	in.close( );
+	if( result == read_result_t::corrupt ) {
+		// A torn write from a crash.  Drop it so new records follow good ones
+		std::cerr << "Truncating damaged history log; path='" << m_log_file << "', size=" << good_size << '\n';
+		boost::filesystem::resize_file( m_log_file, static_cast<uintmax_t>( good_size ) );
+	}
+}
+
+void history_store_t::enqueue( record_t record ) {
+	bool is_full = false;
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		record.sequence = m_next_sequence++;
+		apply( record );
+		// Do not leave cleared urls sitting in the log longer than needed, the
+		// writer compacts as soon as it writes the clear
+		if( record.kind == record_kind_t::clear ) {
+			m_is_flush_requested = true;
+		}
+		m_pending.push_back( std::move( record ) );
+		is_full = m_is_flush_requested || m_pending.size( ) >= batch_size;
+	}
+	if( is_full ) {
+		m_cv.notify_one( );
+	}
+}
+
+void history_store_t::add_visit( std::string url, std::string title ) {
+	enqueue( record_t{record_kind_t::visit, 0, now_ms( ), 1, std::move( url ), std::move( title )} );
+}
+
+void history_store_t::clear( ) {
+	enqueue( record_t{record_kind_t::clear, 0, now_ms( ), 0, std::string{}, std::string{}} );
+}
+
+std::vector<history_entry_t> history_store_t::find_prefix( boost::string_view prefix, size_t limit ) const {
+	std::vector<history_entry_t> result;
+	std::lock_guard<std::mutex> lock{m_mutex};
+	for( auto pos = m_by_url.lower_bound( prefix.to_string( ) ); pos != m_by_url.end( ) && result.size( ) < limit;
+	     ++pos ) {
+		if( pos->first.compare( 0, prefix.size( ), prefix.data( ), prefix.size( ) ) != 0 ) {
+			break;
+		}
+		result.push_back( to_entry( *pos ) );
+	}
+	return result;
+}
+
+std::vector<history_entry_t> history_store_t::recent( size_t limit ) const {
+	std::vector<history_entry_t> result;
+	std::lock_guard<std::mutex> lock{m_mutex};
+	for( auto pos = m_by_time.rbegin( ); pos != m_by_time.rend( ) && result.size( ) < limit; ++pos ) {
+		result.push_back( to_entry( *m_by_url.find( *pos->second ) ) );
+	}
+	return result;
+}
+
+size_t history_store_t::size( ) const {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	return m_by_url.size( );
+}
+
+bool history_store_t::flush( ) {
+	std::unique_lock<std::mutex> lock{m_mutex};
+	auto const target = m_next_sequence - 1;
+	auto const failed_writes = m_failed_writes;
+	m_is_flush_requested = true;
+	m_cv.notify_one( );
+	m_written_cv.wait( lock, [&]( ) {
+		return m_written_sequence >= target || m_failed_writes != failed_writes || m_is_stopping;
+	} );
+	return m_written_sequence >= target;
+}
+
+void history_store_t::write_batch( std::vector<record_t> const &batch ) {
+	std::string buffer;
+	for( auto const &record : batch ) {
+		append_record( buffer, record, static_cast<uint16_t>( record.kind ) );
+	}
+	auto const good_size = m_log.tellp( );
+	m_log.write( buffer.data( ), static_cast<std::streamsize>( buffer.size( ) ) );
+	m_log.flush( );
+	if( !m_log ) {
+		// Drop a partly written batch so the retry does not follow a torn record
+		m_log.close( );
+		boost::system::error_code ec;
+		if( good_size >= 0 ) {
+			boost::filesystem::resize_file( m_log_file, static_cast<uintmax_t>( good_size ), ec );
+		}
+		m_log.clear( );
+		m_log.open( m_log_file, std::ios::binary | std::ios::app );
+		throw std::runtime_error{"Error writing history log; path='" + m_log_file + "'"};
+	}
+	m_log_records += batch.size( );
+}
+
+void history_store_t::compact( ) {
+	std::string buffer;
+	index_header_t header;
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.magic, index_magic, sizeof( index_magic ) );
+	header.version = index_version;
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		// Visits applied but still queued are included too; replay skips them
+		// by sequence number once they reach the new log
+		header.last_sequence = m_next_sequence - 1;
+		buffer.append( reinterpret_cast<char const *>( &header ), sizeof( header ) );
+		for( auto const &value : m_by_url ) {
+			auto const &entry = value.second;
+			record_t const record{record_kind_t::entry, 0,           entry.last_visit,
+			                      entry.visit_count,    value.first, entry.title};
+			append_record( buffer, record, static_cast<uint16_t>( record_kind_t::entry ) );
+		}
+	}
+
+	// Write beside the target and rename so a crash leaves the old index or the new one
+	auto const tmp_file = m_index_file + ".tmp";
+	{
+		std::ofstream out{tmp_file, std::ios::binary | std::ios::trunc};
+		out.write( buffer.data( ), static_cast<std::streamsize>( buffer.size( ) ) );
+		if( !out ) {
+			throw std::runtime_error{"Error writing history index; path='" + tmp_file + "'"};
+		}
+	}
+	boost::filesystem::rename( tmp_file, m_index_file );
+
+	m_log.close( );
+	m_log.open( m_log_file, std::ios::binary | std::ios::trunc );
+	if( !m_log ) {
+		throw std::runtime_error{"Error reopening history log; path='" + m_log_file + "'"};
+	}
+	m_log_records = 0;
+}
+
+void history_store_t::writer( ) {
+	std::unique_lock<std::mutex> lock{m_mutex};
+	while( true ) {
+		m_cv.wait_for( lock, batch_interval, [this]( ) {
+			return m_is_stopping || m_is_flush_requested || m_pending.size( ) >= batch_size;
+		} );
+		m_is_flush_requested = false;
+		if( m_pending.empty( ) ) {
+			if( m_is_stopping ) {
+				return;
+			}
+			continue;
+		}
+		std::vector<record_t> batch;
+		batch.swap( m_pending );
+		auto const index_size = m_by_url.size( );
+		lock.unlock( );
+
+		auto const has_clear = std::any_of( batch.begin( ), batch.end( ), []( record_t const &record ) {
+			return record.kind == record_kind_t::clear;
+		} );
+		bool is_written = false;
+		try {
+			write_batch( batch );
+			is_written = true;
+			if( has_clear || ( m_log_records >= min_compact_records && m_log_records > index_size ) ) {
+				compact( );
+			}
+		} catch( std::exception const &ex ) {
+			// The visits stay in memory; only their persistence is delayed, or
+			// lost if the writes keep failing until shutdown
+			std::cerr << ex.what( ) << '\n';
+		}
+
+		lock.lock( );
+		if( is_written ) {
+			m_written_sequence = batch.back( ).sequence;
+		} else {
+			++m_failed_writes;
+			if( !m_is_stopping ) {
+				// Retry with the next batch, oldest first
+				batch.insert( batch.end( ), std::make_move_iterator( m_pending.begin( ) ),
+				              std::make_move_iterator( m_pending.end( ) ) );
+				m_pending.swap( batch );
+			}
+		}
+		m_written_cv.notify_all( );
+		if( !is_written ) {
+			// Back off rather than spin on a full queue while the disk is failing
+			m_cv.wait_for( lock, batch_interval, [this]( ) { return m_is_stopping; } );
+		}
+	}
+}
@@ -0,0 +1,184 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "latency_histogram.h"
+
+constexpr size_t const latency_histogram_t::sub_bucket_bits;
+constexpr size_t const latency_histogram_t::sub_bucket_count;
+constexpr size_t const latency_histogram_t::bucket_count;
+
+namespace {
+	int64_t to_json_integral( uint64_t value ) noexcept {
+		return static_cast<int64_t>( std::min<uint64_t>( value, std::numeric_limits<int64_t>::max( ) ) );
+	}
+} // namespace
+
+latency_summary_t::latency_summary_t( )
+    : daw::json::JsonLink<latency_summary_t>{}
+    , name{}
+    , count{0}
+    , mean_us{0}
+    , p50_us{0}
+    , p90_us{0}
+    , p99_us{0}
+    , max_us{0} {
+
+	link_json( );
+}
+
+latency_summary_t::latency_summary_t( latency_summary_t const &other )
+    : daw::json::JsonLink<latency_summary_t>{}
+    , name{other.name}
+    , count{other.count}
+    , mean_us{other.mean_us}
+    , p50_us{other.p50_us}
+    , p90_us{other.p90_us}
+    , p99_us{other.p99_us}
+    , max_us{other.max_us} {
+
+	link_json( );
+}
+
+latency_summary_t::latency_summary_t( latency_summary_t &&other )
+    : daw::json::JsonLink<latency_summary_t>{}
+    , name{std::move( other.name )}
+    , count{other.count}
+    , mean_us{other.mean_us}
+    , p50_us{other.p50_us}
+    , p90_us{other.p90_us}
+    , p99_us{other.p99_us}
+    , max_us{other.max_us} {
+
+	link_json( );
+}
+
+latency_summary_t &latency_summary_t::operator=( latency_summary_t const &rhs ) {
+	name = rhs.name;
+	count = rhs.count;
+	mean_us = rhs.mean_us;
+	p50_us = rhs.p50_us;
+	p90_us = rhs.p90_us;
+	p99_us = rhs.p99_us;
+	max_us = rhs.max_us;
+	return *this;
+}
+
+latency_summary_t &latency_summary_t::operator=( latency_summary_t &&rhs ) {
+	name = std::move( rhs.name );
+	count = rhs.count;
+	mean_us = rhs.mean_us;
+	p50_us = rhs.p50_us;
+	p90_us = rhs.p90_us;
+	p99_us = rhs.p99_us;
+	max_us = rhs.max_us;
+	return *this;
+}
+
+latency_summary_t::~latency_summary_t( ) {}
+
+void latency_summary_t::link_json( ) {
+	this->link_string( "name", name );
+	this->link_integral( "count", count );
+	this->link_integral( "mean_us", mean_us );
+	this->link_integral( "p50_us", p50_us );
+	this->link_integral( "p90_us", p90_us );
+	this->link_integral( "p99_us", p99_us );
+	this->link_integral( "max_us", max_us );
+}
+
+latency_histogram_t::latency_histogram_t( ) noexcept : m_buckets{}, m_sum{0}, m_max{0} {
+	// std::atomic's default constructor leaves the value uninitialised
+	for( auto &bucket : m_buckets ) {
+		bucket.store( 0, std::memory_order_relaxed );
+	}
+}
+
+size_t latency_histogram_t::get_bucket( uint64_t value ) noexcept {
+	if( value < sub_bucket_count ) {
+		return static_cast<size_t>( value );
+	}
+	// Shift the value down until it has sub_bucket_bits + 1 significant bits, the
+	// leading one picks the power of two and the rest the linear step within it
+	size_t shift = 0;
+	while( ( value >> shift ) >= 2 * sub_bucket_count ) {
+		++shift;
+	}
+	return shift * sub_bucket_count + static_cast<size_t>( value >> shift );
+}
+
+uint64_t latency_histogram_t::get_highest_value( size_t bucket ) noexcept {
+	if( bucket < sub_bucket_count ) {
+		return bucket;
+	}
+	auto const shift = bucket / sub_bucket_count - 1;
+	auto const lowest = static_cast<uint64_t>( sub_bucket_count + bucket % sub_bucket_count ) << shift;
+	return lowest + ( ( static_cast<uint64_t>( 1 ) << shift ) - 1 );
+}
+
+void latency_histogram_t::record( std::chrono::microseconds latency ) noexcept {
+	auto const value = static_cast<uint64_t>( std::max<std::chrono::microseconds::rep>( latency.count( ), 0 ) );
+	m_buckets[get_bucket( value )].fetch_add( 1, std::memory_order_relaxed );
+	m_sum.fetch_add( value, std::memory_order_relaxed );
+	auto max = m_max.load( std::memory_order_relaxed );
+	while( value > max && !m_max.compare_exchange_weak( max, value, std::memory_order_relaxed ) ) {
+	}
+}
+
+latency_summary_t latency_histogram_t::summary( std::string name ) const {
+	// Copied first so every percentile comes from the same counts
+	std::array<uint64_t, bucket_count> counts;
+	uint64_t total = 0;
+	for( size_t n = 0; n < bucket_count; ++n ) {
+		counts[n] = m_buckets[n].load( std::memory_order_relaxed );
+		total += counts[n];
+	}
+	auto const max = m_max.load( std::memory_order_relaxed );
+
+	latency_summary_t result;
+	result.name = std::move( name );
+	result.count = to_json_integral( total );
+	if( total == 0 ) {
+		return result;
+	}
+	result.mean_us = to_json_integral( m_sum.load( std::memory_order_relaxed ) / total );
+	result.max_us = to_json_integral( max );
+	auto const get_percentile = [&]( uint64_t per_mille ) {
+		// The rank of the value at the percentile, 1 based
+		auto const rank = std::max<uint64_t>( ( total * per_mille + 999 ) / 1000, 1 );
+		uint64_t seen = 0;
+		for( size_t n = 0; n < bucket_count; ++n ) {
+			seen += counts[n];
+			if( seen >= rank ) {
+				return to_json_integral( std::min( get_highest_value( n ), max ) );
+			}
+		}
+		return result.max_us;
+	};
+	result.p50_us = get_percentile( 500 );
+	result.p90_us = get_percentile( 900 );
+	result.p99_us = get_percentile( 990 );
+	return result;
+}
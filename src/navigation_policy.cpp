@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+#include "navigation_policy.h"
+
+navigation_policy_t::navigation_policy_t( size_t worker_count )
+    : m_mutex{}, m_cv{}, m_jobs{}, m_is_stopping{false}, m_workers{} {
+
+	worker_count = std::max( worker_count, static_cast<size_t>( 1 ) );
+	m_workers.reserve( worker_count );
+	for( size_t n = 0; n < worker_count; ++n ) {
+		m_workers.emplace_back( [this]( ) { worker( ); } );
+	}
+}
+
+navigation_policy_t::~navigation_policy_t( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+		m_jobs.clear( );
+	}
+	m_cv.notify_all( );
+	for( auto &w : m_workers ) {
+		w.join( );
+	}
+}
+
+void navigation_policy_t::submit( std::shared_ptr<config_t const> config, std::string url, callback_t on_verdict ) {
+	auto decide = [config]( std::string const &target ) { return config->evaluate_url( target ); };
+	submit( decide_t{std::move( decide )}, std::move( url ), std::move( on_verdict ) );
+}
+
+void navigation_policy_t::submit( decide_t decide, std::string url, callback_t on_verdict ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_jobs.push_back( job_t{std::move( decide ), std::move( url ), std::move( on_verdict )} );
+	}
+	m_cv.notify_one( );
+}
+
+void navigation_policy_t::worker( ) {
+	while( true ) {
+		job_t job;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || !m_jobs.empty( ); } );
+			if( m_is_stopping ) {
+				return;
+			}
+			job = std::move( m_jobs.front( ) );
+			m_jobs.pop_front( );
+		}
+		bool is_allowed = false;
+		try {
+			is_allowed = job.decide( job.url );
+		} catch( std::exception const &ex ) {
+			// A validator that cannot be evaluated denies the url
+			std::cerr << "Error evaluating url policy; url='" << job.url << "', message='" << ex.what( ) << "'\n";
+		}
+		job.on_verdict( std::move( job.url ), is_allowed );
+	}
+}
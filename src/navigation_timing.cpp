@@ -0,0 +1,150 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <utility>
+
+#include "navigation_timing.h"
+
+namespace {
+	constexpr size_t const max_pending_navigations = 256;
+	// A request still pending after this long is not a load in progress
+	constexpr std::chrono::minutes const max_pending_age{2};
+
+	std::chrono::microseconds get_elapsed( navigation_timing_t::clock_t::time_point from,
+	                                       navigation_timing_t::clock_t::time_point to ) {
+		return std::chrono::duration_cast<std::chrono::microseconds>( to - from );
+	}
+} // namespace
+
+navigation_timing_snapshot_t::navigation_timing_snapshot_t( )
+    : daw::json::JsonLink<navigation_timing_snapshot_t>{}, phases{} {
+	link_json( );
+}
+
+navigation_timing_snapshot_t::navigation_timing_snapshot_t( navigation_timing_snapshot_t const &other )
+    : daw::json::JsonLink<navigation_timing_snapshot_t>{}, phases{other.phases} {
+
+	link_json( );
+}
+
+navigation_timing_snapshot_t::navigation_timing_snapshot_t( navigation_timing_snapshot_t &&other )
+    : daw::json::JsonLink<navigation_timing_snapshot_t>{}, phases{std::move( other.phases )} {
+
+	link_json( );
+}
+
+navigation_timing_snapshot_t &navigation_timing_snapshot_t::operator=( navigation_timing_snapshot_t const &rhs ) {
+	phases = rhs.phases;
+	return *this;
+}
+
+navigation_timing_snapshot_t &navigation_timing_snapshot_t::operator=( navigation_timing_snapshot_t &&rhs ) {
+	phases = std::move( rhs.phases );
+	return *this;
+}
+
+navigation_timing_snapshot_t::~navigation_timing_snapshot_t( ) {}
+
+void navigation_timing_snapshot_t::link_json( ) {
+	this->link_array( "phases", phases );
+}
+
+navigation_timing_t::navigation_timing_t( ) : m_pending{}, m_commit{}, m_render{}, m_load{}, m_error{} {}
+
+void navigation_timing_t::evict( clock_t::time_point now ) {
+	for( auto pos = m_pending.begin( ); pos != m_pending.end( ); ) {
+		if( now - pos->second.requested > max_pending_age ) {
+			pos = m_pending.erase( pos );
+		} else {
+			++pos;
+		}
+	}
+	if( m_pending.size( ) >= max_pending_navigations ) {
+		auto const is_older = []( auto const &lhs, auto const &rhs ) {
+			return lhs.second.requested < rhs.second.requested;
+		};
+		m_pending.erase( std::min_element( m_pending.begin( ), m_pending.end( ), is_older ) );
+	}
+}
+
+void navigation_timing_t::on_request( std::string const &url ) {
+	auto const now = clock_t::now( );
+	auto pos = m_pending.find( url );
+	if( pos != m_pending.end( ) ) {
+		if( now - pos->second.requested > max_pending_age ) {
+			pos->second = pending_t{now, boost::none};
+		}
+		return;
+	}
+	if( m_pending.size( ) >= max_pending_navigations ) {
+		evict( now );
+	}
+	m_pending.emplace( url, pending_t{now, boost::none} );
+}
+
+void navigation_timing_t::on_complete( std::string const &url ) {
+	auto const pos = m_pending.find( url );
+	if( pos == m_pending.end( ) || pos->second.committed ) {
+		return;
+	}
+	auto const now = clock_t::now( );
+	pos->second.committed = now;
+	m_commit.record( get_elapsed( pos->second.requested, now ) );
+}
+
+boost::optional<std::chrono::microseconds> navigation_timing_t::on_loaded( std::string const &url ) {
+	auto const pos = m_pending.find( url );
+	if( pos == m_pending.end( ) ) {
+		return boost::none;
+	}
+	auto const now = clock_t::now( );
+	if( pos->second.committed ) {
+		m_render.record( get_elapsed( *pos->second.committed, now ) );
+	}
+	auto const elapsed = get_elapsed( pos->second.requested, now );
+	m_load.record( elapsed );
+	m_pending.erase( pos );
+	return elapsed;
+}
+
+void navigation_timing_t::on_error( std::string const &url ) {
+	auto const pos = m_pending.find( url );
+	if( pos == m_pending.end( ) ) {
+		return;
+	}
+	m_error.record( get_elapsed( pos->second.requested, clock_t::now( ) ) );
+	m_pending.erase( pos );
+}
+
+navigation_timing_snapshot_t navigation_timing_t::snapshot( ) const {
+	navigation_timing_snapshot_t result;
+	result.phases.push_back( m_commit.summary( "commit" ) );
+	result.phases.push_back( m_render.summary( "render" ) );
+	result.phases.push_back( m_load.summary( "load" ) );
+	result.phases.push_back( m_error.summary( "error" ) );
+	return result;
+}
+
+latency_summary_t navigation_timing_t::load_summary( ) const {
+	return m_load.summary( "load" );
+}
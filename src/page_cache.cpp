@@ -0,0 +1,337 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "page_cache.h"
+#include "string_hash.h"
+#include "url_parts.h"
+
+namespace {
+	constexpr char const index_name[] = "index";
+	constexpr char const objects_name[] = "objects";
+	constexpr char const tmp_extension[] = ".tmp";
+	// More than the frames of one window start loading at once
+	constexpr size_t const max_expected_documents = 16;
+
+	std::string get_object_name( char const *data, size_t size ) {
+		auto const hash = fnv1a_hash( data, size );
+		std::ostringstream ss;
+		ss << std::hex << std::setfill( '0' ) << std::setw( 16 ) << hash << '-' << size;
+		return ss.str( );
+	}
+
+	bool is_same_content( boost::filesystem::path const &path, char const *data, size_t size ) {
+		boost::system::error_code ec;
+		if( boost::filesystem::file_size( path, ec ) != size || ec ) {
+			return false;
+		}
+		if( size == 0 ) {
+			return true;
+		}
+		boost::iostreams::mapped_file_source const file{path};
+		return std::memcmp( file.data( ), data, size ) == 0;
+	}
+} // namespace
+
+std::string get_page_cache_target( boost::string_view url ) {
+	boost::string_view const prefix{"cache://"};
+	if( url.size( ) > prefix.size( ) && iequal( url.substr( 0, prefix.size( ) ), prefix ) ) {
+		return "http://" + url.substr( prefix.size( ) ).to_string( );
+	}
+	return url.to_string( );
+}
+
+page_cache_t::page_cache_t( boost::filesystem::path root, uint64_t size_limit, uint64_t entry_size_limit )
+    : m_mutex{}
+    , m_root{std::move( root )}
+    , m_entries{}
+    , m_index{}
+    , m_objects{}
+    , m_size{0}
+    , m_size_limit{size_limit}
+    , m_entry_size_limit{entry_size_limit}
+    , m_is_dirty{false} {
+
+	boost::filesystem::create_directories( m_root / objects_name );
+	load_index( );
+	remove_orphans( );
+	evict( );
+}
+
+page_cache_t::~page_cache_t( ) {
+	if( m_is_dirty ) {
+		save_index( );
+	}
+}
+
+boost::filesystem::path page_cache_t::get_object_path( std::string const &object ) const {
+	// Spread the bodies over subdirectories by the first hash byte
+	return m_root / objects_name / object.substr( 0, 2 ) / object;
+}
+
+void page_cache_t::load_index( ) {
+	std::ifstream in{( m_root / index_name ).string( )};
+	std::string line;
+	while( std::getline( in, line ) ) {
+		// object \t mime type \t expires \t url, most recently used first.  An
+		// index from before expiry was stored has no expires field, its entries
+		// count as stale
+		auto const first_tab = line.find( '\t' );
+		auto const second_tab = first_tab == std::string::npos ? first_tab : line.find( '\t', first_tab + 1 );
+		if( second_tab == std::string::npos ) {
+			continue;
+		}
+		auto url_pos = second_tab + 1;
+		long long expires = 0;
+		auto const third_tab = line.find( '\t', url_pos );
+		if( third_tab != std::string::npos ) {
+			try {
+				size_t used = 0;
+				expires = std::stoll( line.substr( url_pos, third_tab - url_pos ), &used );
+				if( used == third_tab - url_pos ) {
+					url_pos = third_tab + 1;
+				} else {
+					expires = 0;
+				}
+			} catch( std::exception const & ) {
+				// Part of the url
+			}
+		}
+		entry_t entry{line.substr( url_pos ), line.substr( 0, first_tab ),
+		              line.substr( first_tab + 1, second_tab - first_tab - 1 ), static_cast<std::time_t>( expires )};
+		if( entry.object.size( ) < 2 || m_index.count( entry.url ) != 0 ) {
+			continue;
+		}
+		auto object = m_objects.find( entry.object );
+		if( object == m_objects.end( ) ) {
+			boost::system::error_code ec;
+			auto const size = boost::filesystem::file_size( get_object_path( entry.object ), ec );
+			if( ec ) {
+				continue;
+			}
+			object = m_objects.emplace( entry.object, object_t{static_cast<uint64_t>( size ), 0} ).first;
+			m_size += object->second.size;
+		}
+		++object->second.refs;
+		m_entries.push_back( std::move( entry ) );
+		auto const &url = m_entries.back( ).url;
+		m_index.emplace( boost::string_view{url.data( ), url.size( )}, std::prev( m_entries.end( ) ) );
+	}
+}
+
+void page_cache_t::save_index( ) {
+	auto const index_file = m_root / index_name;
+	auto tmp_file = index_file;
+	tmp_file += tmp_extension;
+	try {
+		{
+			std::ofstream out{tmp_file.string( ), std::ios::trunc};
+			for( auto const &entry : m_entries ) {
+				out << entry.object << '\t' << entry.mime_type << '\t' << static_cast<long long>( entry.expires ) << '\t'
+				    << entry.url << '\n';
+			}
+			if( !out ) {
+				throw std::runtime_error{"Error writing page cache index; path='" + tmp_file.string( ) + "'"};
+			}
+		}
+		boost::filesystem::rename( tmp_file, index_file );
+		m_is_dirty = false;
+	} catch( std::exception const &ex ) {
+		// The bodies are still valid, at worst recency or recent entries are lost
+		std::cerr << ex.what( ) << '\n';
+	}
+}
+
+// Bodies no url refers to are left behind by a crash between writing one and
+// saving the index
+void page_cache_t::remove_orphans( ) {
+	boost::system::error_code ec;
+	for( boost::filesystem::recursive_directory_iterator pos{m_root / objects_name, ec}, last; !ec && pos != last;
+	     pos.increment( ec ) ) {
+		if( boost::filesystem::is_regular_file( pos->status( ) ) &&
+		    m_objects.count( pos->path( ).filename( ).string( ) ) == 0 ) {
+			boost::system::error_code remove_ec;
+			boost::filesystem::remove( pos->path( ), remove_ec );
+		}
+	}
+}
+
+void page_cache_t::erase( list_t::iterator entry ) {
+	auto object = m_objects.find( entry->object );
+	if( object != m_objects.end( ) && --object->second.refs == 0 ) {
+		// Readers that already mapped the body keep their mapping
+		boost::system::error_code ec;
+		boost::filesystem::remove( get_object_path( entry->object ), ec );
+		m_size -= object->second.size;
+		m_objects.erase( object );
+	}
+	m_index.erase( boost::string_view{entry->url.data( ), entry->url.size( )} );
+	m_entries.erase( entry );
+	m_is_dirty = true;
+}
+
+void page_cache_t::evict( ) {
+	while( m_size > m_size_limit && !m_entries.empty( ) ) {
+		erase( std::prev( m_entries.end( ) ) );
+	}
+}
+
+std::string page_cache_t::store_object( char const *data, size_t size ) {
+	auto const object = get_object_name( data, size );
+	auto const path = get_object_path( object );
+	if( boost::filesystem::exists( path ) ) {
+		return is_same_content( path, data, size ) ? object : std::string{};
+	}
+	boost::filesystem::create_directories( path.parent_path( ) );
+	auto tmp_file = path;
+	tmp_file += tmp_extension;
+	{
+		std::ofstream out{tmp_file.string( ), std::ios::binary | std::ios::trunc};
+		out.write( data, static_cast<std::streamsize>( size ) );
+		if( !out ) {
+			throw std::runtime_error{"Error writing page cache body; path='" + tmp_file.string( ) + "'"};
+		}
+	}
+	boost::filesystem::rename( tmp_file, path );
+	return object;
+}
+
+bool page_cache_t::contains( boost::string_view url ) const {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	auto const pos = m_index.find( url );
+	return pos != m_index.end( ) && pos->second->expires > std::time( nullptr );
+}
+
+boost::optional<page_cache_hit_t> page_cache_t::find( boost::string_view url ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	auto const pos = m_index.find( url );
+	// A stale entry stays until it is stored again or evicted
+	if( pos == m_index.end( ) || pos->second->expires <= std::time( nullptr ) ) {
+		return boost::none;
+	}
+	auto const entry = pos->second;
+	m_entries.splice( m_entries.begin( ), m_entries, entry );
+	m_is_dirty = true;
+	page_cache_hit_t result{nullptr, entry->mime_type};
+	if( m_objects[entry->object].size == 0 ) {
+		return result;
+	}
+	try {
+		result.body = std::make_shared<boost::iostreams::mapped_file_source>( get_object_path( entry->object ) );
+	} catch( std::exception const &ex ) {
+		// Removed or damaged behind our back, fetch it again
+		std::cerr << "Dropping unreadable page cache entry; url='" << entry->url << "', message='" << ex.what( )
+		          << "'\n";
+		erase( entry );
+		return boost::none;
+	}
+	return result;
+}
+
+bool page_cache_t::insert( boost::string_view url, std::string const &mime_type, char const *data, size_t size,
+                           std::time_t expires ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	if( size > m_entry_size_limit || size > m_size_limit ) {
+		return false;
+	}
+	std::string object;
+	try {
+		object = store_object( data, size );
+	} catch( std::exception const &ex ) {
+		std::cerr << "Error storing page cache entry; url='" << url << "', message='" << ex.what( ) << "'\n";
+		return false;
+	}
+	if( object.empty( ) ) {
+		// Hash and size collide with a different body
+		return false;
+	}
+	// Count the new body before releasing the old one, they may be the same file
+	auto &stored = m_objects[object];
+	if( stored.refs == 0 ) {
+		stored.size = size;
+		m_size += size;
+	}
+	++stored.refs;
+	auto const pos = m_index.find( url );
+	if( pos != m_index.end( ) ) {
+		erase( pos->second );
+	}
+	m_entries.push_front( entry_t{url.to_string( ), object, mime_type, expires} );
+	auto const &key = m_entries.front( ).url;
+	m_index.emplace( boost::string_view{key.data( ), key.size( )}, m_entries.begin( ) );
+	evict( );
+	save_index( );
+	return true;
+}
+
+void page_cache_t::set_limits( uint64_t size_limit, uint64_t entry_size_limit ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	m_size_limit = size_limit;
+	m_entry_size_limit = entry_size_limit;
+	evict( );
+	if( m_is_dirty ) {
+		save_index( );
+	}
+}
+
+uint64_t page_cache_t::size( ) const {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	return m_size;
+}
+
+uint64_t page_cache_t::entry_size_limit( ) const {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	return m_entry_size_limit;
+}
+
+page_cache_documents_t::page_cache_documents_t( ) : m_mutex{}, m_urls{} {}
+
+void page_cache_documents_t::expect( std::string url ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	// Loads that never reached the handler, e.g. vetoed ones, age out
+	if( m_urls.size( ) >= max_expected_documents ) {
+		m_urls.pop_front( );
+	}
+	m_urls.push_back( std::move( url ) );
+}
+
+bool page_cache_documents_t::take( boost::string_view url ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	auto const pos = std::find( m_urls.rbegin( ), m_urls.rend( ), url );
+	if( pos == m_urls.rend( ) ) {
+		return false;
+	}
+	m_urls.erase( std::next( pos ).base( ) );
+	return true;
+}
@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <utility>
+
+#include "page_search.h"
+
+page_search_t::page_search_t( callback_t on_hits )
+    : m_mutex{}
+    , m_cv{}
+    , m_jobs{}
+    , m_automaton{}
+    , m_generation{0}
+    , m_is_stopping{false}
+    , m_on_hits{std::move( on_hits )}
+    , m_worker{} {
+
+	m_worker = std::thread{[this]( ) { worker( ); }};
+}
+
+page_search_t::~page_search_t( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+		m_jobs.clear( );
+	}
+	m_cv.notify_all( );
+	m_worker.join( );
+}
+
+uint64_t page_search_t::search( std::vector<std::string> const &patterns,
+                                std::vector<std::shared_ptr<page_text_t const>> pages ) {
+	// Built outside the lock; add_page reuses it for pages that load while this search is current
+	std::shared_ptr<aho_corasick_t const> automaton;
+	if( !patterns.empty( ) ) {
+		automaton = std::make_shared<aho_corasick_t const>( patterns );
+	}
+	uint64_t generation = 0;
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		generation = ++m_generation;
+		m_automaton = automaton;
+		m_jobs.clear( );
+		if( !automaton ) {
+			return generation;
+		}
+		for( auto &page : pages ) {
+			m_jobs.push_back( job_t{generation, automaton, std::move( page )} );
+		}
+	}
+	m_cv.notify_one( );
+	return generation;
+}
+
+void page_search_t::add_page( std::shared_ptr<page_text_t const> page ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		if( !m_automaton ) {
+			return;
+		}
+		m_jobs.push_back( job_t{m_generation, m_automaton, std::move( page )} );
+	}
+	m_cv.notify_one( );
+}
+
+void page_search_t::worker( ) {
+	while( true ) {
+		job_t job;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || !m_jobs.empty( ); } );
+			if( m_is_stopping ) {
+				return;
+			}
+			job = std::move( m_jobs.front( ) );
+			m_jobs.pop_front( );
+		}
+		page_hits_t hits{job.page->url, job.page->title, job.automaton->count( job.page->text ), 0};
+		for( auto const count : hits.counts ) {
+			hits.total += count;
+		}
+		m_on_hits( job.generation, std::move( hits ) );
+	}
+}
@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+#include "prefetcher.h"
+
+namespace {
+	constexpr size_t const max_model_sources = 1024;
+	constexpr size_t const max_model_targets = 16;
+	// Links taken less often than this are not worth the bandwidth
+	constexpr double const min_prefetch_probability = 0.1;
+} // namespace
+
+prefetcher_t::prefetcher_t( page_cache_t &page_cache, warm_t warm )
+    : m_mutex{}
+    , m_cv{}
+    , m_jobs{}
+    , m_fills{}
+    , m_is_stopping{false}
+    , m_model{max_model_sources, max_model_targets}
+    , m_page_cache{&page_cache}
+    , m_warm{std::move( warm )}
+    , m_allowance{0.0}
+    , m_allowance_time{clock_type::now( )}
+    , m_worker{} {
+
+	m_worker = std::thread{[this]( ) { worker( ); }};
+}
+
+prefetcher_t::~prefetcher_t( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+		m_jobs.clear( );
+		m_fills.clear( );
+	}
+	m_cv.notify_all( );
+	m_worker.join( );
+}
+
+void prefetcher_t::on_navigation( std::shared_ptr<config_t const> config, std::string const &from,
+                                  std::string const &to ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_model.record( from, to );
+		m_jobs.clear( );
+		if( config->prefetch_pages <= 0 || config->prefetch_bandwidth <= 0 ) {
+			return;
+		}
+		for( auto &prediction : m_model.predict( to, static_cast<size_t>( config->prefetch_pages ) ) ) {
+			if( prediction.probability < min_prefetch_probability ) {
+				break;
+			}
+			// Only cache: pages are served from the page cache
+			if( get_page_cache_target( prediction.url ) != prediction.url ) {
+				m_jobs.push_back( job_t{config, std::move( prediction.url )} );
+			}
+		}
+		if( m_jobs.empty( ) ) {
+			return;
+		}
+	}
+	m_cv.notify_one( );
+}
+
+void prefetcher_t::fill( std::shared_ptr<config_t const> config, std::string url ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		auto const is_queued = std::any_of( m_fills.begin( ), m_fills.end( ),
+		                                    [&url]( job_t const &job ) { return job.url == url; } );
+		if( is_queued ) {
+			return;
+		}
+		m_fills.push_back( job_t{std::move( config ), std::move( url )} );
+	}
+	m_cv.notify_one( );
+}
+
+bool prefetcher_t::has_allowance( int64_t bandwidth ) {
+	// A minute's worth of bandwidth is saved up at most
+	auto const now = clock_type::now( );
+	auto const elapsed = std::chrono::duration<double>( now - m_allowance_time ).count( );
+	auto const rate = static_cast<double>( bandwidth ) / 60.0;
+	m_allowance = std::min( m_allowance + elapsed * rate, static_cast<double>( bandwidth ) );
+	m_allowance_time = now;
+	return m_allowance > 0.0;
+}
+
+void prefetcher_t::worker( ) {
+	while( true ) {
+		job_t job;
+		bool is_fill = false;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || !m_fills.empty( ) || !m_jobs.empty( ); } );
+			if( m_is_stopping ) {
+				return;
+			}
+			auto &queue = m_fills.empty( ) ? m_jobs : m_fills;
+			is_fill = &queue == &m_fills;
+			job = std::move( queue.front( ) );
+			queue.pop_front( );
+		}
+		// Out of allowance drops a prediction, by the time there is more the user has likely moved on
+		if( !has_allowance( job.config->prefetch_bandwidth ) && !is_fill ) {
+			continue;
+		}
+		auto const target = get_page_cache_target( job.url );
+		try {
+			if( m_page_cache->contains( target ) || !job.config->is_valid_url( target ) ) {
+				continue;
+			}
+			m_allowance -= static_cast<double>( m_warm( target, m_page_cache->entry_size_limit( ) ) );
+		} catch( std::exception const &ex ) {
+			std::cerr << "Error prefetching page; url='" << target << "', message='" << ex.what( ) << "'\n";
+		}
+	}
+}
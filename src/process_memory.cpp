@@ -0,0 +1,232 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "process_memory.h"
+
+#if defined( _WIN32 )
+#include <windows.h>
+
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined( __APPLE__ )
+#include <libproc.h>
+#include <mach/mach.h>
+#elif defined( __linux__ )
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#endif
+
+boost::optional<uint64_t> get_resident_size( ) {
+#if defined( _WIN32 )
+	PROCESS_MEMORY_COUNTERS counters;
+	if( !GetProcessMemoryInfo( GetCurrentProcess( ), &counters, sizeof( counters ) ) ) {
+		return boost::none;
+	}
+	return static_cast<uint64_t>( counters.WorkingSetSize );
+#elif defined( __APPLE__ )
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if( task_info( mach_task_self( ), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>( &info ), &count ) !=
+	    KERN_SUCCESS ) {
+		return boost::none;
+	}
+	return static_cast<uint64_t>( info.resident_size );
+#elif defined( __linux__ )
+	// The second field is the resident page count
+	std::ifstream statm{"/proc/self/statm"};
+	uint64_t total_pages = 0;
+	uint64_t resident_pages = 0;
+	if( !( statm >> total_pages >> resident_pages ) ) {
+		return boost::none;
+	}
+	return resident_pages * static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+#else
+	return boost::none;
+#endif
+}
+
+namespace {
+	// Each process paired with its parent
+	std::vector<std::pair<long, long>> get_process_parents( ) {
+		std::vector<std::pair<long, long>> result;
+#if defined( _WIN32 )
+		auto const snapshot = CreateToolhelp32Snapshot( TH32CS_SNAPPROCESS, 0 );
+		if( snapshot == INVALID_HANDLE_VALUE ) {
+			return result;
+		}
+		PROCESSENTRY32 entry;
+		entry.dwSize = sizeof( entry );
+		for( auto ok = Process32First( snapshot, &entry ); ok; ok = Process32Next( snapshot, &entry ) ) {
+			result.emplace_back( static_cast<long>( entry.th32ProcessID ),
+			                     static_cast<long>( entry.th32ParentProcessID ) );
+		}
+		CloseHandle( snapshot );
+#elif defined( __linux__ )
+		boost::system::error_code ec;
+		for( boost::filesystem::directory_iterator pos{"/proc", ec}, last; !ec && pos != last; pos.increment( ec ) ) {
+			auto const name = pos->path( ).filename( ).string( );
+			if( name.empty( ) || name.find_first_not_of( "0123456789" ) != std::string::npos ) {
+				continue;
+			}
+			std::ifstream stat_file{pos->path( ).string( ) + "/stat"};
+			std::string stat{std::istreambuf_iterator<char>{stat_file}, std::istreambuf_iterator<char>{}};
+			// After the command name come the state and then the parent pid
+			auto const name_end = stat.rfind( ')' );
+			if( name_end == std::string::npos ) {
+				continue;
+			}
+			std::istringstream fields{stat.substr( name_end + 1 )};
+			std::string state;
+			long parent = 0;
+			if( fields >> state >> parent ) {
+				result.emplace_back( std::stol( name ), parent );
+			}
+		}
+#endif
+		return result;
+	}
+
+	std::vector<long> get_child_pids( long pid ) {
+		std::vector<long> result;
+#if defined( __APPLE__ )
+		std::vector<pid_t> buffer( 256 );
+		auto const size = proc_listchildpids( static_cast<pid_t>( pid ), buffer.data( ),
+		                                      static_cast<int>( buffer.size( ) * sizeof( pid_t ) ) );
+		for( int n = 0; n < size; ++n ) {
+			result.push_back( static_cast<long>( buffer[static_cast<size_t>( n )] ) );
+		}
+#else
+		(void)pid;
+#endif
+		return result;
+	}
+
+	long get_current_pid( ) {
+#if defined( _WIN32 )
+		return static_cast<long>( GetCurrentProcessId( ) );
+#else
+		return static_cast<long>( getpid( ) );
+#endif
+	}
+} // namespace
+
+boost::optional<uint64_t> get_process_tree_resident_size( ) {
+	auto result = get_resident_size( );
+	if( !result ) {
+		return boost::none;
+	}
+	auto const parents = get_process_parents( );
+	std::vector<long> pending{get_current_pid( )};
+	std::vector<long> seen = pending;
+	while( !pending.empty( ) ) {
+		auto const parent = pending.back( );
+		pending.pop_back( );
+		auto children = get_child_pids( parent );
+		for( auto const &entry : parents ) {
+			if( entry.second == parent ) {
+				children.push_back( entry.first );
+			}
+		}
+		for( auto const child : children ) {
+			// Guards against pid reuse making a cycle
+			if( std::find( seen.begin( ), seen.end( ), child ) != seen.end( ) ) {
+				continue;
+			}
+			seen.push_back( child );
+			pending.push_back( child );
+			auto const usage = get_process_usage( child );
+			if( usage ) {
+				*result += usage->resident_size;
+			}
+		}
+	}
+	return result;
+}
+
+boost::optional<process_usage_t> get_process_usage( long pid ) {
+#if defined( _WIN32 )
+	auto const process =
+	    OpenProcess( PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, static_cast<DWORD>( pid ) );
+	if( process == nullptr ) {
+		return boost::none;
+	}
+	PROCESS_MEMORY_COUNTERS counters;
+	FILETIME creation_time;
+	FILETIME exit_time;
+	FILETIME kernel_time;
+	FILETIME user_time;
+	auto const is_read = GetProcessMemoryInfo( process, &counters, sizeof( counters ) ) &&
+	                     GetProcessTimes( process, &creation_time, &exit_time, &kernel_time, &user_time );
+	CloseHandle( process );
+	if( !is_read ) {
+		return boost::none;
+	}
+	// FILETIME counts 100ns intervals
+	auto const to_seconds = []( FILETIME const &t ) {
+		return static_cast<double>( ( static_cast<uint64_t>( t.dwHighDateTime ) << 32u ) | t.dwLowDateTime ) / 1.0e7;
+	};
+	return process_usage_t{static_cast<uint64_t>( counters.WorkingSetSize ),
+	                       to_seconds( kernel_time ) + to_seconds( user_time )};
+#elif defined( __APPLE__ )
+	proc_taskinfo info;
+	if( proc_pidinfo( static_cast<int>( pid ), PROC_PIDTASKINFO, 0, &info, sizeof( info ) ) != sizeof( info ) ) {
+		return boost::none;
+	}
+	return process_usage_t{static_cast<uint64_t>( info.pti_resident_size ),
+	                       static_cast<double>( info.pti_total_user + info.pti_total_system ) / 1.0e9};
+#elif defined( __linux__ )
+	auto const dir = "/proc/" + std::to_string( pid );
+	std::ifstream statm{dir + "/statm"};
+	uint64_t total_pages = 0;
+	uint64_t resident_pages = 0;
+	if( !( statm >> total_pages >> resident_pages ) ) {
+		return boost::none;
+	}
+	std::ifstream stat_file{dir + "/stat"};
+	std::string stat{std::istreambuf_iterator<char>{stat_file}, std::istreambuf_iterator<char>{}};
+	// The command name may hold spaces and parentheses, the fields start after the last ')'
+	auto const name_end = stat.rfind( ')' );
+	if( name_end == std::string::npos ) {
+		return boost::none;
+	}
+	std::istringstream fields{stat.substr( name_end + 1 )};
+	std::vector<std::string> values{std::istream_iterator<std::string>{fields}, std::istream_iterator<std::string>{}};
+	// utime and stime are fields 14 and 15, the state (field 3) comes first here
+	if( values.size( ) < 13 ) {
+		return boost::none;
+	}
+	auto const ticks = std::stoull( values[11] ) + std::stoull( values[12] );
+	return process_usage_t{resident_pages * static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) ),
+	                       static_cast<double>( ticks ) / static_cast<double>( sysconf( _SC_CLK_TCK ) )};
+#else
+	return boost::none;
+#endif
+}
@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <cctype>
+
+#include "site_groups.h"
+#include "url_parts.h"
+
+namespace {
+	std::string get_site_name( url_validation_t const &validator ) {
+		if( validator.kind( ) == url_validation_t::kind_t::regex ) {
+			return validator.url;
+		}
+		return get_url_site( validator.url );
+	}
+} // namespace
+
+std::string get_url_site( boost::string_view url ) {
+	auto const parts = parse_url( url );
+	auto result = parts.scheme.to_string( ) + "://" + parts.host.to_string( );
+	if( !parts.port.empty( ) ) {
+		result += ':' + parts.port.to_string( );
+	}
+	std::transform( result.begin( ), result.end( ), result.begin( ),
+	                []( char c ) { return static_cast<char>( std::tolower( static_cast<unsigned char>( c ) ) ); } );
+	return result;
+}
+
+std::vector<site_group_t> make_site_groups( config_t const &config ) {
+	std::vector<site_group_t> result;
+	std::vector<std::vector<url_validation_t>> validators;
+	for( auto const &validator : config.url_validators ) {
+		auto name = get_site_name( validator );
+		auto const pos = std::find_if( result.begin( ), result.end( ),
+		                               [&name]( site_group_t const &group ) { return group.name == name; } );
+		if( pos == result.end( ) || validator.kind( ) == url_validation_t::kind_t::regex ) {
+			auto const is_regex = validator.kind( ) == url_validation_t::kind_t::regex;
+			auto start_url = is_regex ? std::string{} : validator.url;
+			result.push_back( site_group_t{std::move( name ), std::move( start_url ), nullptr, is_regex} );
+			validators.emplace_back( );
+			validators.back( ).push_back( validator );
+		} else {
+			validators[static_cast<size_t>( pos - result.begin( ) )].push_back( validator );
+		}
+	}
+	for( size_t n = 0; n < result.size( ); ++n ) {
+		auto group_config = std::make_shared<config_t>( config );
+		group_config->url_validators = std::move( validators[n] );
+		group_config->compile_url_validators( );
+		if( group_config->is_valid_url( config.home_url ) ) {
+			result[n].start_url = config.home_url;
+		}
+		result[n].config = std::move( group_config );
+	}
+	return result;
+}
+
+boost::optional<size_t> find_site_group( std::vector<site_group_t> const &groups, boost::string_view url ) {
+	auto const site = get_url_site( url );
+	for( size_t n = 0; n < groups.size( ); ++n ) {
+		if( !groups[n].is_regex && groups[n].name == site ) {
+			if( groups[n].config->is_valid_url( url ) ) {
+				return n;
+			}
+			break;
+		}
+	}
+	for( size_t n = 0; n < groups.size( ); ++n ) {
+		if( groups[n].config->is_valid_url( url ) ) {
+			return n;
+		}
+	}
+	return boost::none;
+}
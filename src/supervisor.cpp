@@ -0,0 +1,422 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <wx/stdpaths.h>
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "page_cache.h"
+#include "process_memory.h"
+#include "supervisor.h"
+
+namespace {
+	constexpr int const check_interval_ms = 2000;
+	// Consecutive checks over child_cpu_limit before a child is restarted, a
+	// busy page is allowed short bursts
+	constexpr unsigned const cpu_strike_limit = 5;
+	// A child that crashes sooner than this after starting is not restarted until this long after the crash
+	constexpr std::chrono::seconds const min_restart_delay{10};
+	// How long a child asked to end has before it is killed
+	constexpr std::chrono::seconds const kill_timeout{10};
+
+	constexpr char const topic_prefix[] = "site-group-";
+	constexpr char const loaded_item[] = "loaded";
+	constexpr char const navigate_item[] = "navigate";
+
+	class link_client_t : public wxClient {
+		std::vector<site_group_t> m_groups;
+		size_t m_group;
+		supervisor_link_t::navigate_t m_on_navigate;
+
+	  public:
+		link_client_t( std::vector<site_group_t> groups, size_t group, supervisor_link_t::navigate_t on_navigate )
+		    : wxClient{}, m_groups{std::move( groups )}, m_group{group}, m_on_navigate{std::move( on_navigate )} {}
+
+		~link_client_t( ) override = default;
+
+		link_client_t( link_client_t const & ) = delete;
+		link_client_t( link_client_t && ) = delete;
+		link_client_t &operator=( link_client_t const & ) = delete;
+		link_client_t &operator=( link_client_t && ) = delete;
+
+		wxConnectionBase *OnMakeConnection( ) override {
+			return new supervisor_link_t{std::move( m_groups ), m_group, std::move( m_on_navigate )};
+		}
+	};
+} // namespace
+
+std::string get_supervisor_service( long pid ) {
+	auto const name = "web_browser_app-" + std::to_string( pid );
+#ifdef __WINDOWS__
+	// A DDE service name
+	return name;
+#else
+	// A unix socket path
+	return ( boost::filesystem::temp_directory_path( ) / ( name + ".ipc" ) ).string( );
+#endif
+}
+
+class supervisor_t::connection_t : public wxConnection {
+	supervisor_t *m_supervisor;
+	size_t m_index;
+
+  public:
+	connection_t( supervisor_t *supervisor, size_t index )
+	    : wxConnection{}, m_supervisor{supervisor}, m_index{index} {}
+
+	~connection_t( ) override = default;
+
+	connection_t( connection_t const & ) = delete;
+	connection_t( connection_t && ) = delete;
+	connection_t &operator=( connection_t const & ) = delete;
+	connection_t &operator=( connection_t && ) = delete;
+
+	// The supervisor is going away
+	void orphan( ) noexcept {
+		m_supervisor = nullptr;
+	}
+
+	bool OnPoke( wxString const &WXUNUSED( topic ), wxString const &item, void const *data, size_t size,
+	             wxIPCFormat format ) override {
+		if( m_supervisor != nullptr ) {
+			m_supervisor->on_child_message( m_index, item, GetTextFromData( data, size, format ) );
+		}
+		return true;
+	}
+
+	bool OnDisconnect( ) override {
+		if( m_supervisor != nullptr ) {
+			m_supervisor->on_child_disconnected( m_index );
+		}
+		delete this;
+		return true;
+	}
+};
+
+class supervisor_t::process_t : public wxProcess {
+	supervisor_t *m_supervisor;
+	size_t m_index;
+
+  public:
+	process_t( supervisor_t *supervisor, size_t index ) : wxProcess{}, m_supervisor{supervisor}, m_index{index} {}
+
+	~process_t( ) override = default;
+
+	process_t( process_t const & ) = delete;
+	process_t( process_t && ) = delete;
+	process_t &operator=( process_t const & ) = delete;
+	process_t &operator=( process_t && ) = delete;
+
+	// The supervisor is going away
+	void orphan( ) noexcept {
+		m_supervisor = nullptr;
+	}
+
+	void OnTerminate( int WXUNUSED( pid ), int status ) override {
+		if( m_supervisor != nullptr ) {
+			m_supervisor->on_child_exited( m_index, status );
+		}
+		delete this;
+	}
+};
+
+supervisor_t::supervisor_t( std::shared_ptr<config_t const> config, std::string service )
+    : wxServer{}
+    , m_config{std::move( config )}
+    , m_service{std::move( service )}
+    , m_groups{make_site_groups( *m_config )}
+    , m_children{}
+    , m_check_timer{} {
+
+	for( auto const &group : m_groups ) {
+		m_children.push_back(
+		    child_t{group.start_url, nullptr, nullptr, 0, {}, {}, {}, boost::none, 0.0, 0, false, false} );
+	}
+	m_check_timer.Bind( wxEVT_TIMER, &supervisor_t::OnCheckTimer, this );
+}
+
+supervisor_t::~supervisor_t( ) {
+	m_check_timer.Stop( );
+	for( auto &child : m_children ) {
+		if( child.connection != nullptr ) {
+			child.connection->orphan( );
+		}
+		if( child.process != nullptr ) {
+			child.process->orphan( );
+			wxProcess::Kill( static_cast<int>( child.pid ), wxSIGTERM, wxKILL_CHILDREN );
+		}
+	}
+}
+
+bool supervisor_t::start( ) {
+	if( !Create( m_service ) ) {
+		std::cerr << "Error creating supervisor service; service='" << m_service << "'\n";
+		return false;
+	}
+	auto const home = find_site_group( m_groups, get_page_cache_target( m_config->home_url ) );
+	if( !home ) {
+		std::cerr << "No site group allows the home url; url='" << m_config->home_url << "'\n";
+		return false;
+	}
+	m_children[*home].is_wanted = true;
+	m_check_timer.Start( check_interval_ms );
+	return spawn( *home );
+}
+
+void supervisor_t::set_config( std::shared_ptr<config_t const> config ) {
+	m_config = std::move( config );
+}
+
+bool supervisor_t::spawn( size_t index ) {
+	auto &child = m_children[index];
+	// One argument each, the resume url comes from the page and must not be
+	// able to add arguments of its own
+	std::vector<std::string> args{wxStandardPaths::Get( ).GetExecutablePath( ).ToStdString( ),
+	                              "--site-group=" + std::to_string( index ), "--supervisor=" + m_service};
+	if( !child.resume_url.empty( ) ) {
+		// Ends the options, so a url starting with - is not read as one
+		args.emplace_back( "--" );
+		args.push_back( child.resume_url );
+	}
+	std::vector<char const *> argv;
+	for( auto const &arg : args ) {
+		argv.push_back( arg.c_str( ) );
+	}
+	argv.push_back( nullptr );
+	auto const process = new process_t{this, index};
+	auto const pid = wxExecute( argv.data( ), wxEXEC_ASYNC, process );
+	if( pid == 0 ) {
+		delete process;
+		std::cerr << "Error starting site process; group='" << m_groups[index].name << "'\n";
+		child.exited = clock_type::now( );
+		return false;
+	}
+	child.process = process;
+	child.pid = pid;
+	child.started = clock_type::now( );
+	child.checked = child.started;
+	child.kill_requested = boost::none;
+	child.cpu_seconds = 0.0;
+	child.cpu_strikes = 0;
+	// The url is on its command line
+	child.has_pending_url = false;
+	return true;
+}
+
+void supervisor_t::restart( size_t index, char const *reason ) {
+	auto &child = m_children[index];
+	std::cerr << "Restarting site process; group='" << m_groups[index].name << "', reason='" << reason << "'\n";
+	child.kill_requested = clock_type::now( );
+	wxProcess::Kill( static_cast<int>( child.pid ), wxSIGTERM, wxKILL_CHILDREN );
+}
+
+void supervisor_t::route( std::string const &url ) {
+	auto const index = find_site_group( m_groups, get_page_cache_target( url ) );
+	if( !index ) {
+		std::cerr << "No site group allows url; url='" << url << "'\n";
+		return;
+	}
+	auto &child = m_children[*index];
+	child.resume_url = url;
+	child.is_wanted = true;
+	child.has_pending_url = true;
+	if( child.connection != nullptr ) {
+		send_pending_url( *index );
+	} else if( child.process == nullptr ) {
+		spawn( *index );
+	}
+}
+
+void supervisor_t::send_pending_url( size_t index ) {
+	auto &child = m_children[index];
+	if( child.connection == nullptr || !child.has_pending_url ) {
+		return;
+	}
+	child.has_pending_url = false;
+	child.connection->Advise( navigate_item, wxString{child.resume_url} );
+}
+
+void supervisor_t::OnCheckTimer( wxTimerEvent &WXUNUSED( evt ) ) {
+	auto const now = clock_type::now( );
+	for( size_t n = 0; n < m_children.size( ); ++n ) {
+		auto &child = m_children[n];
+		if( child.process == nullptr ) {
+			if( child.is_wanted && now - child.exited >= min_restart_delay ) {
+				spawn( n );
+			}
+			continue;
+		}
+		if( child.kill_requested ) {
+			if( now - *child.kill_requested >= kill_timeout ) {
+				wxProcess::Kill( static_cast<int>( child.pid ), wxSIGKILL, wxKILL_CHILDREN );
+			}
+			continue;
+		}
+		auto const usage = get_process_usage( child.pid );
+		if( !usage ) {
+			continue;
+		}
+		auto const interval = std::chrono::duration<double>( now - child.checked ).count( );
+		if( m_config->child_cpu_limit > 0 && interval > 0.0 ) {
+			auto const cpu_percent = ( usage->cpu_seconds - child.cpu_seconds ) * 100.0 / interval;
+			auto const is_over = cpu_percent > static_cast<double>( m_config->child_cpu_limit );
+			child.cpu_strikes = is_over ? child.cpu_strikes + 1 : 0;
+		}
+		child.cpu_seconds = usage->cpu_seconds;
+		child.checked = now;
+		if( m_config->child_memory_limit > 0 &&
+		    usage->resident_size > static_cast<uint64_t>( m_config->child_memory_limit ) ) {
+			restart( n, "child_memory_limit" );
+		} else if( child.cpu_strikes >= cpu_strike_limit ) {
+			restart( n, "child_cpu_limit" );
+		}
+	}
+}
+
+wxConnectionBase *supervisor_t::OnAcceptConnection( wxString const &topic ) {
+	wxString index_str;
+	unsigned long index = 0;
+	if( !topic.StartsWith( topic_prefix, &index_str ) || !index_str.ToULong( &index ) || index >= m_children.size( ) ||
+	    m_children[index].connection != nullptr ) {
+		return nullptr;
+	}
+	auto const connection = new connection_t{this, index};
+	m_children[index].connection = connection;
+	// The child starts advising once connected
+	wxTheApp->CallAfter( [this, index]( ) { send_pending_url( index ); } );
+	return connection;
+}
+
+void supervisor_t::on_child_message( size_t index, wxString const &item, wxString const &data ) {
+	if( item == loaded_item ) {
+		m_children[index].resume_url = data.ToStdString( );
+	} else if( item == navigate_item ) {
+		route( data.ToStdString( ) );
+	}
+}
+
+void supervisor_t::on_child_disconnected( size_t index ) {
+	m_children[index].connection = nullptr;
+}
+
+void supervisor_t::on_child_exited( size_t index, int status ) {
+	auto &child = m_children[index];
+	child.process = nullptr;
+	child.exited = clock_type::now( );
+	if( child.kill_requested ) {
+		spawn( index );
+		return;
+	}
+	if( status == 0 ) {
+		// Closed by the user, the session ends with the last child
+		child.is_wanted = false;
+		for( auto const &other : m_children ) {
+			if( other.process != nullptr ) {
+				return;
+			}
+		}
+		wxTheApp->ExitMainLoop( );
+		return;
+	}
+	std::cerr << "Site process exited; group='" << m_groups[index].name << "', status=" << status << '\n';
+	// Otherwise the check timer restarts it once min_restart_delay has passed
+	if( child.exited - child.started >= min_restart_delay ) {
+		spawn( index );
+	}
+}
+
+supervisor_link_t::supervisor_link_t( std::vector<site_group_t> groups, size_t group, navigate_t on_navigate )
+    : wxConnection{}, m_groups{std::move( groups )}, m_sites{}, m_group{group}, m_on_navigate{std::move( on_navigate )} {
+
+	for( size_t n = 0; n < m_groups.size( ); ++n ) {
+		if( !m_groups[n].is_regex ) {
+			m_sites.emplace( m_groups[n].name, n );
+		}
+	}
+}
+
+supervisor_link_t::~supervisor_link_t( ) {}
+
+bool supervisor_link_t::is_own_url( boost::string_view url ) const {
+	auto const group = find_site_group( m_groups, url );
+	return !group || *group == m_group;
+}
+
+boost::optional<bool> supervisor_link_t::fast_is_own_url( boost::string_view url ) const {
+	// The same order as find_site_group, the group named for url's site first
+	auto const site = m_sites.find( get_url_site( url ) );
+	if( site != m_sites.end( ) ) {
+		auto const is_allowed = m_groups[site->second].config->fast_url_verdict( url );
+		if( is_allowed && *is_allowed ) {
+			return site->second == m_group;
+		}
+	}
+	for( size_t n = 0; n < m_groups.size( ); ++n ) {
+		auto const is_allowed = m_groups[n].config->fast_url_verdict( url );
+		if( !is_allowed ) {
+			return boost::none;
+		}
+		if( *is_allowed ) {
+			return n == m_group;
+		}
+	}
+	return true;
+}
+
+void supervisor_link_t::hand_off( std::string const &url ) {
+	Poke( navigate_item, wxString{url} );
+}
+
+void supervisor_link_t::report_loaded( std::string const &url ) {
+	Poke( loaded_item, wxString{url} );
+}
+
+bool supervisor_link_t::OnAdvise( wxString const &WXUNUSED( topic ), wxString const &item, void const *data,
+                                  size_t size, wxIPCFormat format ) {
+	if( item == navigate_item ) {
+		m_on_navigate( GetTextFromData( data, size, format ).ToStdString( ) );
+	}
+	return true;
+}
+
+bool supervisor_link_t::OnDisconnect( ) {
+	// Owned by the app, which ends with its supervisor
+	wxTheApp->ExitMainLoop( );
+	return true;
+}
+
+std::unique_ptr<supervisor_link_t> connect_to_supervisor( std::string const &service,
+                                                          std::vector<site_group_t> groups, size_t group,
+                                                          supervisor_link_t::navigate_t on_navigate ) {
+	link_client_t client{std::move( groups ), group, std::move( on_navigate )};
+	std::unique_ptr<supervisor_link_t> result{static_cast<supervisor_link_t *>(
+	    client.MakeConnection( "localhost", service, topic_prefix + std::to_string( group ) ) )};
+	if( result ) {
+		result->StartAdvise( navigate_item );
+	}
+	return result;
+}
@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "text_export.h"
+
+namespace {
+	constexpr size_t const write_chunk_size = 64 * 1024;
+	constexpr size_t const max_pending_size = 64 * 1024 * 1024;
+
+	bool write_all( std::FILE *file, char const *data, size_t size ) {
+		while( size > 0 ) {
+			auto const count = std::min( size, write_chunk_size );
+			if( std::fwrite( data, 1, count, file ) != count ) {
+				return false;
+			}
+			data += count;
+			size -= count;
+		}
+		return true;
+	}
+} // namespace
+
+text_export_t::text_export_t( std::string const &path )
+    : m_file{path == "-" ? stdout : std::fopen( path.c_str( ), "wb" )}
+    , m_is_owned{path != "-"}
+    , m_mutex{}
+    , m_cv{}
+    , m_records{}
+    , m_pending_size{0}
+    , m_is_stopping{false}
+    , m_has_failed{false}
+    , m_writer{} {
+
+	if( m_file == nullptr ) {
+		throw std::runtime_error{"Error opening text export; path='" + path + "'"};
+	}
+	m_writer = std::thread{[this]( ) { writer( ); }};
+}
+
+text_export_t::~text_export_t( ) {
+	finish( );
+}
+
+void text_export_t::add( std::string url, std::string text ) {
+	{
+		std::unique_lock<std::mutex> lock{m_mutex};
+		// A single text larger than the limit is still let through once the queue has drained
+		m_cv.wait( lock, [this]( ) { return m_pending_size < max_pending_size || m_records.empty( ); } );
+		if( m_is_stopping ) {
+			return;
+		}
+		m_pending_size += text.size( );
+		m_records.push_back( record_t{std::move( url ), std::move( text )} );
+	}
+	m_cv.notify_all( );
+}
+
+bool text_export_t::finish( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+	}
+	m_cv.notify_all( );
+	if( m_writer.joinable( ) ) {
+		m_writer.join( );
+	}
+	if( m_file != nullptr ) {
+		if( std::fflush( m_file ) != 0 ) {
+			m_has_failed = true;
+		}
+		if( m_is_owned && std::fclose( m_file ) != 0 ) {
+			m_has_failed = true;
+		}
+		m_file = nullptr;
+	}
+	return !m_has_failed;
+}
+
+void text_export_t::writer( ) {
+	while( true ) {
+		record_t record;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || !m_records.empty( ); } );
+			if( m_records.empty( ) ) {
+				// Stopping, and everything queued has been written
+				return;
+			}
+			record = std::move( m_records.front( ) );
+			m_records.pop_front( );
+		}
+		// After a failure records are still taken off the queue so add never waits on them
+		if( !m_has_failed ) {
+			auto const header = std::to_string( record.text.size( ) ) + ' ' + record.url + '\n';
+			if( !write_all( m_file, header.data( ), header.size( ) ) ||
+			    !write_all( m_file, record.text.data( ), record.text.size( ) ) || std::fputc( '\n', m_file ) == EOF ) {
+				m_has_failed = true;
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			m_pending_size -= record.text.size( );
+		}
+		m_cv.notify_all( );
+	}
+}
@@ -0,0 +1,104 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <iterator>
+
+#include "transition_model.h"
+
+namespace {
+	// Halve a source's counts past this many navigations away from it
+	constexpr uint32_t const decay_total = 1024;
+
+	template<typename Map, typename Count>
+	typename Map::iterator find_smallest( Map &map, Count count ) {
+		return std::min_element( map.begin( ), map.end( ), [&count]( auto const &lhs, auto const &rhs ) {
+			return count( lhs.second ) < count( rhs.second );
+		} );
+	}
+} // namespace
+
+transition_model_t::transition_model_t( size_t max_sources, size_t max_targets )
+    : m_sources{}
+    , m_max_sources{std::max( max_sources, size_t{1} )}
+    , m_max_targets{std::max( max_targets, size_t{1} )} {}
+
+transition_model_t::~transition_model_t( ) {}
+
+void transition_model_t::record( std::string const &from, std::string const &to ) {
+	if( from.empty( ) || to.empty( ) || from == to ) {
+		return;
+	}
+	auto source = m_sources.find( from );
+	if( source == m_sources.end( ) ) {
+		if( m_sources.size( ) >= m_max_sources ) {
+			m_sources.erase( find_smallest( m_sources, []( targets_t const &t ) { return t.total; } ) );
+		}
+		source = m_sources.emplace( from, targets_t{{}, 0} ).first;
+	}
+	auto &targets = source->second;
+	auto target = targets.counts.find( to );
+	if( target == targets.counts.end( ) ) {
+		if( targets.counts.size( ) >= m_max_targets ) {
+			auto const smallest = find_smallest( targets.counts, []( uint32_t c ) { return c; } );
+			targets.total -= smallest->second;
+			targets.counts.erase( smallest );
+		}
+		target = targets.counts.emplace( to, 0 ).first;
+	}
+	++target->second;
+	++targets.total;
+
+	if( targets.total > decay_total ) {
+		targets.total = 0;
+		for( auto pos = targets.counts.begin( ); pos != targets.counts.end( ); ) {
+			pos->second /= 2;
+			targets.total += pos->second;
+			pos = pos->second == 0 ? targets.counts.erase( pos ) : std::next( pos );
+		}
+	}
+}
+
+std::vector<transition_prediction_t> transition_model_t::predict( std::string const &from, size_t limit ) const {
+	std::vector<transition_prediction_t> result;
+	auto const source = m_sources.find( from );
+	if( source == m_sources.end( ) || source->second.total == 0 ) {
+		return result;
+	}
+	auto const total = static_cast<double>( source->second.total );
+	result.reserve( source->second.counts.size( ) );
+	for( auto const &target : source->second.counts ) {
+		result.push_back( transition_prediction_t{target.first, target.second / total} );
+	}
+	auto const count = std::min( limit, result.size( ) );
+	std::partial_sort( result.begin( ), result.begin( ) + static_cast<std::ptrdiff_t>( count ), result.end( ),
+	                   []( transition_prediction_t const &lhs, transition_prediction_t const &rhs ) {
+		                   return lhs.probability > rhs.probability;
+	                   } );
+	result.resize( count );
+	return result;
+}
+
+size_t transition_model_t::size( ) const noexcept {
+	return m_sources.size( );
+}
@@ -0,0 +1,205 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "url_completion_trie.h"
+
+namespace {
+	// Results rank ahead of subtrees of the same weight, which can hold nothing heavier
+	struct heap_less_t {
+		template<typename Item>
+		bool operator( )( Item const &lhs, Item const &rhs ) const noexcept {
+			if( lhs.weight != rhs.weight ) {
+				return lhs.weight < rhs.weight;
+			}
+			return !lhs.is_result && rhs.is_result;
+		}
+	};
+} // namespace
+
+constexpr uint32_t const url_completion_trie_t::no_node;
+
+url_completion_trie_t::url_completion_trie_t( ) : m_chars{}, m_nodes{}, m_size{0} {
+	clear( );
+}
+
+url_completion_trie_t::~url_completion_trie_t( ) {}
+
+boost::string_view url_completion_trie_t::label( node_t const &node ) const noexcept {
+	return boost::string_view{m_chars.data( ) + node.label_offset, node.label_size};
+}
+
+uint32_t url_completion_trie_t::find_child( uint32_t parent, char c ) const noexcept {
+	// Siblings are unordered; url fan out is small outside the root
+	for( auto child = m_nodes[parent].first_child; child != no_node; child = m_nodes[child].next_sibling ) {
+		if( m_chars[m_nodes[child].label_offset] == c ) {
+			return child;
+		}
+	}
+	return no_node;
+}
+
+uint32_t url_completion_trie_t::add_node( uint32_t parent, uint32_t label_offset, uint32_t label_size ) {
+	if( m_nodes.size( ) >= no_node ) {
+		throw std::length_error{"url_completion_trie_t is full"};
+	}
+	auto const node = static_cast<uint32_t>( m_nodes.size( ) );
+	m_nodes.push_back( node_t{label_offset, label_size, parent, no_node, m_nodes[parent].first_child, 0, 0, false} );
+	m_nodes[parent].first_child = node;
+	return node;
+}
+
+// Cut node's label after at characters; the tail and node's children move to
+// a new child.  Returns node, which now ends at the cut
+uint32_t url_completion_trie_t::split( uint32_t node, uint32_t at ) {
+	auto const tail = add_node( node, m_nodes[node].label_offset + at, m_nodes[node].label_size - at );
+	auto &head = m_nodes[node];
+	auto &moved = m_nodes[tail];
+	// add_node linked tail in front of node's old children, so they follow it
+	moved.first_child = moved.next_sibling;
+	moved.next_sibling = no_node;
+	for( auto child = moved.first_child; child != no_node; child = m_nodes[child].next_sibling ) {
+		m_nodes[child].parent = tail;
+	}
+	moved.weight = head.weight;
+	moved.max_weight = head.max_weight;
+	moved.is_terminal = head.is_terminal;
+	head.label_size = at;
+	head.first_child = tail;
+	head.weight = 0;
+	head.is_terminal = false;
+	return node;
+}
+
+void url_completion_trie_t::add( boost::string_view url, uint32_t weight ) {
+	if( url.empty( ) ) {
+		return;
+	}
+	uint32_t node = 0;
+	while( !url.empty( ) ) {
+		auto const child = find_child( node, url.front( ) );
+		if( child == no_node ) {
+			if( m_chars.size( ) + url.size( ) > no_node ) {
+				throw std::length_error{"url_completion_trie_t is full"};
+			}
+			auto const offset = static_cast<uint32_t>( m_chars.size( ) );
+			m_chars.append( url.data( ), url.size( ) );
+			node = add_node( node, offset, static_cast<uint32_t>( url.size( ) ) );
+			break;
+		}
+		auto const child_label = label( m_nodes[child] );
+		auto const common = static_cast<uint32_t>(
+		    std::mismatch( child_label.begin( ), child_label.end( ), url.begin( ), url.end( ) ).first -
+		    child_label.begin( ) );
+		node = common < child_label.size( ) ? split( child, common ) : child;
+		url.remove_prefix( common );
+	}
+	auto &leaf = m_nodes[node];
+	if( !leaf.is_terminal ) {
+		leaf.is_terminal = true;
+		++m_size;
+	}
+	leaf.weight += weight;
+	// Weights only grow, so raising the maxima on the path keeps them exact
+	auto const new_weight = leaf.weight;
+	for( auto n = node; n != no_node && m_nodes[n].max_weight < new_weight; n = m_nodes[n].parent ) {
+		m_nodes[n].max_weight = new_weight;
+	}
+}
+
+uint32_t url_completion_trie_t::find_prefix( boost::string_view prefix ) const noexcept {
+	uint32_t node = 0;
+	while( !prefix.empty( ) ) {
+		node = find_child( node, prefix.front( ) );
+		if( node == no_node ) {
+			return no_node;
+		}
+		auto const node_label = label( m_nodes[node] );
+		auto const count = std::min( node_label.size( ), prefix.size( ) );
+		if( node_label.compare( 0, count, prefix.data( ), count ) != 0 ) {
+			return no_node;
+		}
+		prefix.remove_prefix( count );
+	}
+	return node;
+}
+
+std::string url_completion_trie_t::get_key( uint32_t node ) const {
+	std::vector<uint32_t> path;
+	size_t size = 0;
+	for( ; node != 0; node = m_nodes[node].parent ) {
+		path.push_back( node );
+		size += m_nodes[node].label_size;
+	}
+	std::string result;
+	result.reserve( size );
+	for( auto pos = path.rbegin( ); pos != path.rend( ); ++pos ) {
+		auto const node_label = label( m_nodes[*pos] );
+		result.append( node_label.data( ), node_label.size( ) );
+	}
+	return result;
+}
+
+bool url_completion_trie_t::pop_heaviest( std::vector<heap_item_t> &heap, uint32_t &node ) const {
+	while( !heap.empty( ) ) {
+		std::pop_heap( heap.begin( ), heap.end( ), heap_less_t{} );
+		auto const item = heap.back( );
+		heap.pop_back( );
+		if( item.is_result ) {
+			node = item.node;
+			return true;
+		}
+		auto const &current = m_nodes[item.node];
+		if( current.is_terminal ) {
+			heap.push_back( heap_item_t{current.weight, item.node, true} );
+			std::push_heap( heap.begin( ), heap.end( ), heap_less_t{} );
+		}
+		for( auto child = current.first_child; child != no_node; child = m_nodes[child].next_sibling ) {
+			heap.push_back( heap_item_t{m_nodes[child].max_weight, child, false} );
+			std::push_heap( heap.begin( ), heap.end( ), heap_less_t{} );
+		}
+	}
+	return false;
+}
+
+std::vector<url_completion_t> url_completion_trie_t::complete( boost::string_view prefix, size_t limit ) const {
+	return complete( prefix, limit, limit, []( boost::string_view ) { return true; } );
+}
+
+void url_completion_trie_t::clear( ) {
+	m_chars.clear( );
+	m_nodes.clear( );
+	// The root has an empty label and is never a url
+	m_nodes.push_back( node_t{0, 0, no_node, no_node, no_node, 0, 0, false} );
+	m_size = 0;
+}
+
+bool url_completion_trie_t::empty( ) const noexcept {
+	return m_size == 0;
+}
+
+size_t url_completion_trie_t::size( ) const noexcept {
+	return m_size;
+}
@@ -0,0 +1,191 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cctype>
+#include <cstdint>
+#include <vector>
+
+#include "url_parts.h"
+
+namespace {
+	boost::string_view take_until( boost::string_view &str, boost::string_view delimiters ) noexcept {
+		auto const pos = str.find_first_of( delimiters );
+		auto result = str.substr( 0, pos );
+		str.remove_prefix( pos == boost::string_view::npos ? str.size( ) : pos );
+		return result;
+	}
+
+	constexpr bool is_slash( char c ) noexcept {
+		return c == '/' || c == '\\';
+	}
+
+	int hex_value( char c ) noexcept {
+		if( c >= '0' && c <= '9' ) {
+			return c - '0';
+		}
+		auto const lower = std::tolower( static_cast<unsigned char>( c ) );
+		if( lower >= 'a' && lower <= 'f' ) {
+			return lower - 'a' + 10;
+		}
+		return -1;
+	}
+
+	bool is_unreserved( char c ) noexcept {
+		return std::isalnum( static_cast<unsigned char>( c ) ) || c == '-' || c == '.' || c == '_' || c == '~';
+	}
+
+	void parse_authority( boost::string_view authority, url_parts_t &result ) noexcept {
+		auto const at_pos = authority.rfind( '@' );
+		if( at_pos != boost::string_view::npos ) {
+			authority.remove_prefix( at_pos + 1 );
+		}
+		if( authority.starts_with( '[' ) ) {
+			// IPv6 literal
+			auto const close_pos = authority.find( ']' );
+			if( close_pos != boost::string_view::npos ) {
+				result.host = authority.substr( 0, close_pos + 1 );
+				authority.remove_prefix( close_pos + 1 );
+				if( authority.starts_with( ':' ) ) {
+					result.port = authority.substr( 1 );
+				}
+				return;
+			}
+		}
+		auto const port_pos = authority.rfind( ':' );
+		if( port_pos != boost::string_view::npos ) {
+			result.port = authority.substr( port_pos + 1 );
+			authority = authority.substr( 0, port_pos );
+		}
+		if( authority.ends_with( '.' ) ) {
+			authority.remove_suffix( 1 );
+		}
+		result.host = authority;
+	}
+} // namespace
+
+url_parts_t parse_url( boost::string_view url ) noexcept {
+	url_parts_t result{};
+
+	auto const scheme_end = url.find_first_of( ":/\\?#" );
+	if( scheme_end != boost::string_view::npos && url[scheme_end] == ':' ) {
+		result.scheme = url.substr( 0, scheme_end );
+		url.remove_prefix( scheme_end + 1 );
+
+		// The WebView reads a backslash as a slash, so the authority has to end
+		// where it does for the WebView or a validator checks a different host
+		// than the one loaded, e.g. https://evil.com\@good.com/
+		if( url.size( ) >= 2 && is_slash( url[0] ) && is_slash( url[1] ) ) {
+			url.remove_prefix( 2 );
+			parse_authority( take_until( url, "/\\?#" ), result );
+		}
+	}
+	// Otherwise a relative reference or e.g. about:blank or memory:page1.htm,
+	// everything up to the query is path
+	auto const hash_pos = url.find( '#' );
+	if( hash_pos != boost::string_view::npos ) {
+		result.fragment = url.substr( hash_pos + 1 );
+		url = url.substr( 0, hash_pos );
+	}
+	auto const query_pos = url.find( '?' );
+	if( query_pos != boost::string_view::npos ) {
+		result.query = url.substr( query_pos + 1 );
+		url = url.substr( 0, query_pos );
+	}
+	result.path = url;
+	return result;
+}
+
+std::string normalize_path( boost::string_view path ) {
+	std::string decoded;
+	decoded.reserve( path.size( ) );
+	for( size_t n = 0; n < path.size( ); ++n ) {
+		auto const c = path[n];
+		if( is_slash( c ) ) {
+			decoded += '/';
+			continue;
+		}
+		if( c != '%' || n + 2 >= path.size( ) || hex_value( path[n + 1] ) < 0 || hex_value( path[n + 2] ) < 0 ) {
+			decoded += c;
+			continue;
+		}
+		auto const ch = static_cast<char>( hex_value( path[n + 1] ) * 16 + hex_value( path[n + 2] ) );
+		if( is_unreserved( ch ) ) {
+			decoded += ch;
+		} else {
+			// Reserved characters keep their escape, upper cased so %2f and %2F compare equal
+			decoded += '%';
+			decoded += static_cast<char>( std::toupper( static_cast<unsigned char>( path[n + 1] ) ) );
+			decoded += static_cast<char>( std::toupper( static_cast<unsigned char>( path[n + 2] ) ) );
+		}
+		n += 2;
+	}
+
+	std::vector<boost::string_view> segments;
+	boost::string_view remaining{decoded};
+	bool trailing_slash = false;
+	while( !remaining.empty( ) ) {
+		auto const segment = take_until( remaining, "/" );
+		trailing_slash = !remaining.empty( ) || segment == "." || segment == "..";
+		if( segment == ".." ) {
+			if( !segments.empty( ) ) {
+				segments.pop_back( );
+			}
+		} else if( !segment.empty( ) && segment != "." ) {
+			segments.push_back( segment );
+		}
+		if( !remaining.empty( ) ) {
+			remaining.remove_prefix( 1 );
+		}
+	}
+	std::string result;
+	result.reserve( decoded.size( ) + 1 );
+	for( auto const &segment : segments ) {
+		result += '/';
+		result.append( segment.data( ), segment.size( ) );
+	}
+	if( trailing_slash || result.empty( ) ) {
+		result += '/';
+	}
+	return result;
+}
+
+boost::string_view effective_port( url_parts_t const &parts ) noexcept {
+	if( ( parts.port == "80" && ( iequal( parts.scheme, "http" ) || iequal( parts.scheme, "ws" ) ) ) ||
+	    ( parts.port == "443" && ( iequal( parts.scheme, "https" ) || iequal( parts.scheme, "wss" ) ) ) ||
+	    ( parts.port == "21" && iequal( parts.scheme, "ftp" ) ) ) {
+		return boost::string_view{};
+	}
+	return parts.port;
+}
+
+bool iequal( boost::string_view lhs, boost::string_view rhs ) noexcept {
+	if( lhs.size( ) != rhs.size( ) ) {
+		return false;
+	}
+	for( size_t n = 0; n < lhs.size( ); ++n ) {
+		if( std::tolower( static_cast<unsigned char>( lhs[n] ) ) !=
+		    std::tolower( static_cast<unsigned char>( rhs[n] ) ) ) {
+			return false;
+		}
+	}
+	return true;
+}
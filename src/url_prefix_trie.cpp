@@ -0,0 +1,182 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+#include "string_hash.h"
+#include "url_prefix_trie.h"
+
+namespace {
+	constexpr uint32_t const no_node = std::numeric_limits<uint32_t>::max( );
+
+	template<typename Function>
+	void for_each_segment( boost::string_view path, Function func ) {
+		while( !path.empty( ) ) {
+			auto const pos = path.find( '/' );
+			auto const segment = path.substr( 0, pos );
+			if( !segment.empty( ) && !func( segment ) ) {
+				return;
+			}
+			path.remove_prefix( pos == boost::string_view::npos ? path.size( ) : pos + 1 );
+		}
+	}
+} // namespace
+
+size_t url_prefix_trie_t::edge_hash_t::operator( )( edge_key_t const &key ) const noexcept {
+	if( !ignore_case ) {
+		return static_cast<size_t>(
+		    fnv1a_hash( key.label.data( ), key.label.size( ), fnv1a_offset_basis ^ key.parent ) );
+	}
+	auto hash = fnv1a_offset_basis ^ key.parent;
+	for( auto const c : key.label ) {
+		hash = fnv1a_append( hash, static_cast<unsigned char>( std::tolower( static_cast<unsigned char>( c ) ) ) );
+	}
+	return static_cast<size_t>( hash );
+}
+
+bool url_prefix_trie_t::edge_equal_t::operator( )( edge_key_t const &lhs, edge_key_t const &rhs ) const noexcept {
+	if( lhs.parent != rhs.parent ) {
+		return false;
+	}
+	return ignore_case ? iequal( lhs.label, rhs.label ) : lhs.label == rhs.label;
+}
+
+url_prefix_trie_t::url_prefix_trie_t( )
+    : m_labels{}
+    , m_terminal( 1, 0 )
+    , m_host_edges{0, edge_hash_t{true}, edge_equal_t{true}}
+    , m_port_edges{0, edge_hash_t{false}, edge_equal_t{false}}
+    , m_path_edges{0, edge_hash_t{false}, edge_equal_t{false}}
+    , m_size{0} {}
+
+url_prefix_trie_t::~url_prefix_trie_t( ) {}
+
+uint32_t url_prefix_trie_t::add_edge( edge_map_t &edges, uint32_t parent, boost::string_view label ) {
+	auto const existing = find_edge( edges, parent, label );
+	if( existing != no_node ) {
+		return existing;
+	}
+	m_labels.emplace_back( label.data( ), label.size( ) );
+	auto const &stored = m_labels.back( );
+	auto const node = static_cast<uint32_t>( m_terminal.size( ) );
+	m_terminal.push_back( 0 );
+	edges.emplace( edge_key_t{parent, boost::string_view{stored.data( ), stored.size( )}}, node );
+	return node;
+}
+
+uint32_t url_prefix_trie_t::find_edge( edge_map_t const &edges, uint32_t parent, boost::string_view label ) const
+    noexcept {
+	auto const pos = edges.find( edge_key_t{parent, label} );
+	if( pos == edges.end( ) ) {
+		return no_node;
+	}
+	return pos->second;
+}
+
+void url_prefix_trie_t::add( boost::string_view prefix ) {
+	auto const parts = parse_url( prefix );
+	if( parts.scheme.empty( ) || parts.host.empty( ) ) {
+		throw std::invalid_argument( "Prefix url validator requires a scheme and host; url='" + prefix.to_string( ) +
+		                             "'" );
+	}
+	auto node = add_edge( m_host_edges, 0, parts.scheme );
+
+	auto host = parts.host;
+	while( !host.empty( ) ) {
+		auto const pos = host.rfind( '.' );
+		auto const label = pos == boost::string_view::npos ? host : host.substr( pos + 1 );
+		if( label == "*" && pos != boost::string_view::npos ) {
+			throw std::invalid_argument( "Prefix url validator only allows * as the leftmost host label; url='" +
+			                             prefix.to_string( ) + "'" );
+		}
+		node = add_edge( m_host_edges, node, label );
+		host = pos == boost::string_view::npos ? boost::string_view{} : host.substr( 0, pos );
+	}
+	node = add_edge( m_port_edges, node, effective_port( parts ) );
+
+	for_each_segment( normalize_path( parts.path ), [&]( boost::string_view segment ) {
+		node = add_edge( m_path_edges, node, segment );
+		return true;
+	} );
+
+	if( !m_terminal[node] ) {
+		m_terminal[node] = 1;
+		++m_size;
+	}
+}
+
+bool url_prefix_trie_t::match_path( uint32_t node, url_parts_t const &parts ) const {
+	if( m_terminal[node] ) {
+		return true;
+	}
+	// Compare the path the server resolves, not the text, or /docs/../admin
+	// would pass a /docs prefix
+	bool result = false;
+	for_each_segment( normalize_path( parts.path ), [&]( boost::string_view segment ) {
+		node = find_edge( m_path_edges, node, segment );
+		if( node == no_node ) {
+			return false;
+		}
+		result = m_terminal[node] != 0;
+		return !result;
+	} );
+	return result;
+}
+
+bool url_prefix_trie_t::match_host( uint32_t node, boost::string_view host, url_parts_t const &parts ) const {
+	if( host.empty( ) ) {
+		auto const port_node = find_edge( m_port_edges, node, effective_port( parts ) );
+		return port_node != no_node && match_path( port_node, parts );
+	}
+	auto const pos = host.rfind( '.' );
+	auto const label = pos == boost::string_view::npos ? host : host.substr( pos + 1 );
+	auto const child = find_edge( m_host_edges, node, label );
+	if( child != no_node &&
+	    match_host( child, pos == boost::string_view::npos ? boost::string_view{} : host.substr( 0, pos ), parts ) ) {
+		return true;
+	}
+	// A wildcard consumes all of the remaining labels
+	auto const star = find_edge( m_host_edges, node, "*" );
+	return star != no_node && match_host( star, boost::string_view{}, parts );
+}
+
+bool url_prefix_trie_t::is_match( boost::string_view url ) const {
+	if( m_size == 0 ) {
+		return false;
+	}
+	auto const parts = parse_url( url );
+	if( parts.scheme.empty( ) || parts.host.empty( ) ) {
+		return false;
+	}
+	auto const scheme_node = find_edge( m_host_edges, 0, parts.scheme );
+	return scheme_node != no_node && match_host( scheme_node, parts.host, parts );
+}
+
+bool url_prefix_trie_t::empty( ) const noexcept {
+	return m_size == 0;
+}
+
+size_t url_prefix_trie_t::size( ) const noexcept {
+	return m_size;
+}
@@ -0,0 +1,125 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "url_suggestions.h"
+
+namespace {
+	// is_valid_url can fall through to a regex; bound how many candidates are
+	// checked per keystroke for each requested result
+	constexpr size_t const checks_per_result = 4;
+	constexpr char const *const implied_schemes[] = {"https://", "http://"};
+} // namespace
+
+url_suggestions_t::url_suggestions_t( history_store_t const *history_store, std::shared_ptr<config_t const> config )
+    : m_mutex{}, m_history_store{history_store}, m_is_history_loaded{false}, m_visited{}, m_allowed{}, m_config{} {
+
+	set_config( std::move( config ) );
+}
+
+url_suggestions_t::~url_suggestions_t( ) {}
+
+void url_suggestions_t::load_history( ) {
+	m_is_history_loaded = true;
+	if( m_history_store == nullptr ) {
+		return;
+	}
+	for( auto const &entry : m_history_store->recent( std::numeric_limits<size_t>::max( ) ) ) {
+		m_visited.add( entry.url, entry.visit_count );
+	}
+}
+
+void url_suggestions_t::add_visit( boost::string_view url ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	// Until loaded the store already has it
+	if( m_is_history_loaded ) {
+		m_visited.add( url, 1 );
+	}
+}
+
+void url_suggestions_t::clear( ) {
+	std::lock_guard<std::mutex> lock{m_mutex};
+	m_visited.clear( );
+	// The store is empty too, there is nothing left to load
+	m_is_history_loaded = true;
+}
+
+void url_suggestions_t::set_config( std::shared_ptr<config_t const> config ) {
+	url_completion_trie_t allowed;
+	for( auto const &validator : config->url_validators ) {
+		// Wildcard hosts are patterns, not something to type
+		if( validator.kind( ) != url_validation_t::kind_t::regex && validator.url.find( '*' ) == std::string::npos ) {
+			allowed.add( validator.url, 1 );
+		}
+	}
+	std::lock_guard<std::mutex> lock{m_mutex};
+	m_allowed = std::move( allowed );
+	m_config = std::move( config );
+}
+
+std::vector<std::string> url_suggestions_t::complete( boost::string_view typed, size_t limit ) {
+	std::vector<std::string> result;
+	if( typed.empty( ) || limit == 0 ) {
+		return result;
+	}
+	std::vector<std::string> prefixes{typed.to_string( )};
+	if( typed.find( "://" ) == boost::string_view::npos ) {
+		for( auto const scheme : implied_schemes ) {
+			prefixes.push_back( scheme + typed.to_string( ) );
+		}
+	}
+
+	std::lock_guard<std::mutex> lock{m_mutex};
+	if( !m_is_history_loaded ) {
+		load_history( );
+	}
+	auto const &config = *m_config;
+	auto const is_allowed = [&config]( boost::string_view url ) {
+		auto const verdict = config.fast_url_verdict( url );
+		return verdict ? *verdict : config.is_valid_url( url );
+	};
+
+	std::vector<url_completion_t> candidates;
+	for( auto const &prefix : prefixes ) {
+		for( auto const trie : {&m_visited, &m_allowed} ) {
+			auto matches = trie->complete( prefix, limit, limit * checks_per_result, is_allowed );
+			std::move( matches.begin( ), matches.end( ), std::back_inserter( candidates ) );
+		}
+	}
+	// Visited urls outrank config urls of equal weight by coming first
+	std::stable_sort( candidates.begin( ), candidates.end( ),
+	                  []( url_completion_t const &lhs, url_completion_t const &rhs ) { return lhs.weight > rhs.weight; } );
+	for( auto &candidate : candidates ) {
+		if( result.size( ) == limit ) {
+			break;
+		}
+		if( std::find( result.begin( ), result.end( ), candidate.url ) == result.end( ) ) {
+			result.push_back( std::move( candidate.url ) );
+		}
+	}
+	return result;
+}
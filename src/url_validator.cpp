@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "config.h"
+#include "url_validator.h"
+
+namespace {
+	// Longer urls, e.g. data: urls, are evaluated every time instead of
+	// filling the verdict cache
+	constexpr size_t const max_verdict_key_size = 2048;
+
+	// Validators see the whole url, fragment included, so a regex can give a
+	// url with a fragment a different verdict than the same url without it.
+	// Only urls without one are cached
+	bool is_cacheable( boost::string_view url ) noexcept {
+		return url.size( ) <= max_verdict_key_size && url.find( '#' ) == boost::string_view::npos;
+	}
+
+	// The WebView reads a backslash before the query as a slash, so the url it
+	// loads is not the text that exact entries and regexes would be checked
+	// against.  Such urls are never allowed
+	bool has_path_backslash( boost::string_view url ) noexcept {
+		return url.substr( 0, url.find_first_of( "?#" ) ).find( '\\' ) != boost::string_view::npos;
+	}
+} // namespace
+
+url_validator_engine_t::url_validator_engine_t( std::vector<url_validation_t> const &validators,
+                                                size_t verdict_cache_size )
+    : m_exact_urls{}
+    , m_exact{}
+    , m_prefixes{}
+    , m_regexes{}
+    , m_allow_all{validators.empty( )}
+    , m_verdicts{verdict_cache_size} {
+
+	m_exact_urls.reserve( validators.size( ) );
+	for( auto const &validator : validators ) {
+		switch( validator.kind( ) ) {
+		case url_validation_t::kind_t::regex:
+			// Each pattern is compiled on its own so a malformed one, e.g. a)|(.*,
+			// is rejected instead of changing what the others match
+			try {
+				m_regexes.emplace_back( validator.url, std::regex::ECMAScript | std::regex::optimize );
+			} catch( std::regex_error const &ex ) {
+				throw std::invalid_argument( "Invalid regex url validator; url='" + validator.url + "': " +
+				                             ex.what( ) );
+			}
+			break;
+		case url_validation_t::kind_t::prefix:
+			m_prefixes.add( validator.url );
+			break;
+		case url_validation_t::kind_t::exact:
+			m_exact_urls.push_back( validator.url );
+			break;
+		}
+	}
+	// Only take views once m_exact_urls is fully built and will not reallocate
+	m_exact.reserve( m_exact_urls.size( ) );
+	for( auto const &url : m_exact_urls ) {
+		m_exact.insert( boost::string_view{url.data( ), url.size( )} );
+	}
+}
+
+url_validator_engine_t::~url_validator_engine_t( ) {}
+
+boost::optional<bool> url_validator_engine_t::fast_match( boost::string_view url ) const {
+	if( m_allow_all ) {
+		return true;
+	}
+	if( has_path_backslash( url ) ) {
+		return false;
+	}
+	if( m_exact.count( url ) > 0 || m_prefixes.is_match( url ) ) {
+		return true;
+	}
+	if( m_regexes.empty( ) ) {
+		return false;
+	}
+	if( !is_cacheable( url ) ) {
+		return boost::none;
+	}
+	return m_verdicts.find( url );
+}
+
+bool url_validator_engine_t::slow_match( boost::string_view url ) const {
+	if( m_allow_all ) {
+		return true;
+	}
+	if( has_path_backslash( url ) ) {
+		return false;
+	}
+	if( m_exact.count( url ) > 0 || m_prefixes.is_match( url ) ) {
+		return true;
+	}
+	if( m_regexes.empty( ) ) {
+		return false;
+	}
+	auto const result = std::any_of( m_regexes.begin( ), m_regexes.end( ), [url]( std::regex const &regex ) {
+		return std::regex_match( url.begin( ), url.end( ), regex );
+	} );
+	if( is_cacheable( url ) ) {
+		m_verdicts.insert( url, result );
+	}
+	return result;
+}
+
+bool url_validator_engine_t::is_match( boost::string_view url ) const {
+	auto const result = fast_match( url );
+	if( result ) {
+		return *result;
+	}
+	return slow_match( url );
+}
+
+lru_cache_stats_t url_validator_engine_t::cache_stats( ) const {
+	return m_verdicts.stats( );
+}
@@ -20,15 +20,43 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <boost/filesystem.hpp>
 #include <boost/filesystem/path.hpp>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <wx/artprov.h>
 #include <wx/cmdline.h>
 #include <wx/filesys.h>
+#include <wx/fs_arc.h>
+#include <wx/mstream.h>
 #include <wx/notifmsg.h>
+#include <wx/protocol/http.h>
 #include <wx/stdpaths.h>
+#include <wx/textcompleter.h>
+#include <wx/tokenzr.h>
+#include <wx/uri.h>
+#include <wx/url.h>
 #include <wx/webviewfshandler.h>
 
 #include "config.h"
+#include "config_snapshot.h"
+#include "feature_table.h"
+#include "process_memory.h"
+#include "site_groups.h"
+#include "url_suggestions.h"
+#include "zip_archive.h"
 #include "web_browser_app.h"
 
 #if defined( __WXMSW__ ) || defined( __WXOSX__ )
@@ -38,12 +66,78 @@
 
 #include "../images/wxlogo.xpm"
 
-void WebApp::OnInitCmdLine( wxCmdLineParser &parser ) {
-	if( !m_app_config.enable_command_line && parser.GetParamCount( ) > 0 ) {
-		throw config_denied_exception{config_denied_exception_kind::enable_command_line};
+namespace {
+	constexpr int const state_timer_interval_ms = 1000;
+	// Quiet time after the last keystroke in the find box before it is searched
+	constexpr int const find_debounce_ms = 150;
+	// Bytes of page text Find in Pages covers, the most recently loaded pages
+	constexpr size_t const page_text_cache_bytes = 16 * 1024 * 1024;
+	// Terms past this many bytes in all are dropped, each byte of a term can cost a 1 KiB automaton state
+	constexpr size_t const max_page_search_bytes = 4096;
+	// An automation navigate fails if its page has not loaded by then.  Checked on the state timer
+	constexpr std::chrono::seconds const automation_navigation_timeout{30};
+
+	// Milestones from creating the app object to the first loaded page.  Only
+	// touched on the GUI thread
+	class startup_trace_t {
+		using clock_type = std::chrono::steady_clock;
+
+		clock_type::time_point m_start;
+		std::vector<std::pair<char const *, clock_type::time_point>> m_marks;
+		bool m_is_reported;
+
+	  public:
+		startup_trace_t( ) : m_start{clock_type::now( )}, m_marks{}, m_is_reported{false} {}
+
+		void mark( char const *name ) {
+			if( !m_is_reported ) {
+				m_marks.emplace_back( name, clock_type::now( ) );
+			}
+		}
+
+		// The trace as "name=Nms, ..." the first time it is called, empty after that
+		std::string report( ) {
+			if( m_is_reported ) {
+				return std::string{};
+			}
+			m_is_reported = true;
+			std::string result;
+			char buffer[64];
+			for( auto const &m : m_marks ) {
+				std::chrono::duration<double, std::milli> const elapsed = m.second - m_start;
+				std::snprintf( buffer, sizeof( buffer ), "%s%s=%.1fms", result.empty( ) ? "" : ", ", m.first,
+				               elapsed.count( ) );
+				result += buffer;
+			}
+			return result;
+		}
+	}; // startup_trace_t
+
+	startup_trace_t &get_startup_trace( ) {
+		static startup_trace_t trace;
+		return trace;
 	}
+} // namespace
+
+void WebApp::OnInitCmdLine( wxCmdLineParser &parser ) {
 	wxApp::OnInitCmdLine( parser );
-	parser.AddParam( "URL to open", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL );
+	parser.AddSwitch( "", "compile-config", "Write a binary snapshot of the config file and exit" );
+	parser.AddSwitch( "", "benchmark-config", "Time loading the config from json and from a snapshot, then exit" );
+	parser.AddOption( "", "benchmark-archive", "Time reading every member of a zip through the wxfs: and zip: handlers",
+	                  wxCMD_LINE_VAL_STRING );
+	parser.AddOption( "", "pack-bundle", "Pack a directory into <directory>.bundle for the asset_bundle setting",
+	                  wxCMD_LINE_VAL_STRING );
+	parser.AddSwitch( "", "supervise", "Browse in one process per site group, restarting any over its limits" );
+	parser.AddOption( "", "site-group", "Internal, the site group of a process started by --supervise",
+	                  wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_HIDDEN );
+	parser.AddOption( "", "supervisor", "Internal, the service of the supervisor that started this process",
+	                  wxCMD_LINE_VAL_STRING, wxCMD_LINE_HIDDEN );
+	parser.AddOption( "", "automation", "Run without a window, driven by json requests on this unix socket",
+	                  wxCMD_LINE_VAL_STRING );
+	parser.AddSwitch( "", "dump-text", "Load each URL given in turn, write its page text out and exit" );
+	parser.AddOption( "", "dump-output", "Where --dump-text writes, standard output by default",
+	                  wxCMD_LINE_VAL_STRING );
+	parser.AddParam( "URL to open", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE );
 }
 
 bool WebApp::OnCmdLineParsed( wxCmdLineParser &parser ) {
@@ -54,6 +148,52 @@ bool WebApp::OnCmdLineParsed( wxCmdLineParser &parser ) {
 	if( parser.GetParamCount( ) ) {
 		m_url = parser.GetParam( 0 );
 	}
+	if( parser.Found( "compile-config" ) ) {
+		m_run_mode = run_mode_t::compile_config;
+	} else if( parser.Found( "benchmark-config" ) ) {
+		m_run_mode = run_mode_t::benchmark_config;
+	}
+	wxString benchmark_file;
+	if( parser.Found( "benchmark-archive", &benchmark_file ) ) {
+		m_run_mode = run_mode_t::benchmark_archive;
+		m_mode_path = benchmark_file.ToStdString( );
+	}
+	wxString bundle_dir;
+	if( parser.Found( "pack-bundle", &bundle_dir ) ) {
+		m_run_mode = run_mode_t::pack_bundle;
+		m_mode_path = bundle_dir.ToStdString( );
+	}
+	if( parser.Found( "supervise" ) ) {
+		m_run_mode = run_mode_t::supervise;
+	}
+	long site_group = 0;
+	wxString supervisor_service;
+	if( parser.Found( "site-group", &site_group ) && parser.Found( "supervisor", &supervisor_service ) &&
+	    site_group >= 0 ) {
+		m_site_group = static_cast<size_t>( site_group );
+		m_supervisor_service = supervisor_service.ToStdString( );
+	}
+	wxString automation_path;
+	if( parser.Found( "automation", &automation_path ) ) {
+		m_automation_path = automation_path.ToStdString( );
+	}
+	if( parser.Found( "dump-text" ) ) {
+		m_run_mode = run_mode_t::dump_text;
+		for( size_t n = 0; n < parser.GetParamCount( ); ++n ) {
+			m_dump_urls.push_back( parser.GetParam( n ).ToStdString( ) );
+		}
+		m_url.clear( );
+		wxString dump_output;
+		m_dump_output = parser.Found( "dump-output", &dump_output ) ? dump_output.ToStdString( ) : "-";
+	}
+	// Checked against enable_command_line once the config is loaded.  A supervisor starts
+	// its site processes with --site-group, --supervisor and the url to resume, so those
+	// are its own rather than the user's
+	for( auto const name : {"compile-config", "benchmark-config", "benchmark-archive", "pack-bundle", "supervise",
+	                        "automation", "dump-text", "dump-output"} ) {
+		m_has_user_arguments = m_has_user_arguments || parser.Found( name );
+	}
+	m_has_user_arguments = m_has_user_arguments || ( parser.GetParamCount( ) > 0 && !m_site_group );
 
 	return true;
 }
@@ -74,7 +214,16 @@ void WebFrame::OnScrollPageDown( wxCommandEvent & ) {
 	m_browser->PageDown( );
 }
 
-SourceViewDialog::~SourceViewDialog( ) {}
+SourceViewDialog::~SourceViewDialog( ) {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_is_stopping = true;
+	}
+	m_cv.notify_all( );
+	if( m_loader.joinable( ) ) {
+		m_loader.join( );
+	}
+}
 
 wxIMPLEMENT_APP_CONSOLE( WebApp );
 
@@ -91,8 +240,676 @@ namespace {
 		auto p_result = get_exec_path( );
 		return p_result.replace_extension( ".config" ).string( );
 	}
+
+	// Site processes of a supervisor each keep files of their own, <name>.site<n>.history rather than <name>.history
+	std::string get_data_extension( boost::optional<size_t> site_group, std::string const &extension ) {
+		return site_group ? ".site" + std::to_string( *site_group ) + extension : extension;
+	}
+
+	// The history files sit beside the config as <name>.history.log/.index
+	std::string get_history_base( std::string const &conf_file, boost::optional<size_t> site_group ) {
+		auto const extension = get_data_extension( site_group, ".history" );
+		return boost::filesystem::path{conf_file}.replace_extension( extension ).string( );
+	}
+
+	boost::filesystem::path get_page_cache_dir( std::string const &conf_file, boost::optional<size_t> site_group ) {
+		return boost::filesystem::path{conf_file}.replace_extension( get_data_extension( site_group, ".cache" ) );
+	}
+
+	// Delay between the last change to the config file and reloading it
+	constexpr int const config_reload_delay_ms = 250;
+
+	// Prefer the binary snapshot when it was built from the current json.  Only
+	// startup may create a default config; on reload a missing file is an
+	// error, since the defaults have no url_validators and allow every url
+	config_t load_config( std::string const &conf_file, bool create_default ) {
+		if( !boost::filesystem::exists( conf_file ) ) {
+			if( !create_default ) {
+				throw std::runtime_error{"Config file is missing"};
+			}
+			config_t result;
+			result.to_file( conf_file, false );
+			return result;
+		}
+		auto const snapshot_file = get_config_snapshot_file( conf_file );
+		if( is_config_snapshot_current( snapshot_file, conf_file ) ) {
+			try {
+				return read_config_snapshot( snapshot_file );
+			} catch( std::exception const &ex ) {
+				std::cerr << "Ignoring config snapshot; path='" << snapshot_file << "', message='" << ex.what( )
+				          << "'\n";
+			}
+		}
+		return daw::json::from_file<config_t>( conf_file );
+	}
+
+	// Defaults and compiled state shared by startup and reload
+	void finalize_config( config_t &config ) {
+		apply_feature_profile( config );
+		if( config.home_url.empty( ) ) {
+			config.home_url = "http://localhost";
+		}
+		config.compile_url_validators( );
+	}
+
+	template<typename Function>
+	double average_ms( size_t runs, Function func ) {
+		auto const start = std::chrono::steady_clock::now( );
+		for( size_t n = 0; n < runs; ++n ) {
+			func( );
+		}
+		std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now( ) - start;
+		return elapsed.count( ) / static_cast<double>( runs );
+	}
+
+	int benchmark_config( std::string const &conf_file ) {
+		constexpr size_t const runs = 100;
+		auto const snapshot_file = get_config_snapshot_file( conf_file );
+		write_config_snapshot( daw::json::from_file<config_t>( conf_file ), conf_file, snapshot_file );
+
+		auto const json_ms = average_ms( runs, [&]( ) {
+			auto config = daw::json::from_file<config_t>( conf_file );
+			config.compile_url_validators( );
+		} );
+		auto const snapshot_ms = average_ms( runs, [&]( ) {
+			auto config = read_config_snapshot( snapshot_file );
+			config.compile_url_validators( );
+		} );
+		std::cout << "Config load, average of " << runs << " runs including validator compilation\n";
+		std::cout << "  json:     " << json_ms << "ms\n";
+		std::cout << "  snapshot: " << snapshot_ms << "ms\n";
+		return EXIT_SUCCESS;
+	}
+
+	constexpr size_t const max_url_suggestions = 10;
+
+	// Called by the url bar on every edit.  Owned by the wxTextCtrl
+	class url_completer_t : public wxTextCompleter {
+		url_suggestions_t *m_suggestions;
+		std::vector<std::string> m_matches;
+		size_t m_next;
+
+	  public:
+		explicit url_completer_t( url_suggestions_t *suggestions )
+		    : wxTextCompleter{}, m_suggestions{suggestions}, m_matches{}, m_next{0} {}
+		~url_completer_t( ) override = default;
+
+		url_completer_t( url_completer_t const & ) = delete;
+		url_completer_t( url_completer_t && ) = delete;
+		url_completer_t &operator=( url_completer_t const & ) = delete;
+		url_completer_t &operator=( url_completer_t && ) = delete;
+
+		bool Start( wxString const &prefix ) override {
+			m_matches = m_suggestions->complete( prefix.ToStdString( ), max_url_suggestions );
+			m_next = 0;
+			return !m_matches.empty( );
+		}
+
+		wxString GetNext( ) override {
+			if( m_next == m_matches.size( ) ) {
+				return wxString{};
+			}
+			return wxString{m_matches[m_next++]};
+		}
+	};
+
+	constexpr int const page_fetch_timeout_s = 10;
+	// How long a page stays in the page cache without freshness headers, and the
+	// most a header may grant, since entries are never revalidated
+	constexpr std::time_t const page_default_max_age_s = 60 * 60;
+	constexpr std::time_t const page_max_age_s = 24 * 60 * 60;
+	// A cached page's <head> is looked for in this much of its start
+	constexpr size_t const max_base_search_size = 64 * 1024;
+
+	// Serves memory that owner keeps alive without copying it
+	template<typename Owner>
+	class shared_memory_input_stream_t : public wxMemoryInputStream {
+		std::shared_ptr<Owner const> m_owner;
+
+	  public:
+		explicit shared_memory_input_stream_t( std::shared_ptr<Owner const> owner )
+		    : wxMemoryInputStream{owner->data( ), owner->size( )}, m_owner{std::move( owner )} {}
+		~shared_memory_input_stream_t( ) override = default;
+
+		shared_memory_input_stream_t( shared_memory_input_stream_t const & ) = delete;
+		shared_memory_input_stream_t( shared_memory_input_stream_t && ) = delete;
+		shared_memory_input_stream_t &operator=( shared_memory_input_stream_t const & ) = delete;
+		shared_memory_input_stream_t &operator=( shared_memory_input_stream_t && ) = delete;
+	};
+
+	template<typename Owner>
+	wxInputStream *make_shared_memory_stream( std::shared_ptr<Owner const> owner ) {
+		if( !owner ) {
+			return new wxMemoryInputStream{nullptr, 0};
+		}
+		return new shared_memory_input_stream_t<Owner>{std::move( owner )};
+	}
+
+	struct fetched_page_t {
+		std::string mime_type;
+		std::shared_ptr<std::string const> body;
+		// When the page stops being fresh, empty when it must not be stored
+		boost::optional<std::time_t> expires;
+	};
+
+	// From Cache-Control, or Expires when it has no max-age.  no-store, private
+	// and no-cache responses are not stored at all
+	boost::optional<std::time_t> get_page_expiry( wxHTTP &http, std::time_t now ) {
+		boost::optional<long long> max_age;
+		wxStringTokenizer directives{http.GetHeader( "Cache-Control" ).Lower( ), ","};
+		while( directives.HasMoreTokens( ) ) {
+			auto const directive = directives.GetNextToken( ).Trim( ).Trim( false );
+			if( directive == "no-store" || directive == "private" || directive == "no-cache" ) {
+				return boost::none;
+			}
+			wxString value;
+			long long seconds = 0;
+			if( directive.StartsWith( "max-age=", &value ) && value.ToLongLong( &seconds ) ) {
+				max_age = seconds;
+			}
+		}
+		auto const expires_header = http.GetHeader( "Expires" );
+		if( !max_age && !expires_header.empty( ) ) {
+			wxDateTime expires;
+			wxString::const_iterator end;
+			// An invalid date means already expired
+			max_age = expires.ParseRfc822Date( expires_header, &end )
+			              ? static_cast<long long>( expires.GetTicks( ) - now )
+			              : 0;
+		}
+		auto const age = max_age ? *max_age : static_cast<long long>( page_default_max_age_s );
+		if( age <= 0 ) {
+			return boost::none;
+		}
+		return now + static_cast<std::time_t>( std::min( age, static_cast<long long>( page_max_age_s ) ) );
+	}
+
+	// wxURL only speaks plain http, which is all that cache: urls map to.  Bodies
+	// over max_size are abandoned part way.  bytes_read receives the bytes
+	// downloaded whether or not the fetch succeeded
+	boost::optional<fetched_page_t> fetch_page( std::string const &url, uint64_t max_size, uint64_t &bytes_read ) {
+		bytes_read = 0;
+		wxURL request{url};
+		if( request.GetError( ) != wxURL_NOERR ) {
+			return boost::none;
+		}
+		auto &http = static_cast<wxHTTP &>( request.GetProtocol( ) );
+		http.SetTimeout( page_fetch_timeout_s );
+		std::unique_ptr<wxInputStream> in{request.GetInputStream( )};
+		if( !in || http.GetResponse( ) != 200 ) {
+			return boost::none;
+		}
+		unsigned long long content_length = 0;
+		if( http.GetHeader( "Content-Length" ).ToULongLong( &content_length ) && content_length > max_size ) {
+			return boost::none;
+		}
+		auto body = std::make_shared<std::string>( );
+		char buffer[64 * 1024];
+		while( in->Read( buffer, sizeof( buffer ) ).LastRead( ) > 0 ) {
+			bytes_read += in->LastRead( );
+			if( bytes_read > max_size ) {
+				return boost::none;
+			}
+			body->append( buffer, in->LastRead( ) );
+		}
+		if( in->GetLastError( ) != wxSTREAM_EOF && in->GetLastError( ) != wxSTREAM_NO_ERROR ) {
+			return boost::none;
+		}
+		auto mime_type = http.GetContentType( ).ToStdString( );
+		if( mime_type.empty( ) ) {
+			mime_type = "application/octet-stream";
+		}
+		return fetched_page_t{std::move( mime_type ), std::move( body ), get_page_expiry( http, std::time( nullptr ) )};
+	}
+
+	// Stands in for a cache: page that is missing from the cache, the webview
+	// replaces it by loading url over the network itself
+	std::string make_redirect_page( std::string const &url ) {
+		std::string result = "<!DOCTYPE html><html><head><script>location.replace(\"";
+		char escaped[8];
+		for( auto const c : url ) {
+			if( std::isalnum( static_cast<unsigned char>( c ) ) ) {
+				result += c;
+			} else {
+				std::snprintf( escaped, sizeof( escaped ), "\\u%04x", static_cast<unsigned char>( c ) );
+				result += escaped;
+			}
+		}
+		result += "\");</script></head><body></body></html>";
+		return result;
+	}
+
+	// Serves cache://host/path from the page cache while it is fresh.  The
+	// handler runs on the GUI thread on several backends, so a miss never
+	// fetches here: a document loads from http://host/path this time and the
+	// prefetcher stores it for the next.  Stored pages point their relative
+	// links at the network, so a missing sub-resource is simply refused, a
+	// redirect page is no use to an <img> or <script>.  Urls the config does not
+	// allow are refused either way
+	class page_cache_handler_t : public wxWebViewHandler {
+		page_cache_t *m_cache;
+		prefetcher_t *m_prefetcher;
+		std::shared_ptr<page_cache_documents_t> m_documents;
+
+	  public:
+		page_cache_handler_t( page_cache_t *cache, prefetcher_t *prefetcher,
+		                      std::shared_ptr<page_cache_documents_t> documents )
+		    : wxWebViewHandler{page_cache_scheme}
+		    , m_cache{cache}
+		    , m_prefetcher{prefetcher}
+		    , m_documents{std::move( documents )} {}
+		~page_cache_handler_t( ) override = default;
+
+		page_cache_handler_t( page_cache_handler_t const & ) = delete;
+		page_cache_handler_t( page_cache_handler_t && ) = delete;
+		page_cache_handler_t &operator=( page_cache_handler_t const & ) = delete;
+		page_cache_handler_t &operator=( page_cache_handler_t && ) = delete;
+
+		wxFSFile *GetFile( wxString const &uri ) override {
+			auto const url = get_page_cache_target( uri.ToStdString( ) );
+			// The handler may run off the GUI thread, so read the app's config atomically
+			auto const config = wxGetApp( ).GetConfig( );
+			if( !config->is_valid_url( url ) ) {
+				return nullptr;
+			}
+			auto hit = m_cache->find( url );
+			auto const is_document = m_documents->take( uri.ToStdString( ) );
+			if( hit ) {
+				return new wxFSFile{make_shared_memory_stream( std::move( hit->body ) ), uri, hit->mime_type,
+				                    wxEmptyString, wxDateTime::Now( )};
+			}
+			if( !is_document ) {
+				return nullptr;
+			}
+			if( m_prefetcher != nullptr ) {
+				m_prefetcher->fill( config, uri.ToStdString( ) );
+			}
+			auto page = std::make_shared<std::string const>( make_redirect_page( url ) );
+			return new wxFSFile{make_shared_memory_stream( std::move( page ) ), uri, "text/html", wxEmptyString,
+			                    wxDateTime::Now( )};
+		}
+	};
+
+	constexpr char const title_probe_prefix[] = "wba-probe:";
+	// A probe gives up after this, e.g. on a page that is busy or hung
+	constexpr std::chrono::seconds const title_probe_timeout{5};
+	constexpr char const title_restore_script[] =
+	    "if('wbaTitle' in window){document.title=window.wbaTitle;delete window.wbaTitle;}";
+
+	constexpr char const scroll_position_expression[] =
+	    "Math.round(window.pageXOffset)+','+Math.round(window.pageYOffset)";
+
+	boost::optional<wxPoint> parse_scroll_position( wxString const &offset ) {
+		long x = 0;
+		long y = 0;
+		if( !offset.BeforeFirst( ',' ).ToLong( &x ) || !offset.AfterFirst( ',' ).ToLong( &y ) ) {
+			return boost::none;
+		}
+		return wxPoint{static_cast<int>( x ), static_cast<int>( y )};
+	}
+
+	constexpr int const source_progress_range = 1000;
+	constexpr size_t const source_chunk_size = 64 * 1024;
+	constexpr size_t const max_source_chunks_in_flight = 2;
+
+	// Up to source_chunk_size bytes of utf-8, ending after a line break where
+	// there is one and never inside a character
+	size_t get_source_chunk_size( char const *data, size_t size ) {
+		if( size <= source_chunk_size ) {
+			return size;
+		}
+		auto end = source_chunk_size;
+		while( end > 0 && data[end - 1] != '\n' ) {
+			--end;
+		}
+		if( end > 0 ) {
+			return end;
+		}
+		end = source_chunk_size;
+		while( end > 0 && ( static_cast<unsigned char>( data[end] ) & 0xC0 ) == 0x80 ) {
+			--end;
+		}
+		return end > 0 ? end : source_chunk_size;
+	}
+
+	// Automation speaks utf-8 whatever the locale
+	std::string to_utf8( wxString const &text ) {
+		auto const buffer = text.utf8_str( );
+		return std::string( buffer.data( ), buffer.length( ) );
+	}
+
+	// text as a javascript string literal
+	wxString to_js_string( wxString const &text ) {
+		wxString result{"'"};
+		for( auto const c : text ) {
+			switch( c.GetValue( ) ) {
+			case '\\':
+				result += "\\\\";
+				break;
+			case '\'':
+				result += "\\'";
+				break;
+			case '\n':
+				result += "\\n";
+				break;
+			case '\r':
+				result += "\\r";
+				break;
+			default:
+				if( c.GetValue( ) == 0x2028 || c.GetValue( ) == 0x2029 ) {
+					// Line terminators to javascript, though not to json
+					result += wxString::Format( "\\u%04x", static_cast<unsigned>( c.GetValue( ) ) );
+				} else {
+					result += c;
+				}
+				break;
+			}
+		}
+		return result + "'";
+	}
+
+	constexpr char const script_result_prefix[] = "wba-result:";
+	constexpr char const script_error_prefix[] = "wba-error:";
+
+	// A title probe expression for the value of script's last expression, or
+	// what it threw.  Run globally like a script of the page's own
+	wxString make_script_expression( wxString const &script ) {
+		return wxString{"(function(){try{return '"} + script_result_prefix + "'+String((0,eval)(" +
+		       to_js_string( script ) + "));}catch(e){return '" + script_error_prefix + "'+String(e);}})()";
+	}
+
+	automation_response_t make_script_response( int64_t id, boost::optional<wxString> const &value ) {
+		wxString rest;
+		if( !value ) {
+			return make_automation_error( id, "Timed out running script" );
+		}
+		if( value->StartsWith( script_error_prefix, &rest ) ) {
+			return make_automation_error( id, "Script error; message='" + to_utf8( rest ) + "'" );
+		}
+		value->StartsWith( script_result_prefix, &rest );
+		return make_automation_result( id, to_utf8( rest ) );
+	}
+
+	boost::optional<wxWebViewZoom> parse_zoom( boost::string_view name ) {
+		if( name == "tiny" ) {
+			return wxWEBVIEW_ZOOM_TINY;
+		}
+		if( name == "small" ) {
+			return wxWEBVIEW_ZOOM_SMALL;
+		}
+		if( name == "medium" ) {
+			return wxWEBVIEW_ZOOM_MEDIUM;
+		}
+		if( name == "large" ) {
+			return wxWEBVIEW_ZOOM_LARGE;
+		}
+		if( name == "largest" ) {
+			return wxWEBVIEW_ZOOM_LARGEST;
+		}
+		return boost::none;
+	}
+
+	// Just past the tag in the start of html that a <base> can follow, 0 when there is none
+	size_t find_base_position( std::string const &html ) {
+		auto start = html.substr( 0, max_base_search_size );
+		std::transform( start.begin( ), start.end( ), start.begin( ),
+		                []( char c ) { return static_cast<char>( std::tolower( static_cast<unsigned char>( c ) ) ); } );
+		if( start.find( "<base" ) != std::string::npos ) {
+			// The page's own base wins
+			return std::string::npos;
+		}
+		for( auto const tag : {"<head", "<html", "<!doctype"} ) {
+			auto const tag_size = std::strlen( tag );
+			for( auto pos = start.find( tag ); pos != std::string::npos; pos = start.find( tag, pos + 1 ) ) {
+				// Not <header
+				auto const next = pos + tag_size < start.size( ) ? start[pos + tag_size] : '\0';
+				if( next != '>' && !std::isspace( static_cast<unsigned char>( next ) ) ) {
+					continue;
+				}
+				auto const end = start.find( '>', pos );
+				if( end != std::string::npos ) {
+					return end + 1;
+				}
+			}
+		}
+		return 0;
+	}
+
+	// An html page with a <base> of url, so that its relative links load from the
+	// network rather than each missing the cache under cache:
+	std::shared_ptr<std::string const> add_base_href( std::shared_ptr<std::string const> html,
+	                                                  std::string const &url ) {
+		auto const pos = find_base_position( *html );
+		if( pos == std::string::npos ) {
+			return html;
+		}
+		std::string base = "<base href=\"";
+		for( auto const c : url ) {
+			switch( c ) {
+			case '&':
+				base += "&amp;";
+				break;
+			case '"':
+				base += "&quot;";
+				break;
+			case '<':
+				base += "&lt;";
+				break;
+			case '>':
+				base += "&gt;";
+				break;
+			default:
+				base += c;
+				break;
+			}
+		}
+		base += "\">";
+		auto result = std::make_shared<std::string>( );
+		result->reserve( html->size( ) + base.size( ) );
+		result->append( *html, 0, pos ).append( base ).append( *html, pos, std::string::npos );
+		return result;
+	}
+
+	// Stores url in cache for the prefetcher, returning the bytes downloaded
+	uint64_t prefetch_page( page_cache_t &cache, std::string const &url, uint64_t max_size ) {
+		uint64_t bytes_read = 0;
+		auto const page = fetch_page( url, max_size, bytes_read );
+		if( page && page->expires ) {
+			auto body = page->body;
+			auto const mime_type = wxString{page->mime_type}.Lower( );
+			if( mime_type.StartsWith( "text/html" ) ) {
+				body = add_base_href( std::move( body ), url );
+			}
+			cache.insert( url, page->mime_type, body->data( ), body->size( ), *page->expires );
+		}
+		return bytes_read;
+	}
+
+	// The unescaped file name at the end of a url, without query or fragment
+	wxString get_url_file_name( wxString name ) {
+		auto const query = name.find_first_of( "?#" );
+		if( query != wxString::npos ) {
+			name.Truncate( query );
+		}
+		return wxURI::Unescape( name );
+	}
+
+	constexpr char const zip_scheme[] = "zip";
+	constexpr char const zip_member_separator[] = ";protocol=zip/";
+	constexpr size_t const zip_inflated_cache_size = 64;
+
+	// Archives stay mapped for the life of the app and are shared by every frame
+	std::shared_ptr<zip_archive_t> get_zip_archive( std::string const &path ) {
+		static std::mutex s_mutex;
+		static std::unordered_map<std::string, std::shared_ptr<zip_archive_t>> s_archives;
+		std::lock_guard<std::mutex> lock{s_mutex};
+		auto &result = s_archives[path];
+		if( !result ) {
+			result = std::make_shared<zip_archive_t>( path, zip_inflated_cache_size );
+		}
+		return result;
+	}
+
+	// Serves zip:///path/to/archive.zip;protocol=zip/member, the same form as
+	// wxfs: urls, without going through wxFileSystem.  Stored members are
+	// served straight from the mapping
+	class zip_archive_handler_t : public wxWebViewHandler {
+	  public:
+		zip_archive_handler_t( ) : wxWebViewHandler{zip_scheme} {}
+		~zip_archive_handler_t( ) override = default;
+
+		zip_archive_handler_t( zip_archive_handler_t const & ) = delete;
+		zip_archive_handler_t( zip_archive_handler_t && ) = delete;
+		zip_archive_handler_t &operator=( zip_archive_handler_t const & ) = delete;
+		zip_archive_handler_t &operator=( zip_archive_handler_t && ) = delete;
+
+		wxFSFile *GetFile( wxString const &uri ) override {
+			auto const separator = uri.find( zip_member_separator );
+			auto const scheme_size = wxStrlen( zip_scheme );
+			if( separator == wxString::npos || separator < scheme_size ) {
+				return nullptr;
+			}
+			auto const member = get_url_file_name( uri.Mid( separator + wxStrlen( zip_member_separator ) ) );
+			auto const path =
+			    wxFileName::URLToFileName( "file" + uri.Mid( scheme_size, separator - scheme_size ) ).GetFullPath( );
+			try {
+				auto blob = get_zip_archive( path.ToStdString( ) )->read( member.ToStdString( ) );
+				if( !blob ) {
+					return nullptr;
+				}
+				return new wxFSFile{make_shared_memory_stream( std::make_shared<zip_blob_t const>( std::move( *blob ) ) ),
+				                    uri, wxFileSystemHandler::GetMimeTypeFromExt( member ), wxEmptyString,
+				                    wxDateTime::Now( )};
+			} catch( std::exception const &ex ) {
+				std::cerr << "Error reading zip member; url='" << uri << "', message='" << ex.what( ) << "'\n";
+				return nullptr;
+			}
+		}
+	};
+
+	// Serves memory:name from the asset bundle without copying, and anything
+	// the bundle lacks from wxMemoryFSHandler as before
+	class asset_bundle_handler_t : public wxWebViewHandler {
+		asset_bundle_t const *m_bundle;
+		wxWebViewFSHandler m_fallback;
+
+	  public:
+		explicit asset_bundle_handler_t( asset_bundle_t const *bundle )
+		    : wxWebViewHandler{"memory"}, m_bundle{bundle}, m_fallback{"memory"} {}
+		~asset_bundle_handler_t( ) override = default;
+
+		asset_bundle_handler_t( asset_bundle_handler_t const & ) = delete;
+		asset_bundle_handler_t( asset_bundle_handler_t && ) = delete;
+		asset_bundle_handler_t &operator=( asset_bundle_handler_t const & ) = delete;
+		asset_bundle_handler_t &operator=( asset_bundle_handler_t && ) = delete;
+
+		wxFSFile *GetFile( wxString const &uri ) override {
+			if( m_bundle != nullptr ) {
+				auto name = get_url_file_name( uri.AfterFirst( ':' ) );
+				while( name.StartsWith( "/" ) ) {
+					name.Remove( 0, 1 );
+				}
+				auto const asset = m_bundle->find( name.ToStdString( ) );
+				if( asset ) {
+					return new wxFSFile{new wxMemoryInputStream{asset->data.data( ), asset->data.size( )}, uri,
+					                    wxString{asset->mime_type.data( ), asset->mime_type.size( )}, wxEmptyString,
+					                    wxDateTime::Now( )};
+				}
+			}
+			return m_fallback.GetFile( uri );
+		}
+	};
+
+	uint64_t read_all_members( wxWebViewHandler &handler, wxString const &prefix,
+	                           std::vector<std::string> const &names ) {
+		uint64_t result = 0;
+		char buffer[64 * 1024];
+		for( auto const &name : names ) {
+			std::unique_ptr<wxFSFile> file{handler.GetFile( prefix + name )};
+			if( !file ) {
+				throw std::runtime_error{"Error reading zip member; name='" + name + "'"};
+			}
+			auto const stream = file->GetStream( );
+			while( stream->Read( buffer, sizeof( buffer ) ).LastRead( ) > 0 ) {
+				result += stream->LastRead( );
+			}
+		}
+		return result;
+	}
+
+	int benchmark_archive( std::string const &zip_file ) {
+		constexpr size_t const runs = 10;
+		wxFileSystem::AddHandler( new wxArchiveFSHandler );
+		wxFileName zip_path{zip_file};
+		zip_path.MakeAbsolute( );
+		auto path = zip_path.GetFullPath( );
+		path.Replace( "\\", "/" );
+		auto const names = zip_archive_t{zip_file, 0}.names( );
+
+		wxWebViewArchiveHandler wxfs_handler{"wxfs"};
+		zip_archive_handler_t zip_handler;
+		uint64_t bytes = 0;
+		auto const wxfs_ms = average_ms( runs, [&]( ) {
+			bytes = read_all_members( wxfs_handler, "wxfs:///" + path + zip_member_separator, names );
+		} );
+		auto const zip_ms = average_ms( runs, [&]( ) {
+			bytes = read_all_members( zip_handler, "zip:///" + path + zip_member_separator, names );
+		} );
+		auto const mb = static_cast<double>( bytes ) / ( 1024.0 * 1024.0 );
+		std::cout << "Read " << names.size( ) << " members, " << mb << "MB, average of " << runs << " runs\n";
+		std::cout << "  wxfs: " << wxfs_ms << "ms, " << mb * 1000.0 / wxfs_ms << "MB/s\n";
+		std::cout << "  zip:  " << zip_ms << "ms, " << mb * 1000.0 / zip_ms << "MB/s\n";
+		return EXIT_SUCCESS;
+	}
 } // namespace
 
+int WebApp::OnRun( ) {
+	if( m_exit_code ) {
+		return *m_exit_code;
+	}
+	auto result = wxApp::OnRun( );
+	// The exit code of a dump waits for the last text to be written
+	if( m_text_export && ( !m_text_export->finish( ) || m_dump_failures > 0 ) ) {
+		result = EXIT_FAILURE;
+	}
+	return result;
+}
+
+void WebApp::StartTextDump( ) {
+	if( m_dump_urls.empty( ) ) {
+		m_frame->Close( true );
+		return;
+	}
+	for( size_t n = 0; n < m_dump_urls.size( ); ++n ) {
+		auto const id = static_cast<int64_t>( n );
+		auto const &url = m_dump_urls[n];
+		// The text request must not pick up the previous page after a failed load
+		auto const is_loaded = std::make_shared<bool>( false );
+		m_frame->RunAutomation( automation_request_t{id, "navigate", url},
+		                        [this, is_loaded]( automation_response_t response ) {
+			                        *is_loaded = response.is_ok;
+			                        if( !response.is_ok ) {
+				                        std::cerr << response.error << '\n';
+				                        ++m_dump_failures;
+			                        }
+		                        } );
+		auto const is_last = n + 1 == m_dump_urls.size( );
+		m_frame->RunAutomation( automation_request_t{id, "get_page_text", std::string{}},
+		                        [this, url, is_loaded, is_last]( automation_response_t response ) {
+			                        if( *is_loaded && response.is_ok ) {
+				                        m_text_export->add( url, std::move( response.result ) );
+			                        } else if( *is_loaded ) {
+				                        std::cerr << response.error << "; url='" << url << "'\n";
+				                        ++m_dump_failures;
+			                        }
+			                        if( is_last ) {
+				                        // The last frame closing ends the run
+				                        m_frame->Close( true );
+			                        }
+		                        } );
+	}
+}
+
 bool WebApp::OnInit( ) {
 	if( !wxApp::OnInit( ) ) {
 		return false;
@@ -100,29 +917,356 @@ bool WebApp::OnInit( ) {
 
 	try {
 		auto const conf_file = get_config_file( );
-		if( !boost::filesystem::exists( conf_file ) ) {
-			m_app_config.to_file( conf_file, false );
-		} else {
-			m_app_config = daw::json::from_file<config_t>( conf_file );
+		// Loaded ahead of every mode, the config decides whether the command line may choose one
+		auto config = load_config( conf_file, true );
+		finalize_config( config );
+		if( m_has_user_arguments && !is_enabled( features::command_line, config.enable_command_line ) ) {
+			std::cerr << config_denied_exception{config_denied_exception_kind::enable_command_line}.what( ) << '\n';
+			return false;
+		}
+		switch( m_run_mode ) {
+		case run_mode_t::benchmark_config:
+			m_exit_code = benchmark_config( conf_file );
+			return true;
+		case run_mode_t::benchmark_archive:
+			m_exit_code = benchmark_archive( m_mode_path );
+			return true;
+		case run_mode_t::pack_bundle: {
+			auto const bundle_file = boost::filesystem::path{m_mode_path}.remove_trailing_separator( ).string( ) + ".bundle";
+			write_asset_bundle( m_mode_path, bundle_file );
+			std::cout << "Wrote asset bundle; path='" << bundle_file << "'\n";
+			m_exit_code = EXIT_SUCCESS;
+			return true;
 		}
+		case run_mode_t::compile_config: {
+			auto const snapshot_file = get_config_snapshot_file( conf_file );
+			write_config_snapshot( daw::json::from_file<config_t>( conf_file ), conf_file, snapshot_file );
+			std::cout << "Wrote config snapshot; path='" << snapshot_file << "'\n";
+			m_exit_code = EXIT_SUCCESS;
+			return true;
+		}
+		case run_mode_t::browser:
+		case run_mode_t::supervise:
+		case run_mode_t::dump_text:
+			break;
+		}
+		std::shared_ptr<config_t const> app_config = std::make_shared<config_t>( std::move( config ) );
+		std::atomic_store( &m_app_config, std::move( app_config ) );
+		m_config_file = conf_file;
+		get_startup_trace( ).mark( "config" );
 	} catch( std::exception const &ex ) {
 		std::cerr << "Error getting config file path: " << ex.what( ) << '\n';
 		std::terminate( );
 	}
 
-	if( m_app_config.home_url.empty( ) ) {
-		m_app_config.home_url = "http://localhost";
+	if( m_run_mode == run_mode_t::supervise ) {
+		// The site processes do the browsing
+		m_supervisor = std::make_unique<supervisor_t>( GetConfig( ), get_supervisor_service( wxGetProcessId( ) ) );
+		if( !m_supervisor->start( ) ) {
+			m_exit_code = EXIT_FAILURE;
+		}
+		return true;
+	}
+	if( m_site_group ) {
+		auto groups = make_site_groups( *GetConfig( ) );
+		if( *m_site_group >= groups.size( ) ) {
+			std::cerr << "Site group out of range; group=" << *m_site_group << '\n';
+			return false;
+		}
+		m_supervisor_link = connect_to_supervisor( m_supervisor_service, std::move( groups ), *m_site_group,
+		                                           [this]( std::string const &url ) {
+			                                           if( m_frame != nullptr ) {
+				                                           m_frame->Navigate( url );
+			                                           }
+		                                           } );
+		if( !m_supervisor_link ) {
+			std::cerr << "Error connecting to supervisor; service='" << m_supervisor_service << "'\n";
+			return false;
+		}
 	}
-	m_frame = new WebFrame{m_app_config.home_url, m_app_config};
-	m_frame->Show( );
+
+	try {
+		m_history_store = std::make_unique<history_store_t>( get_history_base( m_config_file, m_site_group ) );
+		get_startup_trace( ).mark( "history" );
+	} catch( std::exception const &ex ) {
+		// Browsing still works, it is just not remembered
+		std::cerr << "Error opening history; message='" << ex.what( ) << "'\n";
+	}
+
+	auto const config = GetConfig( );
+	m_url_suggestions = std::make_unique<url_suggestions_t>( m_history_store.get( ), config );
+	if( config->page_cache_size > 0 ) {
+		try {
+			m_page_cache = std::make_unique<page_cache_t>(
+			    get_page_cache_dir( m_config_file, m_site_group ),
+			    static_cast<uint64_t>( std::max( config->page_cache_size, int64_t{0} ) ),
+			    static_cast<uint64_t>( std::max( config->page_cache_entry_size, int64_t{0} ) ) );
+			// The prefetcher fetches on its own thread
+			wxSocketBase::Initialize( );
+			auto const page_cache = m_page_cache.get( );
+			m_prefetcher = std::make_unique<prefetcher_t>(
+			    *page_cache, [page_cache]( std::string const &url, uint64_t max_size ) {
+				    return prefetch_page( *page_cache, url, max_size );
+			    } );
+		} catch( std::exception const &ex ) {
+			std::cerr << "Error opening page cache; message='" << ex.what( ) << "'\n";
+		}
+	}
+	// Changing the bundle needs a restart
+	try {
+		if( !config->asset_bundle.empty( ) ) {
+			auto const config_dir = boost::filesystem::path{m_config_file}.parent_path( );
+			m_asset_bundle =
+			    std::make_unique<asset_bundle_t>( boost::filesystem::absolute( config->asset_bundle, config_dir ).string( ) );
+		} else if( !get_builtin_asset_bundle( ).empty( ) ) {
+			m_asset_bundle = std::make_unique<asset_bundle_t>( get_builtin_asset_bundle( ) );
+		}
+		get_startup_trace( ).mark( "bundle" );
+	} catch( std::exception const &ex ) {
+		std::cerr << "Error loading asset bundle; message='" << ex.what( ) << "'\n";
+	}
+	// Fills on idle, so the first frame still creates its own view
+	m_webview_pool = std::make_unique<webview_pool_t>( static_cast<size_t>( std::max( config->webview_pool_size,
+	                                                                                   int64_t{0} ) ) );
+	if( m_run_mode == run_mode_t::dump_text ) {
+		try {
+			m_text_export = std::make_unique<text_export_t>( m_dump_output );
+		} catch( std::exception const &ex ) {
+			std::cerr << ex.what( ) << '\n';
+			return false;
+		}
+	}
+	if( !m_automation_path.empty( ) ) {
+		m_automation_server = std::make_unique<automation_server_t>(
+		    m_automation_path, [this]( automation_request_t request, automation_reply_t reply ) {
+			    if( m_frame == nullptr ) {
+				    reply( make_automation_error( request.id, "No frame" ) );
+				    return;
+			    }
+			    m_frame->RunAutomation( std::move( request ), std::move( reply ) );
+		    } );
+		if( !m_automation_server->start( ) ) {
+			return false;
+		}
+	}
+	m_navigation_timing = std::make_unique<navigation_timing_t>( );
+	// A url on the command line still goes through the navigation policy
+	m_frame = new WebFrame{m_url.empty( ) ? wxString{config->home_url} : m_url, config,
+	                       frame_services_t{m_history_store.get( ), m_url_suggestions.get( ), m_page_cache.get( ),
+	                                        m_prefetcher.get( ), m_asset_bundle.get( ), m_webview_pool.get( ),
+	                                        m_supervisor_link.get( ), m_navigation_timing.get( )}};
+	if( m_run_mode == run_mode_t::dump_text ) {
+		StartTextDump( );
+	} else if( !m_automation_server ) {
+		m_frame->Show( );
+	}
+	get_startup_trace( ).mark( "frame" );
 
 	return true;
 }
 
-WebApp::WebApp( ) : m_url{}, m_frame{}, m_app_config{} {}
+int WebApp::OnExit( ) {
+	m_reload_timer.reset( );
+#if wxUSE_FSWATCHER
+	m_config_watcher.reset( );
+#endif
+	if( m_reload_thread.joinable( ) ) {
+		m_reload_thread.join( );
+	}
+	// The frames are gone by now; this writes any visits still queued
+	m_text_export.reset( );
+	m_navigation_timing.reset( );
+	m_automation_server.reset( );
+	m_supervisor_link.reset( );
+	m_supervisor.reset( );
+	m_webview_pool.reset( );
+	m_asset_bundle.reset( );
+	m_prefetcher.reset( );
+	m_page_cache.reset( );
+	m_url_suggestions.reset( );
+	m_history_store.reset( );
+	return wxApp::OnExit( );
+}
 
-WebFrame::WebFrame( wxString const &url, config_t const &app_config )
-    : wxFrame{nullptr, wxID_ANY, app_config.app_title.c_str( )}, m_app_config{&app_config} {
+std::shared_ptr<config_t const> WebApp::GetConfig( ) const {
+	return std::atomic_load( &m_app_config );
+}
+
+void WebApp::OnEventLoopEnter( wxEventLoopBase *loop ) {
+	wxApp::OnEventLoopEnter( loop );
+#if wxUSE_FSWATCHER
+	// The watcher needs a running event loop, and modal dialogs enter nested ones
+	if( m_config_watcher || m_config_file.empty( ) || !loop->IsMain( ) ) {
+		return;
+	}
+	m_reload_timer = std::make_unique<wxTimer>( this );
+	Bind( wxEVT_TIMER, &WebApp::OnReloadTimer, this, m_reload_timer->GetId( ) );
+	m_config_watcher = std::make_unique<wxFileSystemWatcher>( );
+	m_config_watcher->SetOwner( this );
+	Bind( wxEVT_FSWATCHER, &WebApp::OnConfigFileChanged, this );
+	// Watch the directory, editors usually save by replacing the file
+	wxFileName const config_dir{wxFileName{m_config_file}.GetPath( ), wxEmptyString};
+	if( !m_config_watcher->Add( config_dir, wxFSW_EVENT_CREATE | wxFSW_EVENT_MODIFY | wxFSW_EVENT_RENAME ) ) {
+		std::cerr << "Error watching config file for changes; path='" << m_config_file << "'\n";
+		m_config_watcher.reset( );
+	}
+#endif
+}
+
+#if wxUSE_FSWATCHER
+void WebApp::OnConfigFileChanged( wxFileSystemWatcherEvent &evt ) {
+	wxFileName const config_file{m_config_file};
+	auto const is_config = [&]( wxFileName const &path ) { return path.GetFullName( ) == config_file.GetFullName( ); };
+	auto const is_renamed_to_config = evt.GetChangeType( ) == wxFSW_EVENT_RENAME && is_config( evt.GetNewPath( ) );
+	if( is_config( evt.GetPath( ) ) || is_renamed_to_config ) {
+		m_reload_timer->StartOnce( config_reload_delay_ms );
+	}
+}
+#endif
+
+void WebApp::OnReloadTimer( wxTimerEvent &WXUNUSED( evt ) ) {
+	if( m_is_reloading ) {
+		// Pick up the latest change once the running reload is done
+		m_reload_timer->StartOnce( config_reload_delay_ms );
+		return;
+	}
+	StartConfigReload( );
+}
+
+void WebApp::StartConfigReload( ) {
+	if( m_reload_thread.joinable( ) ) {
+		m_reload_thread.join( );
+	}
+	m_is_reloading = true;
+	// Parsing and compiling the validators happens off the GUI thread, only
+	// the swap happens on it
+	m_reload_thread = std::thread{[this, conf_file = m_config_file]( ) {
+		std::shared_ptr<config_t const> result;
+		std::string error;
+		try {
+			auto config = load_config( conf_file, false );
+			finalize_config( config );
+			result = std::make_shared<config_t>( std::move( config ) );
+		} catch( std::exception const &ex ) {
+			error = ex.what( );
+		}
+		CallAfter( [this, result, error]( ) { OnConfigReloaded( result, error ); } );
+	}};
+}
+
+void WebApp::OnConfigReloaded( std::shared_ptr<config_t const> config, std::string const &error ) {
+	m_is_reloading = false;
+	if( !config ) {
+		std::cerr << "Error reloading config, keeping the current one; path='" << m_config_file << "', message='"
+		          << error << "'\n";
+		return;
+	}
+	std::atomic_store( &m_app_config, config );
+	if( m_url_suggestions ) {
+		m_url_suggestions->set_config( config );
+	}
+	if( m_page_cache ) {
+		// Turning the cache on or off needs a restart
+		m_page_cache->set_limits( static_cast<uint64_t>( std::max( config->page_cache_size, int64_t{0} ) ),
+		                          static_cast<uint64_t>( std::max( config->page_cache_entry_size, int64_t{0} ) ) );
+	}
+	if( m_supervisor ) {
+		m_supervisor->set_config( config );
+	}
+	if( m_webview_pool ) {
+		m_webview_pool->set_size( static_cast<size_t>( std::max( config->webview_pool_size, int64_t{0} ) ) );
+	}
+	for( auto window : wxTopLevelWindows ) {
+		auto frame = dynamic_cast<WebFrame *>( window );
+		if( frame != nullptr ) {
+			frame->ApplyConfig( config );
+		}
+	}
+	if( is_enabled( features::debug_window, config->enable_debug_window ) ) {
+		wxLogMessage( "%s", "Reloaded config; path='" + m_config_file + "'" );
+	}
+}
+
+WebApp::WebApp( )
+    : m_url{}
+    , m_has_user_arguments{false}
+    , m_frame{}
+    , m_app_config{std::make_shared<config_t>( )}
+    , m_config_file{}
+    , m_run_mode{run_mode_t::browser}
+    , m_mode_path{}
+    , m_exit_code{}
+    , m_site_group{}
+    , m_supervisor_service{}
+    , m_automation_path{}
+    , m_dump_urls{}
+    , m_dump_output{}
+    , m_dump_failures{0}
+    , m_reload_timer{}
+    , m_reload_thread{}
+    , m_is_reloading{false}
+    , m_history_store{}
+    , m_url_suggestions{}
+    , m_page_cache{}
+    , m_prefetcher{}
+    , m_asset_bundle{}
+    , m_webview_pool{}
+    , m_supervisor{}
+    , m_supervisor_link{}
+    , m_automation_server{}
+    , m_text_export{}
+    , m_navigation_timing{} {
+
+	// Start the startup clock
+	get_startup_trace( );
+}
+
+size_t const WebFrame::history_page_size;
+
+WebFrame::WebFrame( wxString const &url, std::shared_ptr<config_t const> app_config, frame_services_t services )
+    : wxFrame{nullptr, wxID_ANY, app_config->app_title.c_str( )}
+    , m_url{nullptr}
+    , m_browser{nullptr}
+    , m_tabs{nullptr}
+    , m_tab_states{}
+    , m_tab_clock{0}
+    , m_title_probes{}
+    , m_title_probe_count{0}
+    , m_toolbar{nullptr}
+    , m_tools_handlers{}
+    , m_find_panel{nullptr}
+    , m_find_ctrl{nullptr}
+    , m_find_toolbar{nullptr}
+    , m_log_window{nullptr}
+    , m_history{}
+    , m_history_current{0}
+    , m_history_page_start{0}
+    , m_history_slots{}
+    , m_history_checked{}
+    , m_history_slot_pos{0}
+    , m_history_older{nullptr}
+    , m_history_newer{nullptr}
+    , m_services{services}
+    , m_last_loaded_url{}
+    , m_findText{wxEmptyString}
+    , m_findFlags{wxWEBVIEW_FIND_DEFAULT}
+    , m_findCount{0}
+    , m_find_engine{}
+    , m_find_timer{this}
+    , m_find_generation{0}
+    , m_is_find_snapshot_stale{true}
+    , m_page_texts{page_text_cache_bytes}
+    , m_page_search{nullptr}
+    , m_app_config{std::move( app_config )}
+    // Toolbar tools start out enabled
+    , m_ui_state{true, true, true, wxEmptyString, wxEmptyString}
+    , m_state_timer{this}
+    , m_nav_policy{std::make_unique<navigation_policy_t>( std::max( 1u, std::thread::hardware_concurrency( ) / 2 ) )}
+    , m_nav_generation{0}
+    , m_approved_url{}
+    , m_owned_url{}
+    , m_cache_documents{std::make_shared<page_cache_documents_t>( )}
+    , m_automation_jobs{} {
 
 	if( boost::filesystem::exists( m_app_config->app_icon ) &&
 	    boost::filesystem::is_regular_file( m_app_config->app_icon ) ) {
@@ -143,94 +1287,25 @@ WebFrame::WebFrame( wxString const &url, config_t const &app_config )
 
 	auto topsizer = std::make_unique<wxBoxSizer>( wxVERTICAL );
 
+#if WBA_HAS_FEATURE( TOOLBAR )
 	// Create the toolbar
-	if( m_app_config->enable_toolbar ) {
-		m_toolbar = wxFrame::CreateToolBar( wxTB_TEXT );
-		m_toolbar->SetToolBitmapSize( wxSize{32, 32} );
-
-		auto back = wxArtProvider::GetBitmap( wxART_GO_BACK, wxART_TOOLBAR );
-		auto forward = wxArtProvider::GetBitmap( wxART_GO_FORWARD, wxART_TOOLBAR );
-#ifdef __WXGTK__
-		auto stop = wxArtProvider::GetBitmap( "gtk-stop", wxART_TOOLBAR );
-#else
-		auto stop = wxBitmap( stop_xpm );
-#endif
-#ifdef __WXGTK__
-		auto refresh = wxArtProvider::GetBitmap( "gtk-refresh", wxART_TOOLBAR );
-#else
-		auto refresh = wxBitmap( refresh_xpm );
-#endif
-
-		m_toolbar_back = m_toolbar->AddTool( wxID_ANY, _( "Back" ), back );
-		m_toolbar_forward = m_toolbar->AddTool( wxID_ANY, _( "Forward" ), forward );
-		m_toolbar_stop = m_toolbar->AddTool( wxID_ANY, _( "Stop" ), stop );
-		m_toolbar_reload = m_toolbar->AddTool( wxID_ANY, _( "Reload" ), refresh );
-		m_url = new wxTextCtrl{m_toolbar, wxID_ANY, wxT( "" ), wxDefaultPosition, wxSize{400, -1}, wxTE_PROCESS_ENTER};
-		m_toolbar->AddControl( m_url, _( "URL" ) );
-		m_toolbar_tools = m_toolbar->AddTool( wxID_ANY, _( "Menu" ), wxBitmap( wxlogo_xpm ) );
-
-		m_toolbar->Realize( );
-		// Set find values.
-		m_findFlags = wxWEBVIEW_FIND_DEFAULT;
-		m_findText = wxEmptyString;
-		m_findCount = 0;
-
-		// Create panel for find toolbar.
-		auto panel = new wxPanel{this};
-		topsizer->Add( panel, wxSizerFlags( ).Expand( ) );
-
-		// Create sizer for panel.
-		auto panel_sizer = new wxBoxSizer{wxVERTICAL};
-		panel->SetSizer( panel_sizer );
-
-		// Create the find toolbar.
-		m_find_toolbar = new wxToolBar{panel, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-		                               wxTB_HORIZONTAL | wxTB_TEXT | wxTB_HORZ_LAYOUT};
-		m_find_toolbar->Hide( );
-		panel_sizer->Add( m_find_toolbar, wxSizerFlags( ).Expand( ) );
-
-		// Create find control.
-		m_find_ctrl = new wxTextCtrl{m_find_toolbar,    wxID_ANY,        wxEmptyString,
-		                             wxDefaultPosition, wxSize{140, -1}, wxTE_PROCESS_ENTER};
-
-		// Find options menu
-		auto findmenu = std::make_unique<wxMenu>( );
-		m_find_toolbar_wrap = findmenu->AppendCheckItem( wxID_ANY, "Wrap" );
-		m_find_toolbar_matchcase = findmenu->AppendCheckItem( wxID_ANY, "Match Case" );
-		m_find_toolbar_wholeword = findmenu->AppendCheckItem( wxID_ANY, "Entire Word" );
-		m_find_toolbar_highlight = findmenu->AppendCheckItem( wxID_ANY, "Highlight" );
-		// Add find toolbar tools.
-		m_find_toolbar->SetToolSeparation( 7 );
-		m_find_toolbar_done =
-		    m_find_toolbar->AddTool( wxID_ANY, "Close", wxArtProvider::GetBitmap( wxART_CROSS_MARK ) );
-		m_find_toolbar->AddSeparator( );
-		m_find_toolbar->AddControl( m_find_ctrl, "Find" );
-		m_find_toolbar->AddSeparator( );
-		m_find_toolbar_next = m_find_toolbar->AddTool(
-		    wxID_ANY, "Next", wxArtProvider::GetBitmap( wxART_GO_DOWN, wxART_TOOLBAR, wxSize{16, 16} ) );
-		m_find_toolbar_previous = m_find_toolbar->AddTool(
-		    wxID_ANY, "Previous", wxArtProvider::GetBitmap( wxART_GO_UP, wxART_TOOLBAR, wxSize{16, 16} ) );
-		m_find_toolbar->AddSeparator( );
-		m_find_toolbar_options = m_find_toolbar->AddTool(
-		    wxID_ANY, "Options", wxArtProvider::GetBitmap( wxART_PLUS, wxART_TOOLBAR, wxSize{16, 16} ), "",
-		    wxITEM_DROPDOWN );
-		m_find_toolbar_options->SetDropdownMenu( findmenu.release( ) );
-		m_find_toolbar->Realize( );
+	if( is_enabled( features::toolbar, m_app_config->enable_toolbar ) ) {
+		BuildToolbar( topsizer.get( ) );
 	}
+#endif
 
 	// Create the info panel
 	m_info = new wxInfoBar{this};
 	topsizer->Add( m_info, wxSizerFlags( ).Expand( ) );
 
-	// Create the webview
-	m_browser = wxWebView::New( this, wxID_ANY, url );
-
-	topsizer->Add( m_browser, wxSizerFlags( ).Expand( ).Proportion( 1 ) );
-
-	// We register the wxfs:// protocol for testing purposes
-	m_browser->RegisterHandler( wxSharedPtr<wxWebViewHandler>( new wxWebViewArchiveHandler{"wxfs"} ) );
-	// And the memory: file system
-	m_browser->RegisterHandler( wxSharedPtr<wxWebViewHandler>( new wxWebViewFSHandler{"memory"} ) );
+	// Tabs, each with a webview of its own
+	m_tabs = new wxAuiNotebook{
+	    this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+	    wxAUI_NB_TOP | wxAUI_NB_TAB_MOVE | wxAUI_NB_SCROLL_BUTTONS | wxAUI_NB_CLOSE_ON_ACTIVE_TAB};
+	topsizer->Add( m_tabs, wxSizerFlags( ).Expand( ).Proportion( 1 ) );
+	Bind( wxEVT_AUINOTEBOOK_PAGE_CHANGED, &WebFrame::OnTabChanged, this, m_tabs->GetId( ) );
+	Bind( wxEVT_AUINOTEBOOK_PAGE_CLOSE, &WebFrame::OnTabClose, this, m_tabs->GetId( ) );
+	AddTab( url, true );
 
 	SetSizer( topsizer.release( ) );
 
@@ -238,213 +1313,837 @@ WebFrame::WebFrame( wxString const &url, config_t const &app_config )
 	SetSize( wxSize{800, 600} );
 
 	// Create a log window
-	if( m_app_config->enable_debug_window ) {
-		new wxLogWindow{this, _( "Logging" ), true, false};
+#if WBA_HAS_FEATURE( DEBUG_WINDOW )
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		m_log_window = new wxLogWindow{this, _( "Logging" ), true, false};
 	}
+#endif
+
+	// State normally follows the webview events, the timer is only a fallback
+	Connect( m_state_timer.GetId( ), wxEVT_TIMER, wxTimerEventHandler( WebFrame::OnStateTimer ), nullptr, this );
+	m_state_timer.Start( state_timer_interval_ms );
+	UpdateState( );
+}
+
+wxWebView *WebFrame::CreateView( wxWindow *parent ) {
+	// Take a warm view when the pool has one.  It stays blank until the handlers are in
+	auto const view = m_services.webview_pool != nullptr ? m_services.webview_pool->acquire( parent )
+	                                                     : wxWebView::New( parent, wxID_ANY );
+
+	// We register the wxfs:// protocol for testing purposes
+	view->RegisterHandler( wxSharedPtr<wxWebViewHandler>( new wxWebViewArchiveHandler{"wxfs"} ) );
+	// And the memory: file system, asset bundle first
+	view->RegisterHandler( wxSharedPtr<wxWebViewHandler>( new asset_bundle_handler_t{m_services.asset_bundle} ) );
+	// Zips read directly rather than through wxFileSystem
+	view->RegisterHandler( wxSharedPtr<wxWebViewHandler>( new zip_archive_handler_t{} ) );
+	if( m_services.page_cache != nullptr ) {
+		view->RegisterHandler( wxSharedPtr<wxWebViewHandler>(
+		    new page_cache_handler_t{m_services.page_cache, m_services.prefetcher, m_cache_documents} ) );
+	}
+
+	// Bound to the view rather than the frame so they go with it when its tab is suspended
+	view->Bind( wxEVT_WEBVIEW_NAVIGATING, &WebFrame::OnNavigationRequest, this );
+	view->Bind( wxEVT_WEBVIEW_NAVIGATED, &WebFrame::OnNavigationComplete, this );
+	view->Bind( wxEVT_WEBVIEW_LOADED, &WebFrame::OnDocumentLoaded, this );
+	view->Bind( wxEVT_WEBVIEW_ERROR, &WebFrame::OnError, this );
+	view->Bind( wxEVT_WEBVIEW_NEWWINDOW, &WebFrame::OnNewWindow, this );
+	// OnTitleChanged checks enable_title_change itself so a config reload can
+	// toggle it.  Bound either way since it also answers title probes
+	view->Bind( wxEVT_WEBVIEW_TITLE_CHANGED, &WebFrame::OnTitleChanged, this );
+	return view;
+}
+
+void WebFrame::AddTab( wxString const &url, bool is_selected ) {
+	auto const page = new wxPanel{m_tabs};
+	page->SetSizer( new wxBoxSizer{wxVERTICAL} );
+	auto const view = CreateView( page );
+	page->GetSizer( )->Add( view, wxSizerFlags( ).Expand( ).Proportion( 1 ) );
+	view->LoadURL( url );
+	m_tab_states.push_back( tab_t{page, view, url, boost::none, 0, false} );
+	m_tabs->AddPage( page, url, false );
+	UpdateTabBar( );
+	if( is_selected || m_browser == nullptr ) {
+		m_tabs->ChangeSelection( m_tabs->GetPageIndex( page ) );
+		SelectTab( m_tab_states.back( ) );
+	} else {
+		GovernTabs( );
+	}
+}
+
+void WebFrame::CloseTab( wxWindow *page ) {
+	// A frame always keeps a tab
+	auto tab = FindTab( page );
+	if( tab == nullptr || m_tab_states.size( ) < 2 ) {
+		return;
+	}
+	if( tab->view != nullptr && tab->view == m_browser ) {
+		// Select the most recently used of the others first so m_browser never dangles
+		tab_t *next = nullptr;
+		for( auto &other : m_tab_states ) {
+			if( &other != tab && ( next == nullptr || other.last_active > next->last_active ) ) {
+				next = &other;
+			}
+		}
+		m_tabs->ChangeSelection( m_tabs->GetPageIndex( next->page ) );
+		SelectTab( *next );
+	}
+	if( tab->view != nullptr ) {
+		DropTitleProbes( tab->view );
+	}
+	m_tabs->DeletePage( m_tabs->GetPageIndex( page ) );
+	m_tab_states.erase( std::find_if( m_tab_states.begin( ), m_tab_states.end( ),
+	                                  [page]( tab_t const &t ) { return t.page == page; } ) );
+	UpdateTabBar( );
+}
 
-	// Create the Tools menu
+WebFrame::tab_t *WebFrame::FindTab( wxObject const *page_or_view ) {
+	for( auto &tab : m_tab_states ) {
+		if( tab.page == page_or_view || ( tab.view != nullptr && tab.view == page_or_view ) ) {
+			return &tab;
+		}
+	}
+	return nullptr;
+}
+
+void WebFrame::SelectTab( tab_t &tab ) {
+	tab.last_active = ++m_tab_clock;
+	tab.is_suspending = false;
+	if( tab.view == nullptr ) {
+		ResumeTab( tab );
+	}
+	if( tab.view == m_browser ) {
+		return;
+	}
+	// A policy check still running belongs to the tab being left
+	++m_nav_generation;
+	InvalidateFindSnapshot( );
+	m_browser = tab.view;
+	m_browser->SetFocus( );
+	UpdateState( );
+	GovernTabs( );
+}
+
+void WebFrame::SuspendTab( tab_t &tab ) {
+	wxASSERT( tab.view != nullptr && tab.view != m_browser && !tab.is_suspending );
+	tab.is_suspending = true;
+	auto const view = tab.view;
+	RunTitleProbe( *view, scroll_position_expression,
+	               [this, view]( boost::optional<wxString> scroll ) { FinishSuspendTab( view, scroll ); } );
+}
+
+void WebFrame::FinishSuspendTab( wxWebView *view, boost::optional<wxString> const &scroll ) {
+	auto const tab = FindTab( view );
+	if( tab == nullptr || tab->view != view || !tab->is_suspending ) {
+		// Closed or selected again while the offset was read
+		return;
+	}
+	tab->is_suspending = false;
+	tab->url = view->GetCurrentURL( );
+	// Without an offset, e.g. after a timeout, the tab resumes at the top
+	tab->scroll = scroll ? parse_scroll_position( *scroll ) : boost::none;
+	DropTitleProbes( view );
+	view->Destroy( );
+	tab->view = nullptr;
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		wxLogMessage( "%s", "Suspended tab; url='" + tab->url + "'" );
+	}
+}
+
+void WebFrame::ResumeTab( tab_t &tab ) {
+	tab.view = CreateView( tab.page );
+	tab.page->GetSizer( )->Add( tab.view, wxSizerFlags( ).Expand( ).Proportion( 1 ) );
+	tab.page->Layout( );
+	// Back and forward history does not survive suspension, wxWebView cannot rebuild it
+	tab.view->LoadURL( tab.url );
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		wxLogMessage( "%s", "Resumed tab; url='" + tab.url + "'" );
+	}
+}
+
+void WebFrame::GovernTabs( ) {
+	std::vector<tab_t *> background;
+	for( auto &tab : m_tab_states ) {
+		if( tab.view != nullptr && tab.view != m_browser && !tab.is_suspending ) {
+			background.push_back( &tab );
+		}
+	}
+	if( background.empty( ) ) {
+		return;
+	}
+	size_t suspend_count = 0;
+	if( m_app_config->max_live_tabs > 0 && background.size( ) > static_cast<uint64_t>( m_app_config->max_live_tabs ) ) {
+		suspend_count = background.size( ) - static_cast<size_t>( m_app_config->max_live_tabs );
+	}
+	// Memory only comes back once a view is gone, so check again on the next call before taking another
+	if( suspend_count < background.size( ) && m_app_config->tab_memory_limit > 0 ) {
+		// Page memory lives in the content processes, not this one
+		auto const resident_size = get_process_tree_resident_size( );
+		if( resident_size && *resident_size > static_cast<uint64_t>( m_app_config->tab_memory_limit ) ) {
+			++suspend_count;
+		}
+	}
+	if( suspend_count == 0 ) {
+		return;
+	}
+	std::partial_sort( background.begin( ), background.begin( ) + static_cast<std::ptrdiff_t>( suspend_count ),
+	                   background.end( ),
+	                   []( tab_t const *lhs, tab_t const *rhs ) { return lhs->last_active < rhs->last_active; } );
+	for( size_t n = 0; n < suspend_count; ++n ) {
+		SuspendTab( *background[n] );
+	}
+}
+
+void WebFrame::UpdateTabBar( ) {
+	m_tabs->SetTabCtrlHeight( m_tab_states.size( ) > 1 ? -1 : 0 );
+}
+
+void WebFrame::OnTabChanged( wxAuiNotebookEvent &evt ) {
+	auto const tab = FindTab( m_tabs->GetPage( static_cast<size_t>( evt.GetSelection( ) ) ) );
+	if( tab != nullptr ) {
+		SelectTab( *tab );
+	}
+}
+
+void WebFrame::OnTabClose( wxAuiNotebookEvent &evt ) {
+	// Closed through CloseTab so the selection moves before the page goes
+	evt.Veto( );
+	CloseTab( m_tabs->GetPage( static_cast<size_t>( evt.GetSelection( ) ) ) );
+}
+
+void WebFrame::OnNewTab( wxCommandEvent &WXUNUSED( evt ) ) {
+	AddTab( m_app_config->home_url, true );
+}
+
+void WebFrame::OnCloseTab( wxCommandEvent &WXUNUSED( evt ) ) {
+	CloseTab( m_browser->GetParent( ) );
+}
+
+#if WBA_HAS_FEATURE( TOOLBAR )
+wxMenuItem *WebFrame::AppendTool( wxMenu *menu, tools_menu_id_t id, wxString const &label, menu_handler_t handler,
+                                  wxItemKind kind ) {
+	m_tools_handlers[static_cast<size_t>( id - id_tools_first )] = handler;
+	return menu->Append( id, label, wxEmptyString, kind );
+}
+
+void WebFrame::OnToolsMenu( wxCommandEvent &evt ) {
+	auto const index = evt.GetId( ) - id_tools_first;
+	if( index < 0 || index >= id_tools_end - id_tools_first ||
+	    m_tools_handlers[static_cast<size_t>( index )] == nullptr ) {
+		evt.Skip( );
+		return;
+	}
+	( this->*m_tools_handlers[static_cast<size_t>( index )] )( evt );
+}
+
+// Built on the first OnToolsClicked, most sessions never open the menu
+void WebFrame::BuildToolsMenu( ) {
+	auto const start = std::chrono::steady_clock::now( );
 	m_tools_menu = std::make_unique<wxMenu>( );
-	wxMenuItem *print = m_tools_menu->Append( wxID_ANY, _( "Print" ) );
-	wxMenuItem *viewSource = m_tools_menu->Append( wxID_ANY, _( "View Source" ) );
-	wxMenuItem *viewText = m_tools_menu->Append( wxID_ANY, _( "View Text" ) );
+#if WBA_HAS_FEATURE( PRINTING )
+	AppendTool( m_tools_menu.get( ), id_print, _( "Print" ), &WebFrame::OnPrint );
+#endif
+#if WBA_HAS_FEATURE( VIEW_SOURCE )
+	AppendTool( m_tools_menu.get( ), id_view_source, _( "View Source" ), &WebFrame::OnViewSourceRequest );
+#endif
+#if WBA_HAS_FEATURE( VIEW_TEXT )
+	AppendTool( m_tools_menu.get( ), id_view_text, _( "View Text" ), &WebFrame::OnViewTextRequest );
+#endif
 	m_tools_menu->AppendSeparator( );
-	m_tools_layout = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Use Layout Zoom" ) );
-	m_tools_tiny = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Tiny" ) );
-	m_tools_small = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Small" ) );
-	m_tools_medium = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Medium" ) );
-	m_tools_large = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Large" ) );
-	m_tools_largest = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Largest" ) );
+#if WBA_HAS_FEATURE( ZOOM )
+	m_tools_layout = AppendTool( m_tools_menu.get( ), id_zoom_layout, _( "Use Layout Zoom" ), &WebFrame::OnZoomLayout,
+	                             wxITEM_CHECK );
+	m_tools_tiny = AppendTool( m_tools_menu.get( ), id_zoom_tiny, _( "Tiny" ), &WebFrame::OnSetZoom, wxITEM_CHECK );
+	m_tools_small = AppendTool( m_tools_menu.get( ), id_zoom_small, _( "Small" ), &WebFrame::OnSetZoom, wxITEM_CHECK );
+	m_tools_medium =
+	    AppendTool( m_tools_menu.get( ), id_zoom_medium, _( "Medium" ), &WebFrame::OnSetZoom, wxITEM_CHECK );
+	m_tools_large = AppendTool( m_tools_menu.get( ), id_zoom_large, _( "Large" ), &WebFrame::OnSetZoom, wxITEM_CHECK );
+	m_tools_largest =
+	    AppendTool( m_tools_menu.get( ), id_zoom_largest, _( "Largest" ), &WebFrame::OnSetZoom, wxITEM_CHECK );
 	m_tools_menu->AppendSeparator( );
-	m_tools_handle_navigation = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Handle Navigation" ) );
-	m_tools_handle_new_window = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Handle New Windows" ) );
+	if( !m_browser->CanSetZoomType( wxWEBVIEW_ZOOM_TYPE_LAYOUT ) ) {
+		m_tools_layout->Enable( false );
+	}
+#endif
+	// Only read when a navigation or new window arrives
+	m_tools_handle_navigation = AppendTool( m_tools_menu.get( ), id_handle_navigation, _( "Handle Navigation" ),
+	                                        nullptr, wxITEM_CHECK );
+	m_tools_handle_new_window = AppendTool( m_tools_menu.get( ), id_handle_new_window, _( "Handle New Windows" ),
+	                                        nullptr, wxITEM_CHECK );
+	AppendTool( m_tools_menu.get( ), id_new_tab, _( "New Tab" ), &WebFrame::OnNewTab );
+	AppendTool( m_tools_menu.get( ), id_close_tab, _( "Close Tab" ), &WebFrame::OnCloseTab );
 	m_tools_menu->AppendSeparator( );
 
+#if WBA_HAS_FEATURE( SEARCH )
 	// Find
-	m_find = m_tools_menu->Append( wxID_ANY, _( "Find" ) );
+	m_find = AppendTool( m_tools_menu.get( ), id_find, _( "Find" ), &WebFrame::OnFind );
+	AppendTool( m_tools_menu.get( ), id_find_in_pages, _( "Find in Pages..." ), &WebFrame::OnFindInPages );
 	m_tools_menu->AppendSeparator( );
+#endif
 
-	// History menu
+	// History menu.  Entries are inserted between Older and Newer by UpdateHistoryMenu
 	m_tools_history_menu = new wxMenu{};
-	wxMenuItem *clearhist = m_tools_history_menu->Append( wxID_ANY, _( "Clear History" ) );
-	m_tools_enable_history = m_tools_history_menu->AppendCheckItem( wxID_ANY, _( "Enable History" ) );
+	AppendTool( m_tools_history_menu, id_clear_history, _( "Clear History" ), &WebFrame::OnClearHistory );
+	m_tools_enable_history = AppendTool( m_tools_history_menu, id_enable_history, _( "Enable History" ),
+	                                     &WebFrame::OnEnableHistory, wxITEM_CHECK );
 	m_tools_history_menu->AppendSeparator( );
+	m_history_older = m_tools_history_menu->Append( id_history_older, _( "Older..." ) );
+	m_history_slot_pos = m_tools_history_menu->GetMenuItemCount( );
+	m_history_newer = m_tools_history_menu->Append( id_history_newer, _( "Newer..." ) );
+	Bind( wxEVT_MENU, &WebFrame::OnHistory, this, id_history_first, id_history_end - 1 );
+	Bind( wxEVT_MENU, &WebFrame::OnHistoryPage, this, id_history_older, id_history_newer );
 
 	m_tools_menu->AppendSubMenu( m_tools_history_menu, "History" );
 
+#if WBA_HAS_FEATURE( CLIPBOARD ) || WBA_HAS_FEATURE( EDIT ) || WBA_HAS_FEATURE( SELECT )
 	// Create an editing menu
 	wxMenu *editmenu = new wxMenu{};
-	m_edit_cut = editmenu->Append( wxID_ANY, _( "Cut" ) );
-	m_edit_copy = editmenu->Append( wxID_ANY, _( "Copy" ) );
-	m_edit_paste = editmenu->Append( wxID_ANY, _( "Paste" ) );
+#if WBA_HAS_FEATURE( CLIPBOARD ) && WBA_HAS_FEATURE( EDIT )
+	m_edit_cut = AppendTool( editmenu, id_cut, _( "Cut" ), &WebFrame::OnCut );
+#endif
+#if WBA_HAS_FEATURE( CLIPBOARD )
+	m_edit_copy = AppendTool( editmenu, id_copy, _( "Copy" ), &WebFrame::OnCopy );
+#endif
+#if WBA_HAS_FEATURE( CLIPBOARD ) && WBA_HAS_FEATURE( EDIT )
+	m_edit_paste = AppendTool( editmenu, id_paste, _( "Paste" ), &WebFrame::OnPaste );
+#endif
+#if WBA_HAS_FEATURE( EDIT )
 	editmenu->AppendSeparator( );
-	m_edit_undo = editmenu->Append( wxID_ANY, _( "Undo" ) );
-	m_edit_redo = editmenu->Append( wxID_ANY, _( "Redo" ) );
+	m_edit_undo = AppendTool( editmenu, id_undo, _( "Undo" ), &WebFrame::OnUndo );
+	m_edit_redo = AppendTool( editmenu, id_redo, _( "Redo" ), &WebFrame::OnRedo );
 	editmenu->AppendSeparator( );
-	m_edit_mode = editmenu->AppendCheckItem( wxID_ANY, _( "Edit Mode" ) );
+	m_edit_mode = AppendTool( editmenu, id_edit_mode, _( "Edit Mode" ), &WebFrame::OnMode, wxITEM_CHECK );
+#endif
 
 	m_tools_menu->AppendSeparator( );
 	m_tools_menu->AppendSubMenu( editmenu, "Edit" );
+#endif
+
+	auto scroll_menu = std::make_unique<wxMenu>( );
+	m_scroll_line_up = AppendTool( scroll_menu.get( ), id_scroll_line_up, "Line &up", &WebFrame::OnScrollLineUp );
+	m_scroll_line_down =
+	    AppendTool( scroll_menu.get( ), id_scroll_line_down, "Line &down", &WebFrame::OnScrollLineDown );
+	m_scroll_page_up = AppendTool( scroll_menu.get( ), id_scroll_page_up, "Page u&p", &WebFrame::OnScrollPageUp );
+	m_scroll_page_down =
+	    AppendTool( scroll_menu.get( ), id_scroll_page_down, "Page d&own", &WebFrame::OnScrollPageDown );
+	m_tools_menu->AppendSubMenu( scroll_menu.release( ), "Scroll" );
+
+	AppendTool( m_tools_menu.get( ), id_run_script, _( "Run Script" ), &WebFrame::OnRunScript );
+
+#if WBA_HAS_FEATURE( SELECT )
+	// Selection menu
+	auto selection = std::make_unique<wxMenu>( );
+	m_selection_clear =
+	    AppendTool( selection.get( ), id_selection_clear, _( "Clear Selection" ), &WebFrame::OnClearSelection );
+	m_selection_delete =
+	    AppendTool( selection.get( ), id_selection_delete, _( "Delete Selection" ), &WebFrame::OnDeleteSelection );
+	AppendTool( selection.get( ), id_select_all, _( "Select All" ), &WebFrame::OnSelectAll );
+
+	editmenu->AppendSubMenu( selection.release( ), "Selection" );
+#endif
+
+	AppendTool( m_tools_menu.get( ), id_load_scheme, _( "Custom Scheme Example" ), &WebFrame::OnLoadScheme );
+	AppendTool( m_tools_menu.get( ), id_use_memory_fs, _( "Memory File System Example" ), &WebFrame::OnUseMemoryFS );
+
+	m_context_menu = AppendTool( m_tools_menu.get( ), id_context_menu, _( "Enable Context Menu" ),
+	                             &WebFrame::OnEnableContextMenu, wxITEM_CHECK );
+
+	// By default we want to handle navigation and new windows
+	m_tools_handle_navigation->Check( );
+	m_tools_handle_new_window->Check( );
+	m_tools_enable_history->Check( );
+
+	// One dynamic entry for the whole menu, OnToolsMenu dispatches by id
+	Bind( wxEVT_MENU, &WebFrame::OnToolsMenu, this, id_tools_first, id_tools_end - 1 );
+
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now( ) - start;
+		wxLogMessage( "Built tools menu; elapsed=%.3fms", elapsed.count( ) );
+	}
+}
+
+void WebFrame::BuildToolbar( wxSizer *sizer ) {
+	m_toolbar = wxFrame::CreateToolBar( wxTB_TEXT );
+	m_toolbar->SetToolBitmapSize( wxSize{32, 32} );
+
+	auto back = wxArtProvider::GetBitmap( wxART_GO_BACK, wxART_TOOLBAR );
+	auto forward = wxArtProvider::GetBitmap( wxART_GO_FORWARD, wxART_TOOLBAR );
+#ifdef __WXGTK__
+	auto stop = wxArtProvider::GetBitmap( "gtk-stop", wxART_TOOLBAR );
+#else
+	auto stop = wxBitmap( stop_xpm );
+#endif
+#ifdef __WXGTK__
+	auto refresh = wxArtProvider::GetBitmap( "gtk-refresh", wxART_TOOLBAR );
+#else
+	auto refresh = wxBitmap( refresh_xpm );
+#endif
+
+	m_toolbar_back = m_toolbar->AddTool( wxID_ANY, _( "Back" ), back );
+	m_toolbar_forward = m_toolbar->AddTool( wxID_ANY, _( "Forward" ), forward );
+	m_toolbar_stop = m_toolbar->AddTool( wxID_ANY, _( "Stop" ), stop );
+	m_toolbar_reload = m_toolbar->AddTool( wxID_ANY, _( "Reload" ), refresh );
+	m_url = new wxTextCtrl{m_toolbar, wxID_ANY, wxT( "" ), wxDefaultPosition, wxSize{400, -1}, wxTE_PROCESS_ENTER};
+	m_toolbar->AddControl( m_url, _( "URL" ) );
+	if( m_services.url_suggestions != nullptr ) {
+		m_url->AutoComplete( new url_completer_t{m_services.url_suggestions} );
+	}
+	m_toolbar_tools = m_toolbar->AddTool( wxID_ANY, _( "Menu" ), wxBitmap( wxlogo_xpm ) );
+
+	m_toolbar->Realize( );
+
+	Connect( m_toolbar_back->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnBack ), nullptr, this );
+	Connect( m_toolbar_forward->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnForward ), nullptr, this );
+	Connect( m_toolbar_stop->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnStop ), nullptr, this );
+	Connect( m_toolbar_reload->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnReload ), nullptr, this );
+	Connect( m_toolbar_tools->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnToolsClicked ), nullptr,
+	         this );
+
+	Connect( m_url->GetId( ), wxEVT_TEXT_ENTER, wxCommandEventHandler( WebFrame::OnUrl ), nullptr, this );
+
+	// Create panel for find toolbar.  It stays empty without search so that
+	// ApplyConfig can treat both the same
+	m_find_panel = new wxPanel{this};
+	sizer->Insert( 0, m_find_panel, wxSizerFlags( ).Expand( ) );
+
+	// Create sizer for panel.
+	auto panel_sizer = new wxBoxSizer{wxVERTICAL};
+	m_find_panel->SetSizer( panel_sizer );
+
+#if WBA_HAS_FEATURE( SEARCH )
+	// Create the find toolbar.
+	m_find_toolbar = new wxToolBar{m_find_panel, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+	                               wxTB_HORIZONTAL | wxTB_TEXT | wxTB_HORZ_LAYOUT};
+	m_find_toolbar->Hide( );
+	panel_sizer->Add( m_find_toolbar, wxSizerFlags( ).Expand( ) );
+
+	// Create find control.
+	m_find_ctrl = new wxTextCtrl{m_find_toolbar,    wxID_ANY,        wxEmptyString,
+	                             wxDefaultPosition, wxSize{140, -1}, wxTE_PROCESS_ENTER};
+
+	// Find options menu
+	auto findmenu = std::make_unique<wxMenu>( );
+	m_find_toolbar_wrap = findmenu->AppendCheckItem( wxID_ANY, "Wrap" );
+	m_find_toolbar_matchcase = findmenu->AppendCheckItem( wxID_ANY, "Match Case" );
+	m_find_toolbar_wholeword = findmenu->AppendCheckItem( wxID_ANY, "Entire Word" );
+	m_find_toolbar_highlight = findmenu->AppendCheckItem( wxID_ANY, "Highlight" );
+	// Add find toolbar tools.
+	m_find_toolbar->SetToolSeparation( 7 );
+	m_find_toolbar_done =
+	    m_find_toolbar->AddTool( wxID_ANY, "Close", wxArtProvider::GetBitmap( wxART_CROSS_MARK ) );
+	m_find_toolbar->AddSeparator( );
+	m_find_toolbar->AddControl( m_find_ctrl, "Find" );
+	m_find_toolbar->AddSeparator( );
+	m_find_toolbar_next = m_find_toolbar->AddTool(
+	    wxID_ANY, "Next", wxArtProvider::GetBitmap( wxART_GO_DOWN, wxART_TOOLBAR, wxSize{16, 16} ) );
+	m_find_toolbar_previous = m_find_toolbar->AddTool(
+	    wxID_ANY, "Previous", wxArtProvider::GetBitmap( wxART_GO_UP, wxART_TOOLBAR, wxSize{16, 16} ) );
+	m_find_toolbar->AddSeparator( );
+	m_find_toolbar_options = m_find_toolbar->AddTool(
+	    wxID_ANY, "Options", wxArtProvider::GetBitmap( wxART_PLUS, wxART_TOOLBAR, wxSize{16, 16} ), "",
+	    wxITEM_DROPDOWN );
+	m_find_toolbar_options->SetDropdownMenu( findmenu.release( ) );
+	m_find_toolbar->Realize( );
+
+	// Connect find toolbar events.
+	Connect( m_find_toolbar_done->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindDone ), nullptr,
+	         this );
+	Connect( m_find_toolbar_next->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
+	         this );
+	Connect( m_find_toolbar_previous->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
+	         this );
+
+	// Connect find control events.
+	Connect( m_find_ctrl->GetId( ), wxEVT_TEXT, wxCommandEventHandler( WebFrame::OnFindTextChanged ), nullptr,
+	         this );
+	Bind( wxEVT_TIMER, &WebFrame::OnFindTimer, this, m_find_timer.GetId( ) );
+	Connect( m_find_ctrl->GetId( ), wxEVT_TEXT_ENTER, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
+	         this );
+#endif
+}
+#endif
+
+bool WebFrame::HasToolbar( ) const {
+#if WBA_HAS_FEATURE( TOOLBAR )
+	return m_toolbar != nullptr && is_enabled( features::toolbar, m_app_config->enable_toolbar );
+#else
+	return false;
+#endif
+}
+
+void WebFrame::ApplyConfig( std::shared_ptr<config_t const> app_config ) {
+	m_app_config = std::move( app_config );
+
+#if WBA_HAS_FEATURE( TOOLBAR )
+	if( is_enabled( features::toolbar, m_app_config->enable_toolbar ) && m_toolbar == nullptr ) {
+		BuildToolbar( GetSizer( ) );
+		// Fresh tools are enabled, make UpdateState push the real values
+		m_ui_state.can_go_back = true;
+		m_ui_state.can_go_forward = true;
+		m_ui_state.url.clear( );
+		m_toolbar->EnableTool( m_toolbar_stop->GetId( ), m_ui_state.is_busy );
+	} else if( m_toolbar != nullptr ) {
+		auto const show_toolbar = is_enabled( features::toolbar, m_app_config->enable_toolbar );
+		m_toolbar->Show( show_toolbar );
+		m_find_panel->Show( show_toolbar );
+		if( show_toolbar ) {
+			// The url may have changed while the toolbar was hidden
+			m_ui_state.url.clear( );
+			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), m_ui_state.is_busy );
+		}
+	}
+#endif
+
+#if WBA_HAS_FEATURE( DEBUG_WINDOW )
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		if( m_log_window == nullptr ) {
+			m_log_window = new wxLogWindow{this, _( "Logging" ), true, false};
+		} else {
+			m_log_window->Show( true );
+		}
+	} else if( m_log_window != nullptr ) {
+		m_log_window->Show( false );
+	}
+#endif
+
+	if( !is_enabled( features::title_change, m_app_config->enable_title_change ) ) {
+		m_ui_state.title.clear( );
+		SetTitle( m_app_config->app_title.c_str( ) );
+	}
+
+	SendSizeEvent( );
+	UpdateState( );
+}
+
+WebFrame::~WebFrame( ) {
+	// Join the policy workers and the find worker before any member they may call back into goes away
+	m_nav_policy.reset( );
+	m_find_engine.reset( );
+}
+
+void WebFrame::UpdateState( ) {
+	SetBusy( m_browser->IsBusy( ) );
+
+	if( HasToolbar( ) ) {
+		auto const can_go_back = m_browser->CanGoBack( );
+		if( can_go_back != m_ui_state.can_go_back ) {
+			m_ui_state.can_go_back = can_go_back;
+			m_toolbar->EnableTool( m_toolbar_back->GetId( ), can_go_back );
+		}
+		auto const can_go_forward = m_browser->CanGoForward( );
+		if( can_go_forward != m_ui_state.can_go_forward ) {
+			m_ui_state.can_go_forward = can_go_forward;
+			m_toolbar->EnableTool( m_toolbar_forward->GetId( ), can_go_forward );
+		}
+		auto url = m_browser->GetCurrentURL( );
+		if( url != m_ui_state.url ) {
+			m_ui_state.url = std::move( url );
+			// ChangeValue does not emit wxEVT_TEXT
+			m_url->ChangeValue( m_ui_state.url );
+		}
+	}
+	if( is_enabled( features::title_change, m_app_config->enable_title_change ) ) {
+		auto title = m_browser->GetCurrentTitle( );
+		if( title != m_ui_state.title ) {
+			m_ui_state.title = std::move( title );
+			SetTitle( m_ui_state.title );
+		}
+	}
+}
+
+void WebFrame::SetBusy( bool is_busy ) {
+	if( is_busy == m_ui_state.is_busy ) {
+		return;
+	}
+	m_ui_state.is_busy = is_busy;
+	wxSetCursor( is_busy ? wxCursor{wxCURSOR_ARROWWAIT} : wxNullCursor );
+	if( HasToolbar( ) ) {
+		m_toolbar->EnableTool( m_toolbar_stop->GetId( ), is_busy );
+	}
+}
+
+void WebFrame::RunTitleProbe( wxWebView &view, wxString const &expression, title_probe_handler_t on_result ) {
+	auto const id = ++m_title_probe_count;
+	m_title_probes.push_back(
+	    title_probe_t{id, &view, std::chrono::steady_clock::now( ) + title_probe_timeout, std::move( on_result )} );
+	auto const prefix = wxString::Format( "%s%llu:", title_probe_prefix, static_cast<unsigned long long>( id ) );
+	view.RunScript( "if(!('wbaTitle' in window)){window.wbaTitle=document.title;}document.title='" + prefix +
+	                "'+String(" + expression + ");" );
+	// Backends that run the script at once may not raise a title change for it
+	CompleteTitleProbe( &view, view.GetCurrentTitle( ) );
+}
+
+bool WebFrame::CompleteTitleProbe( wxWebView *view, wxString const &title ) {
+	wxString rest;
+	if( view == nullptr || !title.StartsWith( title_probe_prefix, &rest ) ) {
+		return false;
+	}
+	unsigned long long id = 0;
+	if( !rest.BeforeFirst( ':' ).ToULongLong( &id ) ) {
+		return false;
+	}
+	auto const pos = std::find_if( m_title_probes.begin( ), m_title_probes.end( ), [&]( title_probe_t const &probe ) {
+		return probe.id == id && probe.view == view;
+	} );
+	// Not found when already answered by a timeout, the title still has to go back
+	if( pos != m_title_probes.end( ) ) {
+		auto on_result = std::move( pos->on_result );
+		m_title_probes.erase( pos );
+		// Never from inside the webview's own event or script call
+		boost::optional<wxString> value{rest.AfterFirst( ':' )};
+		CallAfter( [on_result, value]( ) { on_result( value ); } );
+	}
+	auto const is_last = std::none_of( m_title_probes.begin( ), m_title_probes.end( ),
+	                                   [view]( title_probe_t const &probe ) { return probe.view == view; } );
+	if( is_last ) {
+		view->RunScript( title_restore_script );
+	}
+	return true;
+}
+
+void WebFrame::DropTitleProbes( wxWebView const *view ) {
+	auto const pos = std::stable_partition( m_title_probes.begin( ), m_title_probes.end( ),
+	                                        [view]( title_probe_t const &probe ) { return probe.view != view; } );
+	for( auto it = pos; it != m_title_probes.end( ); ++it ) {
+		auto on_result = std::move( it->on_result );
+		CallAfter( [on_result]( ) { on_result( boost::none ); } );
+	}
+	m_title_probes.erase( pos, m_title_probes.end( ) );
+}
 
-	auto scroll_menu = std::make_unique<wxMenu>( );
-	m_scroll_line_up = scroll_menu->Append( wxID_ANY, "Line &up" );
-	m_scroll_line_down = scroll_menu->Append( wxID_ANY, "Line &down" );
-	m_scroll_page_up = scroll_menu->Append( wxID_ANY, "Page u&p" );
-	m_scroll_page_down = scroll_menu->Append( wxID_ANY, "Page d&own" );
-	m_tools_menu->AppendSubMenu( scroll_menu.release( ), "Scroll" );
+void WebFrame::ExpireTitleProbes( ) {
+	auto const now = std::chrono::steady_clock::now( );
+	std::vector<wxWebView *> views;
+	for( auto const &probe : m_title_probes ) {
+		if( now > probe.deadline && std::find( views.begin( ), views.end( ), probe.view ) == views.end( ) ) {
+			views.push_back( probe.view );
+		}
+	}
+	for( auto const view : views ) {
+		// The page may still report later, CompleteTitleProbe puts its title back then
+		auto const pos = std::stable_partition( m_title_probes.begin( ), m_title_probes.end( ),
+		                                        [&]( title_probe_t const &probe ) {
+			                                        return probe.view != view || now <= probe.deadline;
+		                                        } );
+		for( auto it = pos; it != m_title_probes.end( ); ++it ) {
+			auto on_result = std::move( it->on_result );
+			CallAfter( [on_result]( ) { on_result( boost::none ); } );
+		}
+		m_title_probes.erase( pos, m_title_probes.end( ) );
+	}
+}
 
-	auto *script = m_tools_menu->Append( wxID_ANY, _( "Run Script" ) );
+void WebFrame::OnStateTimer( wxTimerEvent &WXUNUSED( evt ) ) {
+	UpdateState( );
+	ExpireTitleProbes( );
+	GovernTabs( );
+	if( !m_automation_jobs.empty( ) && m_automation_jobs.front( ).deadline &&
+	    std::chrono::steady_clock::now( ) > *m_automation_jobs.front( ).deadline ) {
+		// Off the queue first, so the error Stop may raise is not taken for its answer
+		auto job = std::move( m_automation_jobs.front( ) );
+		m_automation_jobs.pop_front( );
+		m_browser->Stop( );
+		job.reply( make_automation_error( job.request.id, "Timed out loading; url='" + job.request.argument + "'" ) );
+		RunAutomationJobs( );
+	}
+}
 
-	// Selection menu
-	auto selection = std::make_unique<wxMenu>( );
-	m_selection_clear = selection->Append( wxID_ANY, _( "Clear Selection" ) );
-	m_selection_delete = selection->Append( wxID_ANY, _( "Delete Selection" ) );
-	auto *selectall = selection->Append( wxID_ANY, _( "Select All" ) );
+void WebFrame::OnUrl( wxCommandEvent &WXUNUSED( evt ) ) {
+	RequestNavigation( m_url->GetValue( ).ToStdString( ) );
+}
 
-	editmenu->AppendSubMenu( selection.release( ), "Selection" );
+void WebFrame::RequestNavigation( std::string url ) {
+	auto const is_allowed = m_app_config->fast_url_verdict( get_page_cache_target( url ) );
+	if( !is_allowed ) {
+		SubmitPolicyCheck( std::move( url ) );
+	} else if( *is_allowed ) {
+		LoadApprovedURL( url );
+	}
+}
 
-	auto *loadscheme = m_tools_menu->Append( wxID_ANY, _( "Custom Scheme Example" ) );
-	auto *usememoryfs = m_tools_menu->Append( wxID_ANY, _( "Memory File System Example" ) );
+void WebFrame::SubmitPolicyCheck( std::string url ) {
+	auto const generation = ++m_nav_generation;
+	auto config = m_app_config;
+	// A cache: url is decided as the url it serves, but resumed as itself
+	auto on_verdict = [this, generation, config, url]( std::string, bool is_allowed ) {
+		CallAfter( [this, generation, config, url, is_allowed]( ) {
+			OnPolicyVerdict( generation, config, url, is_allowed );
+		} );
+	};
+	m_nav_policy->submit( config, get_page_cache_target( url ), std::move( on_verdict ) );
+}
 
-	m_context_menu = m_tools_menu->AppendCheckItem( wxID_ANY, _( "Enable Context Menu" ) );
+void WebFrame::OnPolicyVerdict( uint64_t generation, std::shared_ptr<config_t const> const &config,
+                                std::string const &url, bool is_allowed ) {
+	if( generation != m_nav_generation ) {
+		// A newer navigation superseded this one
+		return;
+	}
+	if( config != m_app_config ) {
+		// The config was reloaded while the check ran, decide again under the new one
+		RequestNavigation( url );
+		return;
+	}
+	if( !is_allowed ) {
+		if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+			wxLogMessage( "%s", "Navigation denied; url='" + url + "'" );
+		}
+		return;
+	}
+	LoadApprovedURL( url );
+}
 
-	// By default we want to handle navigation and new windows
-	m_tools_handle_navigation->Check( );
-	m_tools_handle_new_window->Check( );
-	m_tools_enable_history->Check( );
+void WebFrame::SubmitOwnershipCheck( std::string url ) {
+	auto const generation = ++m_nav_generation;
+	auto const link = m_services.supervisor_link;
+	auto decide = [link]( std::string const &target ) { return link->is_own_url( target ); };
+	auto on_verdict = [this, generation, url]( std::string, bool is_own ) {
+		CallAfter( [this, generation, url, is_own]( ) { OnOwnershipVerdict( generation, url, is_own ); } );
+	};
+	m_nav_policy->submit( navigation_policy_t::decide_t{std::move( decide )}, get_page_cache_target( url ),
+	                      std::move( on_verdict ) );
+}
 
-	if( !m_browser->CanSetZoomType( wxWEBVIEW_ZOOM_TYPE_LAYOUT ) ) {
-		m_tools_layout->Enable( false );
+void WebFrame::OnOwnershipVerdict( uint64_t generation, std::string const &url, bool is_own ) {
+	if( generation != m_nav_generation ) {
+		// A newer navigation superseded this one
+		return;
+	}
+	if( !is_own ) {
+		SetBusy( false );
+		m_services.supervisor_link->hand_off( url );
+		return;
 	}
+	m_owned_url = url;
+	RequestNavigation( url );
+}
 
-	// Connect the toolbar events
-	if( m_app_config->enable_toolbar ) {
-		Connect( m_toolbar_back->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnBack ), nullptr, this );
-		Connect( m_toolbar_forward->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnForward ), nullptr, this );
-		Connect( m_toolbar_stop->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnStop ), nullptr, this );
-		Connect( m_toolbar_reload->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnReload ), nullptr, this );
-		Connect( m_toolbar_tools->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnToolsClicked ), nullptr,
-		         this );
-
-		Connect( m_url->GetId( ), wxEVT_TEXT_ENTER, wxCommandEventHandler( WebFrame::OnUrl ), nullptr, this );
-
-		// Connect find toolbar events.
-		Connect( m_find_toolbar_done->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindDone ), nullptr,
-		         this );
-		Connect( m_find_toolbar_next->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
-		         this );
-		Connect( m_find_toolbar_previous->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
-		         this );
-
-		// Connect find control events.
-		Connect( m_find_ctrl->GetId( ), wxEVT_TEXT, wxCommandEventHandler( WebFrame::OnFindText ), nullptr, this );
-		Connect( m_find_ctrl->GetId( ), wxEVT_TEXT_ENTER, wxCommandEventHandler( WebFrame::OnFindText ), nullptr,
-		         this );
-	}
-	// Connect the webview events
-	Connect( m_browser->GetId( ), wxEVT_WEBVIEW_NAVIGATING, wxWebViewEventHandler( WebFrame::OnNavigationRequest ),
-	         nullptr, this );
-	Connect( m_browser->GetId( ), wxEVT_WEBVIEW_NAVIGATED, wxWebViewEventHandler( WebFrame::OnNavigationComplete ),
-	         nullptr, this );
-	Connect( m_browser->GetId( ), wxEVT_WEBVIEW_LOADED, wxWebViewEventHandler( WebFrame::OnDocumentLoaded ), nullptr,
-	         this );
-	Connect( m_browser->GetId( ), wxEVT_WEBVIEW_ERROR, wxWebViewEventHandler( WebFrame::OnError ), nullptr, this );
-	Connect( m_browser->GetId( ), wxEVT_WEBVIEW_NEWWINDOW, wxWebViewEventHandler( WebFrame::OnNewWindow ), nullptr,
-	         this );
-	if( m_app_config->enable_title_change ) {
-		Connect( m_browser->GetId( ), wxEVT_WEBVIEW_TITLE_CHANGED, wxWebViewEventHandler( WebFrame::OnTitleChanged ),
-		         nullptr, this );
-	}
-
-	if( m_app_config->enable_toolbar ) {
-		// Connect the menu events
-		Connect( viewSource->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnViewSourceRequest ), nullptr,
-		         this );
-		Connect( viewText->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnViewTextRequest ), nullptr, this );
-		Connect( print->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnPrint ), nullptr, this );
-		Connect( m_tools_layout->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnZoomLayout ), nullptr, this );
-		Connect( m_tools_tiny->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSetZoom ), nullptr, this );
-		Connect( m_tools_small->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSetZoom ), nullptr, this );
-		Connect( m_tools_medium->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSetZoom ), nullptr, this );
-		Connect( m_tools_large->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSetZoom ), nullptr, this );
-		Connect( m_tools_largest->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSetZoom ), nullptr, this );
-		Connect( clearhist->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnClearHistory ), nullptr, this );
-		Connect( m_tools_enable_history->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnEnableHistory ),
-		         nullptr, this );
-		Connect( m_edit_cut->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnCut ), nullptr, this );
-		Connect( m_edit_copy->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnCopy ), nullptr, this );
-		Connect( m_edit_paste->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnPaste ), nullptr, this );
-		Connect( m_edit_undo->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnUndo ), nullptr, this );
-		Connect( m_edit_redo->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnRedo ), nullptr, this );
-		Connect( m_edit_mode->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnMode ), nullptr, this );
-		Connect( m_scroll_line_up->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnScrollLineUp ), nullptr,
-		         this );
-		Connect( m_scroll_line_down->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnScrollLineDown ), nullptr,
-		         this );
-		Connect( m_scroll_page_up->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnScrollPageUp ), nullptr,
-		         this );
-		Connect( m_scroll_page_down->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnScrollPageDown ), nullptr,
-		         this );
-		Connect( script->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnRunScript ), nullptr, this );
-		Connect( m_selection_clear->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnClearSelection ), nullptr,
-		         this );
-		Connect( m_selection_delete->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnDeleteSelection ),
-		         nullptr, this );
-		Connect( selectall->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnSelectAll ), nullptr, this );
-		Connect( loadscheme->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnLoadScheme ), nullptr, this );
-		Connect( usememoryfs->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnUseMemoryFS ), nullptr, this );
-		Connect( m_find->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnFind ), nullptr, this );
-		Connect( m_context_menu->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnEnableContextMenu ), nullptr,
-		         this );
-	}
-	// Connect the idle events
-	Connect( wxID_ANY, wxEVT_IDLE, wxIdleEventHandler( WebFrame::OnIdle ), nullptr, this );
-}
-
-WebFrame::~WebFrame( ) {}
+void WebFrame::Navigate( std::string const &url ) {
+	RequestNavigation( url );
+	Raise( );
+}
 
-void WebFrame::UpdateState( ) {
-	if( m_app_config->enable_toolbar ) {
-		m_toolbar->EnableTool( m_toolbar_back->GetId( ), m_browser->CanGoBack( ) );
-		m_toolbar->EnableTool( m_toolbar_forward->GetId( ), m_browser->CanGoForward( ) );
+std::vector<std::shared_ptr<page_text_t const>> WebFrame::GetPageTexts( ) const {
+	return m_page_texts.values( );
+}
+
+void WebFrame::RunAutomation( automation_request_t request, automation_reply_t reply ) {
+	m_automation_jobs.push_back( automation_job_t{std::move( request ), std::move( reply ), boost::none, false} );
+	if( m_automation_jobs.size( ) == 1 ) {
+		RunAutomationJobs( );
+	}
+}
 
-		if( m_browser->IsBusy( ) ) {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), true );
+void WebFrame::RunAutomationJobs( ) {
+	while( !m_automation_jobs.empty( ) ) {
+		auto &job = m_automation_jobs.front( );
+		if( job.deadline || job.is_running_script ) {
+			// Waiting for its page or its script
+			return;
+		}
+		auto const id = job.request.id;
+		auto const command = parse_automation_command( job.request.command );
+		if( !command ) {
+			job.reply( make_automation_error( id, "Unknown command; command='" + job.request.command + "'" ) );
+		} else if( *command == automation_command_t::navigate ) {
+			// Decided here rather than on the policy workers so a denial can be answered
+			auto const url = job.request.argument;
+			if( !m_app_config->is_valid_url( get_page_cache_target( url ) ) ) {
+				job.reply( make_automation_error( id, "Navigation denied; url='" + url + "'" ) );
+			} else {
+				job.deadline = std::chrono::steady_clock::now( ) + automation_navigation_timeout;
+				// May finish the job before returning
+				LoadApprovedURL( url );
+				return;
+			}
+		} else if( *command == automation_command_t::run_script ) {
+			job.is_running_script = true;
+			RunTitleProbe( *m_browser, make_script_expression( wxString::FromUTF8( job.request.argument.c_str( ) ) ),
+			               [this]( boost::optional<wxString> value ) { FinishAutomationScript( value ); } );
+			return;
 		} else {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), false );
+			job.reply( RunAutomationCommand( *command, job.request ) );
 		}
-		m_url->SetValue( m_browser->GetCurrentURL( ) );
-	}
-	if( m_app_config->enable_title_change ) {
-		SetTitle( m_browser->GetCurrentTitle( ) );
+		m_automation_jobs.pop_front( );
 	}
 }
 
-void WebFrame::OnIdle( wxIdleEvent &WXUNUSED( evt ) ) {
-	if( m_browser->IsBusy( ) ) {
-		wxSetCursor( wxCURSOR_ARROWWAIT );
-		if( m_app_config->enable_toolbar ) {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), true );
+automation_response_t WebFrame::RunAutomationCommand( automation_command_t command,
+                                                      automation_request_t const &request ) {
+	auto const id = request.id;
+	auto const argument = wxString::FromUTF8( request.argument.c_str( ) );
+	switch( command ) {
+	case automation_command_t::get_page_source:
+		if( !is_enabled( features::view_source, m_app_config->enable_view_source ) ) {
+			return make_automation_error( id, "View source is disabled" );
 		}
-	} else {
-		wxSetCursor( wxNullCursor );
-		if( m_app_config->enable_toolbar ) {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), false );
+		return make_automation_result( id, to_utf8( m_browser->GetPageSource( ) ) );
+	case automation_command_t::get_page_text:
+		if( !is_enabled( features::view_text, m_app_config->enable_view_text ) ) {
+			return make_automation_error( id, "View text is disabled" );
+		}
+		return make_automation_result( id, to_utf8( m_browser->GetPageText( ) ) );
+	case automation_command_t::find: {
+		if( !is_enabled( features::search, m_app_config->enable_search ) ) {
+			return make_automation_error( id, "Search is disabled" );
+		}
+		// A new search, so the count covers the whole page
+		m_browser->Find( "" );
+		auto const count = m_browser->Find( argument, wxWEBVIEW_FIND_WRAP );
+		return make_automation_result( id, std::to_string( count == wxNOT_FOUND ? 0 : count ) );
+	}
+	case automation_command_t::set_zoom: {
+		if( !is_enabled( features::zoom, m_app_config->enable_zoom ) ) {
+			return make_automation_error( id, "Zoom is disabled" );
+		}
+		auto const zoom = parse_zoom( request.argument );
+		if( !zoom ) {
+			return make_automation_error( id, "Unknown zoom; zoom='" + request.argument + "'" );
 		}
+		m_browser->SetZoom( *zoom );
+		return make_automation_result( id, request.argument );
 	}
+	case automation_command_t::get_navigation_timing:
+		if( m_services.navigation_timing == nullptr ) {
+			return make_automation_error( id, "Navigation timing is unavailable" );
+		}
+		return make_automation_result( id, m_services.navigation_timing->snapshot( ).to_json_string( ) );
+	case automation_command_t::navigate:
+	case automation_command_t::run_script:
+		break;
+	}
+	return make_automation_error( id, "Command must be queued; command='" + request.command + "'" );
 }
 
-void WebFrame::OnUrl( wxCommandEvent &WXUNUSED( evt ) ) {
-	auto const url = m_url->GetValue( ).ToStdString( );
-	if( !m_app_config->is_valid_url( url ) ) {
+void WebFrame::FinishAutomationNavigation( bool is_ok, std::string message ) {
+	if( m_automation_jobs.empty( ) || !m_automation_jobs.front( ).deadline ) {
 		return;
 	}
-	m_browser->LoadURL( m_url->GetValue( ) );
+	auto job = std::move( m_automation_jobs.front( ) );
+	m_automation_jobs.pop_front( );
+	job.reply( is_ok ? make_automation_result( job.request.id, std::move( message ) )
+	                 : make_automation_error( job.request.id, std::move( message ) ) );
+	RunAutomationJobs( );
+}
+
+void WebFrame::FinishAutomationScript( boost::optional<wxString> const &value ) {
+	if( m_automation_jobs.empty( ) || !m_automation_jobs.front( ).is_running_script ) {
+		return;
+	}
+	auto job = std::move( m_automation_jobs.front( ) );
+	m_automation_jobs.pop_front( );
+	job.reply( make_script_response( job.request.id, value ) );
+	RunAutomationJobs( );
+}
+
+void WebFrame::LoadApprovedURL( std::string const &url ) {
+	m_approved_url = url;
+	m_browser->LoadURL( url );
 	m_browser->SetFocus( );
 	UpdateState( );
 }
 
 void WebFrame::OnBack( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_navigation ) {
+	if( !is_enabled( features::navigation, m_app_config->enable_navigation ) ) {
 		return;
 	}
 	m_browser->GoBack( );
@@ -452,7 +2151,7 @@ void WebFrame::OnBack( wxCommandEvent &WXUNUSED( evt ) ) {
 }
 
 void WebFrame::OnForward( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_navigation ) {
+	if( !is_enabled( features::navigation, m_app_config->enable_navigation ) ) {
 		return;
 	}
 	m_browser->GoForward( );
@@ -465,7 +2164,7 @@ void WebFrame::OnStop( wxCommandEvent &WXUNUSED( evt ) ) {
 }
 
 void WebFrame::OnReload( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_reload ) {
+	if( !is_enabled( features::reload, m_app_config->enable_reload ) ) {
 		return;
 	}
 	m_browser->Reload( );
@@ -474,6 +2173,12 @@ void WebFrame::OnReload( wxCommandEvent &WXUNUSED( evt ) ) {
 
 void WebFrame::OnClearHistory( wxCommandEvent &WXUNUSED( evt ) ) {
 	m_browser->ClearHistory( );
+	if( m_services.history_store != nullptr ) {
+		m_services.history_store->clear( );
+	}
+	if( m_services.url_suggestions != nullptr ) {
+		m_services.url_suggestions->clear( );
+	}
 	UpdateState( );
 }
 
@@ -482,47 +2187,57 @@ void WebFrame::OnEnableHistory( wxCommandEvent &WXUNUSED( evt ) ) {
 	UpdateState( );
 }
 
+#if WBA_HAS_FEATURE( CLIPBOARD ) && WBA_HAS_FEATURE( EDIT )
 void WebFrame::OnCut( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_clipboard || !m_app_config->enable_edit ) {
+	if( !is_enabled( features::clipboard, m_app_config->enable_clipboard ) ||
+	    !is_enabled( features::edit, m_app_config->enable_edit ) ) {
 		return;
 	}
 	m_browser->Cut( );
 }
+#endif
 
+#if WBA_HAS_FEATURE( CLIPBOARD )
 void WebFrame::OnCopy( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_clipboard ) {
+	if( !is_enabled( features::clipboard, m_app_config->enable_clipboard ) ) {
 		return;
 	}
 	m_browser->Copy( );
 }
+#endif
 
+#if WBA_HAS_FEATURE( CLIPBOARD ) && WBA_HAS_FEATURE( EDIT )
 void WebFrame::OnPaste( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_clipboard || !m_app_config->enable_edit ) {
+	if( !is_enabled( features::clipboard, m_app_config->enable_clipboard ) ||
+	    !is_enabled( features::edit, m_app_config->enable_edit ) ) {
 		return;
 	}
 	m_browser->Paste( );
 }
+#endif
 
+#if WBA_HAS_FEATURE( EDIT )
 void WebFrame::OnUndo( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_edit ) {
+	if( !is_enabled( features::edit, m_app_config->enable_edit ) ) {
 		return;
 	}
 	m_browser->Undo( );
 }
 
 void WebFrame::OnRedo( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_edit ) {
+	if( !is_enabled( features::edit, m_app_config->enable_edit ) ) {
 		return;
 	}
 	m_browser->Redo( );
 }
 
 void WebFrame::OnMode( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_edit ) {
+	if( !is_enabled( features::edit, m_app_config->enable_edit ) ) {
 		return;
 	}
 	m_browser->SetEditable( m_edit_mode->IsChecked( ) );
 }
+#endif
 
 void WebFrame::OnLoadScheme( wxCommandEvent &WXUNUSED( evt ) ) {
 	wxFileName helpfile{"../help/doc.zip"};
@@ -530,7 +2245,7 @@ void WebFrame::OnLoadScheme( wxCommandEvent &WXUNUSED( evt ) ) {
 	wxString path = helpfile.GetFullPath( );
 	// Under MSW we need to flip the slashes
 	path.Replace( "\\", "/" );
-	path = "wxfs:///" + path + ";protocol=zip/doc.htm";
+	path = "zip:///" + path + zip_member_separator + "doc.htm";
 	m_browser->LoadURL( path );
 }
 
@@ -542,65 +2257,46 @@ void WebFrame::OnEnableContextMenu( wxCommandEvent &evt ) {
 	m_browser->EnableContextMenu( evt.IsChecked( ) );
 }
 
+#if WBA_HAS_FEATURE( SEARCH )
 void WebFrame::OnFind( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_search ) {
+	// The find control lives on the toolbar
+	if( !is_enabled( features::search, m_app_config->enable_search ) || !HasToolbar( ) ) {
 		return;
 	}
 	auto value = m_browser->GetSelectedText( );
 	if( value.Len( ) > 150 ) {
 		value.Truncate( 150 );
 	}
+	// The page may have changed since the last search
+	InvalidateFindSnapshot( );
 	m_find_ctrl->SetValue( value );
-	if( m_app_config->enable_toolbar ) {
-		if( !m_find_toolbar->IsShown( ) ) {
-			m_find_toolbar->Show( true );
-			SendSizeEvent( );
-		}
-		m_find_ctrl->SelectAll( );
+	if( !m_find_toolbar->IsShown( ) ) {
+		m_find_toolbar->Show( true );
+		SendSizeEvent( );
 	}
+	m_find_ctrl->SelectAll( );
 }
 
 void WebFrame::OnFindDone( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_search ) {
+	if( !is_enabled( features::search, m_app_config->enable_search ) ) {
 		return;
 	}
 	m_browser->Find( "" );
-	if( m_app_config->enable_toolbar ) {
+	if( HasToolbar( ) ) {
 		m_find_toolbar->Show( false );
 	}
 	SendSizeEvent( );
 }
 
 void WebFrame::OnFindText( wxCommandEvent &evt ) {
-	if( !m_app_config->enable_search ) {
+	if( !is_enabled( features::search, m_app_config->enable_search ) || !HasToolbar( ) ) {
 		return;
 	}
-	int flags = 0;
-
-	if( m_app_config->enable_toolbar ) {
-		if( m_find_toolbar_wrap->IsChecked( ) ) {
-			flags |= wxWEBVIEW_FIND_WRAP;
-		}
-
-		if( m_find_toolbar_wholeword->IsChecked( ) ) {
-			flags |= wxWEBVIEW_FIND_ENTIRE_WORD;
-		}
-
-		if( m_find_toolbar_matchcase->IsChecked( ) ) {
-			flags |= wxWEBVIEW_FIND_MATCH_CASE;
-		}
-
-		if( m_find_toolbar_highlight->IsChecked( ) ) {
-			flags |= wxWEBVIEW_FIND_HIGHLIGHT_RESULT;
-		}
-
-		if( m_find_toolbar_previous->GetId( ) == evt.GetId( ) ) {
-			flags |= wxWEBVIEW_FIND_BACKWARDS;
-		}
-	}
-
+	// Stepping through matches, a search still pending for the typed text is not needed
+	m_find_timer.Stop( );
+	++m_find_generation;
 	wxString find_text = m_find_ctrl->GetValue( );
-	auto count = m_browser->Find( find_text, flags );
+	auto count = m_browser->Find( find_text, GetFindFlags( m_find_toolbar_previous->GetId( ) == evt.GetId( ) ) );
 
 	if( m_findText != find_text ) {
 		m_findCount = static_cast<int>( count );
@@ -619,116 +2315,382 @@ void WebFrame::OnFindText( wxCommandEvent &evt ) {
 	if( count != m_findCount ) {
 		count++;
 	}
-	if( m_app_config->enable_debug_window ) {
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "Searching for:%s  current match:%i/%i", m_findText.c_str( ), count, m_findCount );
 	}
 }
 
+int WebFrame::GetFindFlags( bool is_backwards ) const {
+	int flags = 0;
+
+	if( m_find_toolbar_wrap->IsChecked( ) ) {
+		flags |= wxWEBVIEW_FIND_WRAP;
+	}
+
+	if( m_find_toolbar_wholeword->IsChecked( ) ) {
+		flags |= wxWEBVIEW_FIND_ENTIRE_WORD;
+	}
+
+	if( m_find_toolbar_matchcase->IsChecked( ) ) {
+		flags |= wxWEBVIEW_FIND_MATCH_CASE;
+	}
+
+	if( m_find_toolbar_highlight->IsChecked( ) ) {
+		flags |= wxWEBVIEW_FIND_HIGHLIGHT_RESULT;
+	}
+
+	if( is_backwards ) {
+		flags |= wxWEBVIEW_FIND_BACKWARDS;
+	}
+	return flags;
+}
+
+void WebFrame::OnFindTextChanged( wxCommandEvent &WXUNUSED( evt ) ) {
+	if( !is_enabled( features::search, m_app_config->enable_search ) || !HasToolbar( ) ) {
+		return;
+	}
+	// Restarted by each keystroke, the search runs once typing pauses
+	m_find_timer.Start( find_debounce_ms, wxTIMER_ONE_SHOT );
+}
+
+void WebFrame::OnFindTimer( wxTimerEvent &WXUNUSED( evt ) ) {
+	if( !HasToolbar( ) ) {
+		return;
+	}
+	auto const generation = ++m_find_generation;
+	auto const find_text = m_find_ctrl->GetValue( );
+	if( find_text.IsEmpty( ) ) {
+		m_browser->Find( "" );
+		m_findText.clear( );
+		m_findCount = 0;
+		m_find_ctrl->SetBackgroundColour( *wxWHITE );
+		m_find_ctrl->Refresh( );
+		return;
+	}
+	if( !m_find_engine ) {
+		m_find_engine = std::make_unique<find_engine_t>( );
+	}
+	if( m_is_find_snapshot_stale ) {
+		m_find_engine->set_text( to_utf8( m_browser->GetPageText( ) ) );
+		m_is_find_snapshot_stale = false;
+	}
+	auto const options =
+	    find_options_t{m_find_toolbar_matchcase->IsChecked( ), m_find_toolbar_wholeword->IsChecked( )};
+	m_find_engine->search( to_utf8( find_text ), options, [this, generation]( find_result_t result ) {
+		auto const shared_result = std::make_shared<find_result_t const>( std::move( result ) );
+		CallAfter( [this, generation, shared_result]( ) { OnFindResult( generation, *shared_result ); } );
+	} );
+}
+
+void WebFrame::OnFindResult( uint64_t generation, find_result_t const &result ) {
+	if( generation != m_find_generation ) {
+		// Typing went on, or the page changed
+		return;
+	}
+	auto const find_text = m_find_ctrl->GetValue( );
+	m_findText = find_text;
+	m_findCount = static_cast<int>( result.count );
+	// Clears the previous highlight, then the one search the webview runs for this query
+	m_browser->Find( "" );
+	// The snapshot only folds ascii case, the webview's own search decides for other text
+	auto const is_ascii = std::all_of( find_text.begin( ), find_text.end( ),
+	                                   []( wxUniChar c ) { return c.GetValue( ) < 0x80; } );
+	if( result.count > 0 ) {
+		m_browser->Find( find_text, GetFindFlags( false ) );
+	} else if( !is_ascii ) {
+		auto const count = m_browser->Find( find_text, GetFindFlags( false ) );
+		m_findCount = count == wxNOT_FOUND ? 0 : static_cast<int>( count );
+	}
+	m_find_ctrl->SetBackgroundColour( m_findCount > 0 ? *wxWHITE : wxColour{255, 101, 101} );
+	m_find_ctrl->Refresh( );
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+		wxLogMessage( "Searching for:%s  matches:%i", m_findText.c_str( ), m_findCount );
+	}
+}
+
+void WebFrame::OnFindInPages( wxCommandEvent &WXUNUSED( evt ) ) {
+	if( !is_enabled( features::search, m_app_config->enable_search ) ) {
+		return;
+	}
+	if( m_page_search == nullptr ) {
+		// Nothing is captured until the dialog is first wanted, so start from the open pages
+		for( auto const &tab : m_tab_states ) {
+			if( tab.view != nullptr && !tab.view->IsBusy( ) ) {
+				CapturePageText( *tab.view );
+			}
+		}
+		// A child of the frame, destroyed with it
+		m_page_search = new PageSearchDialog{this};
+	}
+	m_page_search->Show( );
+	m_page_search->Raise( );
+}
+
+void WebFrame::CapturePageText( wxWebView &view ) {
+	auto page = std::make_shared<page_text_t const>( page_text_t{
+	    to_utf8( view.GetCurrentURL( ) ), to_utf8( view.GetCurrentTitle( ) ), to_utf8( view.GetPageText( ) )} );
+	auto const size = page->url.size( ) + page->title.size( ) + page->text.size( );
+	m_page_texts.insert( page->url, page, size );
+	if( m_page_search != nullptr ) {
+		m_page_search->AddPage( std::move( page ) );
+	}
+}
+#endif
+
+void WebFrame::InvalidateFindSnapshot( ) {
+	m_is_find_snapshot_stale = true;
+	// A search over the old snapshot is no longer wanted
+	++m_find_generation;
+}
+
 /**
  * Callback invoked when there is a request to load a new page (for instance
  * when the user clicks a link)
  */
 void WebFrame::OnNavigationRequest( wxWebViewEvent &evt ) {
-	if( false && !m_app_config->enable_navigation ) {
+	if( false && !is_enabled( features::navigation, m_app_config->enable_navigation ) ) {
 		evt.Veto( );
-		if( m_app_config->enable_toolbar ) {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), false );
-		}
+		SetBusy( false );
 		return;
 	}
-	auto const url = m_url->GetValue( ).ToStdString( );
-	if( !m_app_config->is_valid_url( url ) ) {
+	auto const url = evt.GetURL( ).ToStdString( );
+	if( evt.GetTarget( ).empty( ) && get_page_cache_target( url ) != url ) {
+		// So the page cache handler can tell this load from a sub-resource's
+		m_cache_documents->expect( url );
+	}
+	if( m_services.supervisor_link != nullptr && evt.GetTarget( ).empty( ) ) {
+		auto is_own = boost::optional<bool>{};
+		if( url == m_owned_url ) {
+			m_owned_url.clear( );
+			is_own = true;
+		} else {
+			is_own = m_services.supervisor_link->fast_is_own_url( get_page_cache_target( url ) );
+		}
+		if( !is_own && evt.GetEventObject( ) == m_browser ) {
+			// Needs a regex; veto now and load or hand off once a worker decides
+			evt.Veto( );
+			SubmitOwnershipCheck( url );
+			return;
+		}
+		if( !is_own ) {
+			// A background tab cannot be resumed later, so decide it now
+			is_own = m_services.supervisor_link->is_own_url( get_page_cache_target( url ) );
+		}
+		if( !*is_own ) {
+			// Another site group's process decides and loads it
+			evt.Veto( );
+			if( evt.GetEventObject( ) == m_browser ) {
+				SetBusy( false );
+			}
+			m_services.supervisor_link->hand_off( url );
+			return;
+		}
+	}
+	if( m_services.navigation_timing != nullptr && evt.GetTarget( ).empty( ) ) {
+		// Timed from here even if a policy check holds it up, that wait is part of the load
+		m_services.navigation_timing->on_request( url );
+	}
+	if( evt.GetEventObject( ) != m_browser ) {
+		// A background tab cannot be resumed later, so decide it now and leave the toolbar alone
+		if( !m_app_config->is_valid_url( get_page_cache_target( url ) ) ) {
+			evt.Veto( );
+		}
 		return;
 	}
+	if( url == m_approved_url ) {
+		m_approved_url.clear( );
+	} else {
+		auto const policy_url = get_page_cache_target( url );
+		auto is_allowed = m_app_config->fast_url_verdict( policy_url );
+		if( !is_allowed && !evt.GetTarget( ).empty( ) ) {
+			// A subframe load cannot be resumed with LoadURL so decide it here
+			is_allowed = m_app_config->evaluate_url( policy_url );
+		}
+		if( !is_allowed ) {
+			// Needs a regex; veto now and resume once a worker approves the url
+			evt.Veto( );
+			SubmitPolicyCheck( url );
+			return;
+		}
+		if( !*is_allowed ) {
+			evt.Veto( );
+			if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
+				wxLogMessage( "%s", "Navigation denied; url='" + url + "'" );
+			}
+			SetBusy( false );
+			return;
+		}
+	}
+	if( evt.GetTarget( ).empty( ) ) {
+		// This navigation supersedes any policy check still in flight
+		++m_nav_generation;
+	}
 	if( m_info->IsShown( ) ) {
 		m_info->Dismiss( );
 	}
 
-	if( m_app_config->enable_debug_window ) {
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "%s", "Navigation request to '" + evt.GetURL( ) + "' (target='" + evt.GetTarget( ) + "')" );
 	}
 
 	wxASSERT( m_browser->IsBusy( ) );
 
 	// If we don't want to handle navigation then veto the event and navigation
-	// will not take place, we also need to stop the loading animation
-	if( !m_tools_handle_navigation->IsChecked( ) ) {
+	// will not take place, we also need to stop the loading animation.  Without
+	// a Tools menu navigation is always handled
+	if( m_tools_menu && !m_tools_handle_navigation->IsChecked( ) ) {
 		evt.Veto( );
-		if( m_app_config->enable_toolbar ) {
-			m_toolbar->EnableTool( m_toolbar_stop->GetId( ), false );
-		}
+		SetBusy( false );
 	} else {
 		UpdateState( );
 	}
 }
 
 void WebFrame::OnNavigationComplete( wxWebViewEvent &evt ) {
-	if( m_app_config->enable_debug_window ) {
+	if( m_services.navigation_timing != nullptr ) {
+		m_services.navigation_timing->on_complete( evt.GetURL( ).ToStdString( ) );
+	}
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "%s", "Navigation complete; url='" + evt.GetURL( ) + "'" );
+		auto const stats = m_app_config->url_cache_stats( );
+		wxLogMessage( "URL verdict cache; hits=%llu, misses=%llu, size=%llu/%llu",
+		              static_cast<unsigned long long>( stats.hits ), static_cast<unsigned long long>( stats.misses ),
+		              static_cast<unsigned long long>( stats.size ),
+		              static_cast<unsigned long long>( stats.capacity ) );
 	}
 	UpdateState( );
 }
 
 void WebFrame::OnDocumentLoaded( wxWebViewEvent &evt ) {
+	auto const view = static_cast<wxWebView *>( evt.GetEventObject( ) );
 	// Only notify if the document is the main frame, not a subframe
-	if( evt.GetURL( ) == m_browser->GetCurrentURL( ) ) {
-		if( m_app_config->enable_debug_window ) {
+	if( evt.GetURL( ) == view->GetCurrentURL( ) ) {
+		get_startup_trace( ).mark( "first_load" );
+		boost::optional<std::chrono::microseconds> load_time;
+		if( m_services.navigation_timing != nullptr ) {
+			load_time = m_services.navigation_timing->on_loaded( evt.GetURL( ).ToStdString( ) );
+		}
+		auto const tab = FindTab( view );
+		if( tab != nullptr ) {
+			auto const title = view->GetCurrentTitle( );
+			m_tabs->SetPageText( m_tabs->GetPageIndex( tab->page ), title.empty( ) ? evt.GetURL( ) : title );
+			if( tab->scroll ) {
+				view->RunScript( wxString::Format( "window.scrollTo(%d,%d);", tab->scroll->x, tab->scroll->y ) );
+				tab->scroll = boost::none;
+			}
+		}
+#if WBA_HAS_FEATURE( SEARCH )
+		// Every tab's loads count, Find in Pages covers background tabs too
+		if( m_page_search != nullptr && is_enabled( features::search, m_app_config->enable_search ) ) {
+			CapturePageText( *view );
+		}
+#endif
+		// Follow the webview's own history switch when the menu offers one
+		auto const is_recording = !m_tools_menu || m_tools_enable_history->IsChecked( );
+		if( m_services.history_store != nullptr && is_recording ) {
+			auto const visited = evt.GetURL( ).ToStdString( );
+			m_services.history_store->add_visit( visited, view->GetCurrentTitle( ).ToStdString( ) );
+			if( m_services.url_suggestions != nullptr ) {
+				m_services.url_suggestions->add_visit( visited );
+			}
+		}
+		if( view == m_browser ) {
+			InvalidateFindSnapshot( );
+			FinishAutomationNavigation( true, to_utf8( evt.GetURL( ) ) );
+		}
+		if( m_services.supervisor_link != nullptr && view == m_browser ) {
+			// Where a restart resumes
+			m_services.supervisor_link->report_loaded( evt.GetURL( ).ToStdString( ) );
+		}
+		// Transitions are browsing history too, so they follow the same switch.  Only
+		// the selected tab is followed, background tabs would interleave unrelated paths
+		if( m_services.prefetcher != nullptr && is_recording && view == m_browser ) {
+			auto loaded = evt.GetURL( ).ToStdString( );
+			m_services.prefetcher->on_navigation( m_app_config, m_last_loaded_url, loaded );
+			m_last_loaded_url = std::move( loaded );
+		}
+		auto const startup = get_startup_trace( ).report( );
+		if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 			wxLogMessage( "%s", "Document loaded; url='" + evt.GetURL( ) + "'" );
+			if( load_time ) {
+				auto const loads = m_services.navigation_timing->load_summary( );
+				wxLogMessage( "Navigation timing; load_ms=%.1f, p50_ms=%.1f, p99_ms=%.1f, loads=%lld",
+				              static_cast<double>( load_time->count( ) ) / 1000.0,
+				              static_cast<double>( loads.p50_us ) / 1000.0,
+				              static_cast<double>( loads.p99_us ) / 1000.0, static_cast<long long>( loads.count ) );
+			}
+			if( !startup.empty( ) ) {
+				wxLogMessage( "%s", "Startup; " + startup );
+			}
 		}
 	}
 	UpdateState( );
 }
 
 void WebFrame::OnNewWindow( wxWebViewEvent &evt ) {
-	if( m_app_config->enable_debug_window ) {
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "%s", "New window; url='" + evt.GetURL( ) + "'" );
 	}
-	// If we handle new window events then just load them in this window as we
-	// are a single window browser
-	if( m_tools_handle_new_window->IsChecked( ) ) {
+	// If we handle new window events then just load them in this tab, otherwise
+	// open a tab of their own.  The new tab's navigation policy still applies to
+	// the url
+	if( !m_tools_menu || m_tools_handle_new_window->IsChecked( ) ) {
 		m_browser->LoadURL( evt.GetURL( ) );
+	} else {
+		AddTab( evt.GetURL( ), true );
 	}
 
 	UpdateState( );
 }
 
 void WebFrame::OnTitleChanged( wxWebViewEvent &evt ) {
-	if( !m_app_config->enable_title_change ) {
+	if( CompleteTitleProbe( wxDynamicCast( evt.GetEventObject( ), wxWebView ), evt.GetString( ) ) ) {
+		return;
+	}
+#if WBA_HAS_FEATURE( TITLE_CHANGE )
+	if( evt.GetEventObject( ) != m_browser ||
+	    !is_enabled( features::title_change, m_app_config->enable_title_change ) ) {
 		return;
 	}
-	SetTitle( evt.GetString( ) );
-	if( m_app_config->enable_debug_window ) {
+	m_ui_state.title = evt.GetString( );
+	SetTitle( m_ui_state.title );
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "%s", "Title changed; title='" + evt.GetString( ) + "'" );
 	}
+#endif
 }
 
+#if WBA_HAS_FEATURE( VIEW_SOURCE )
 void WebFrame::OnViewSourceRequest( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_view_source ) {
+	if( !is_enabled( features::view_source, m_app_config->enable_view_source ) ) {
 		return;
 	}
-	SourceViewDialog dlg( this, m_browser->GetPageSource( ) );
+	// Only the copy out of the webview happens here, the dialog fills in while shown
+	SourceViewDialog dlg( this, "Source Code", m_browser->GetPageSource( ), wxSTC_LEX_HTML );
 	dlg.ShowModal( );
 }
+#endif
 
+#if WBA_HAS_FEATURE( VIEW_TEXT )
 void WebFrame::OnViewTextRequest( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_view_text ) {
+	if( !is_enabled( features::view_text, m_app_config->enable_view_text ) ) {
 		return;
 	}
-	wxDialog textViewDialog{
-	    this, wxID_ANY, "Page Text", wxDefaultPosition, wxSize{700, 500}, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER};
-	auto text = std::make_unique<wxStyledTextCtrl>( &textViewDialog, wxID_ANY );
-	text->SetText( m_browser->GetPageText( ) );
-	auto sizer = std::make_unique<wxBoxSizer>( wxVERTICAL );
-	sizer->Add( text.release( ), 1, wxEXPAND );
-	SetSizer( sizer.release( ) );
-	textViewDialog.ShowModal( );
+	SourceViewDialog dlg( this, "Page Text", m_browser->GetPageText( ), wxSTC_LEX_NULL );
+	dlg.ShowModal( );
 }
+#endif
 
+#if WBA_HAS_FEATURE( TOOLBAR )
 void WebFrame::OnToolsClicked( wxCommandEvent &WXUNUSED( evt ) ) {
 	if( m_browser->GetCurrentURL( ) == "" ) {
 		return;
 	}
+	if( !m_tools_menu ) {
+		BuildToolsMenu( );
+	}
 
+#if WBA_HAS_FEATURE( ZOOM )
 	m_tools_tiny->Check( false );
 	m_tools_small->Check( false );
 	m_tools_medium->Check( false );
@@ -753,67 +2715,41 @@ void WebFrame::OnToolsClicked( wxCommandEvent &WXUNUSED( evt ) ) {
 		m_tools_largest->Check( );
 		break;
 	}
+#endif
 
+#if WBA_HAS_FEATURE( CLIPBOARD ) && WBA_HAS_FEATURE( EDIT )
 	m_edit_cut->Enable( m_browser->CanCut( ) );
-	m_edit_copy->Enable( m_browser->CanCopy( ) );
 	m_edit_paste->Enable( m_browser->CanPaste( ) );
+#endif
+#if WBA_HAS_FEATURE( CLIPBOARD )
+	m_edit_copy->Enable( m_browser->CanCopy( ) );
+#endif
 
+#if WBA_HAS_FEATURE( EDIT )
 	m_edit_undo->Enable( m_browser->CanUndo( ) );
 	m_edit_redo->Enable( m_browser->CanRedo( ) );
+#endif
 
+#if WBA_HAS_FEATURE( SELECT )
 	m_selection_clear->Enable( m_browser->HasSelection( ) );
 	m_selection_delete->Enable( m_browser->HasSelection( ) );
+#endif
 
 	m_context_menu->Check( m_browser->IsContextMenuEnabled( ) );
 
-	// Firstly we clear the existing menu items, then we add the current ones
-	wxMenuHistoryMap::const_iterator it;
-	for( it = m_histMenuItems.begin( ); it != m_histMenuItems.end( ); ++it ) {
-		m_tools_history_menu->Destroy( it->first );
-	}
-	m_histMenuItems.clear( );
-
-	auto back = m_browser->GetBackwardHistory( );
-	auto forward = m_browser->GetForwardHistory( );
-
-	wxMenuItem *item;
-
-	for( unsigned int i = 0; i < back.size( ); i++ ) {
-		item = m_tools_history_menu->AppendRadioItem( wxID_ANY, back[i]->GetTitle( ) );
-		m_histMenuItems[item->GetId( )] = back[i];
-		Connect( item->GetId( ), wxEVT_MENU, wxCommandEventHandler( WebFrame::OnHistory ), nullptr, this );
-	}
-
-	auto title = m_browser->GetCurrentTitle( );
-	if( title.empty( ) ) {
-		title = "(untitled)";
-	}
-
-	item = m_tools_history_menu->AppendRadioItem( wxID_ANY, title );
-	item->Check( );
-
-	// No need to connect the current item
-	m_histMenuItems[item->GetId( )] = wxSharedPtr<wxWebViewHistoryItem>{
-	    new wxWebViewHistoryItem{m_browser->GetCurrentURL( ), m_browser->GetCurrentTitle( )}};
-
-	for( auto const & fw: forward ) {
-		item = m_tools_history_menu->AppendRadioItem( wxID_ANY, fw->GetTitle( ) );
-		m_histMenuItems[item->GetId( )] = fw;
-		Connect( item->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnHistory ), nullptr, this );
-	}
-/*	for( unsigned int i = 0; i < forward.size( ); i++ ) {
-		item = m_tools_history_menu->AppendRadioItem( wxID_ANY, forward[i]->GetTitle( ) );
-		m_histMenuItems[item->GetId( )] = forward[i];
-		Connect( item->GetId( ), wxEVT_TOOL, wxCommandEventHandler( WebFrame::OnHistory ), nullptr, this );
-	}
-*/
+	SyncHistory( );
+	// Open on the page holding the current entry
+	m_history_page_start = m_history_current - m_history_current % history_page_size;
+	UpdateHistoryMenu( );
 
 	auto position = ScreenToClient( wxGetMousePosition( ) );
 	PopupMenu( m_tools_menu.get( ), position.x, position.y );
 }
+#endif
 
+#if WBA_HAS_FEATURE( ZOOM )
 void WebFrame::OnSetZoom( wxCommandEvent &evt ) {
-	if( !m_app_config->enable_zoom ) {
+	if( !is_enabled( features::zoom, m_app_config->enable_zoom ) ) {
 		return;
 	}
 	if( evt.GetId( ) == m_tools_tiny->GetId( ) ) {
@@ -832,7 +2768,7 @@ void WebFrame::OnSetZoom( wxCommandEvent &evt ) {
 }
 
 void WebFrame::OnZoomLayout( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_zoom ) {
+	if( !is_enabled( features::zoom, m_app_config->enable_zoom ) ) {
 		return;
 	}
 	if( m_tools_layout->IsChecked( ) ) {
@@ -841,9 +2777,102 @@ void WebFrame::OnZoomLayout( wxCommandEvent &WXUNUSED( evt ) ) {
 		m_browser->SetZoomType( wxWEBVIEW_ZOOM_TYPE_TEXT );
 	}
 }
+#endif
+
+void WebFrame::SyncHistory( ) {
+	auto const back = m_browser->GetBackwardHistory( );
+	auto const forward = m_browser->GetForwardHistory( );
+	auto const size = back.size( ) + 1 + forward.size( );
+	auto const get_item = [&]( size_t n ) {
+		if( n < back.size( ) ) {
+			return back[n];
+		}
+		if( n == back.size( ) ) {
+			return wxSharedPtr<wxWebViewHistoryItem>{
+			    new wxWebViewHistoryItem{m_browser->GetCurrentURL( ), m_browser->GetCurrentTitle( )}};
+		}
+		return forward[n - back.size( ) - 1];
+	};
+
+	// The webview only hands out whole lists, so m_history keeps the entries
+	// that are unchanged and only the tail from the first that differs, e.g.
+	// after navigating from a back entry, is replaced
+	size_t unchanged = 0;
+	for( ; unchanged < std::min( size, m_history.size( ) ); ++unchanged ) {
+		auto const item = get_item( unchanged );
+		auto &entry = m_history[unchanged];
+		if( entry->GetUrl( ) != item->GetUrl( ) || entry->GetTitle( ) != item->GetTitle( ) ) {
+			break;
+		}
+		// Some backends look an item up by identity in LoadHistoryItem
+		entry = item;
+	}
+	m_history.erase( m_history.begin( ) + static_cast<std::ptrdiff_t>( unchanged ), m_history.end( ) );
+	m_history.reserve( size );
+	for( auto n = unchanged; n < size; ++n ) {
+		m_history.push_back( get_item( n ) );
+	}
+	m_history_current = back.size( );
+}
+
+void WebFrame::UpdateHistoryMenu( ) {
+	auto const count = std::min( history_page_size, m_history.size( ) - m_history_page_start );
+
+	// Only slots whose entry changed are touched, the rest of the menu is left alone
+	while( m_history_slots.size( ) > count ) {
+		m_tools_history_menu->Destroy( id_history_first + static_cast<int>( m_history_slots.size( ) - 1 ) );
+		m_history_slots.pop_back( );
+	}
+	for( size_t n = 0; n < count; ++n ) {
+		auto label = m_history[m_history_page_start + n]->GetTitle( );
+		if( label.empty( ) ) {
+			label = "(untitled)";
+		}
+		auto const id = id_history_first + static_cast<int>( n );
+		if( n == m_history_slots.size( ) ) {
+			m_tools_history_menu->Insert( m_history_slot_pos + n, id, label, wxEmptyString, wxITEM_CHECK );
+			m_history_slots.push_back( label );
+		} else if( m_history_slots[n] != label ) {
+			m_tools_history_menu->SetLabel( id, label );
+			m_history_slots[n] = label;
+		}
+	}
+
+	boost::optional<size_t> checked;
+	if( m_history_current >= m_history_page_start && m_history_current - m_history_page_start < count ) {
+		checked = m_history_current - m_history_page_start;
+	}
+	if( m_history_checked && *m_history_checked < count && m_history_checked != checked ) {
+		m_tools_history_menu->Check( id_history_first + static_cast<int>( *m_history_checked ), false );
+	}
+	if( checked ) {
+		m_tools_history_menu->Check( id_history_first + static_cast<int>( *checked ), true );
+	}
+	m_history_checked = checked;
+
+	m_history_older->Enable( m_history_page_start > 0 );
+	m_history_newer->Enable( m_history_page_start + count < m_history.size( ) );
+}
 
 void WebFrame::OnHistory( wxCommandEvent &evt ) {
-	m_browser->LoadHistoryItem( m_histMenuItems[evt.GetId( )] );
+	auto const index = m_history_page_start + static_cast<size_t>( evt.GetId( ) - id_history_first );
+	if( index < m_history.size( ) ) {
+		m_browser->LoadHistoryItem( m_history[index] );
+	}
+}
+
+void WebFrame::OnHistoryPage( wxCommandEvent &evt ) {
+	if( evt.GetId( ) == id_history_older ) {
+		m_history_page_start -= std::min( history_page_size, m_history_page_start );
+	} else if( m_history_page_start + history_page_size < m_history.size( ) ) {
+		m_history_page_start += history_page_size;
+	}
+	UpdateHistoryMenu( );
+	// Picking a menu item closes the popup, reopen it on the new page
+	CallAfter( [this]( ) {
+		auto position = ScreenToClient( wxGetMousePosition( ) );
+		PopupMenu( m_tools_menu.get( ), position.x, position.y );
+	} );
 }
 
 void WebFrame::OnRunScript( wxCommandEvent &WXUNUSED( evt ) ) {
@@ -854,26 +2883,28 @@ void WebFrame::OnRunScript( wxCommandEvent &WXUNUSED( evt ) ) {
 	}
 }
 
+#if WBA_HAS_FEATURE( SELECT )
 void WebFrame::OnClearSelection( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_select ) {
+	if( !is_enabled( features::select, m_app_config->enable_select ) ) {
 		return;
 	}
 	m_browser->ClearSelection( );
 }
 
 void WebFrame::OnDeleteSelection( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_select ) {
+	if( !is_enabled( features::select, m_app_config->enable_select ) ) {
 		return;
 	}
 	m_browser->DeleteSelection( );
 }
 
 void WebFrame::OnSelectAll( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_select ) {
+	if( !is_enabled( features::select, m_app_config->enable_select ) ) {
 		return;
 	}
 	m_browser->SelectAll( );
 }
+#endif
 
 /**
  * Callback invoked when a loading error occurs
@@ -884,6 +2915,10 @@ void WebFrame::OnError( wxWebViewEvent &evt ) {
 		category = #type;                                                                                              \
 		break;
 
+	if( m_services.navigation_timing != nullptr ) {
+		m_services.navigation_timing->on_error( evt.GetURL( ).ToStdString( ) );
+	}
+
 	wxString category;
 	switch( evt.GetInt( ) ) {
 		WX_ERROR_CASE( wxWEBVIEW_NAV_ERR_CONNECTION );
@@ -898,10 +2933,18 @@ void WebFrame::OnError( wxWebViewEvent &evt ) {
 		throw std::logic_error( "Unknown event type in OnError" );
 	}
 
-	if( m_app_config->enable_debug_window ) {
+	if( is_enabled( features::debug_window, m_app_config->enable_debug_window ) ) {
 		wxLogMessage( "%s", "Error; url='" + evt.GetURL( ) + "', error='" + category + " (" + evt.GetString( ) + ")'" );
 	}
 
+	if( evt.GetEventObject( ) != m_browser ) {
+		// The tab shows its own error page when selected
+		return;
+	}
+	auto const error =
+	    "Error loading; url='" + evt.GetURL( ) + "', error='" + category + " (" + evt.GetString( ) + ")'";
+	FinishAutomationNavigation( false, to_utf8( error ) );
+
 	// Show the info bar with an error
 	m_info->ShowMessage( _( "An error occurred loading " ) + evt.GetURL( ) + "\n" + "'" + category + "'",
 	                     wxICON_ERROR );
@@ -909,37 +2952,207 @@ void WebFrame::OnError( wxWebViewEvent &evt ) {
 	UpdateState( );
 }
 
+#if WBA_HAS_FEATURE( PRINTING )
 void WebFrame::OnPrint( wxCommandEvent &WXUNUSED( evt ) ) {
-	if( !m_app_config->enable_printing ) {
+	if( !is_enabled( features::printing, m_app_config->enable_printing ) ) {
 		return;
 	}
 	m_browser->Print( );
 }
+#endif
 
 WebApp::~WebApp( ) {}
 
-SourceViewDialog::SourceViewDialog( wxWindow *parent, wxString source )
-    : wxDialog{parent,           wxID_ANY,
-               "Source Code",    wxDefaultPosition,
-               wxSize{700, 500}, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER} {
+#if WBA_HAS_FEATURE( VIEW_SOURCE ) || WBA_HAS_FEATURE( VIEW_TEXT )
+SourceViewDialog::SourceViewDialog( wxWindow *parent, wxString const &title, wxString source, int lexer )
+    : wxDialog{parent, wxID_ANY, title, wxDefaultPosition, wxSize{700, 500}, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER}
+    , m_text{nullptr}
+    , m_progress{nullptr}
+    , m_loader{}
+    , m_mutex{}
+    , m_cv{}
+    , m_chunks_in_flight{0}
+    , m_is_stopping{false} {
 
 	auto text = std::make_unique<wxStyledTextCtrl>( this, wxID_ANY );
 	text->SetMarginWidth( 1, 30 );
 	text->SetMarginType( 1, wxSTC_MARGIN_NUMBER );
-	text->SetText( source );
+	// Nothing to undo in a viewer, and keeping it would double the memory
+	text->SetUndoCollection( false );
 
+	// The lexer goes on before any text, appended text is then only styled
+	// once it is scrolled into view
 	text->StyleClearAll( );
-	text->SetLexer( wxSTC_LEX_HTML );
-	text->StyleSetForeground( wxSTC_H_DOUBLESTRING, wxColour{255, 0, 0} );
-	text->StyleSetForeground( wxSTC_H_SINGLESTRING, wxColour{255, 0, 0} );
-	text->StyleSetForeground( wxSTC_H_ENTITY, wxColour{255, 0, 0} );
-	text->StyleSetForeground( wxSTC_H_TAG, wxColour{0, 150, 0} );
-	text->StyleSetForeground( wxSTC_H_TAGUNKNOWN, wxColour{0, 150, 0} );
-	text->StyleSetForeground( wxSTC_H_ATTRIBUTE, wxColour{0, 0, 150} );
-	text->StyleSetForeground( wxSTC_H_ATTRIBUTEUNKNOWN, wxColour{0, 0, 150} );
-	text->StyleSetForeground( wxSTC_H_COMMENT, wxColour{150, 150, 150} );
+	text->SetLexer( lexer );
+	if( lexer == wxSTC_LEX_HTML ) {
+		text->StyleSetForeground( wxSTC_H_DOUBLESTRING, wxColour{255, 0, 0} );
+		text->StyleSetForeground( wxSTC_H_SINGLESTRING, wxColour{255, 0, 0} );
+		text->StyleSetForeground( wxSTC_H_ENTITY, wxColour{255, 0, 0} );
+		text->StyleSetForeground( wxSTC_H_TAG, wxColour{0, 150, 0} );
+		text->StyleSetForeground( wxSTC_H_TAGUNKNOWN, wxColour{0, 150, 0} );
+		text->StyleSetForeground( wxSTC_H_ATTRIBUTE, wxColour{0, 0, 150} );
+		text->StyleSetForeground( wxSTC_H_ATTRIBUTEUNKNOWN, wxColour{0, 0, 150} );
+		text->StyleSetForeground( wxSTC_H_COMMENT, wxColour{150, 150, 150} );
+	}
+
+	auto progress = std::make_unique<wxGauge>( this, wxID_ANY, source_progress_range );
 
 	auto sizer = std::make_unique<wxBoxSizer>( wxVERTICAL );
+	m_text = text.get( );
+	m_progress = progress.get( );
 	sizer->Add( text.release( ), 1, wxEXPAND );
+	sizer->Add( progress.release( ), wxSizerFlags( ).Expand( ).Border( ) );
+	SetSizer( sizer.release( ) );
+
+	m_loader = std::thread{[this]( wxString page_source ) { LoadSource( std::move( page_source ) ); },
+	                       std::move( source )};
+}
+
+void SourceViewDialog::LoadSource( wxString source ) {
+	auto const utf8 = source.utf8_str( );
+	source.clear( );
+	auto const data = utf8.data( );
+	auto const size = utf8.length( );
+	size_t pos = 0;
+	// An empty page still posts the chunk that finishes loading
+	do {
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cv.wait( lock, [this]( ) { return m_is_stopping || m_chunks_in_flight < max_source_chunks_in_flight; } );
+			if( m_is_stopping ) {
+				return;
+			}
+			++m_chunks_in_flight;
+		}
+		auto const end = pos + get_source_chunk_size( data + pos, size - pos );
+		auto chunk = std::make_shared<std::string>( data + pos, data + end );
+		CallAfter( [this, chunk, end, size]( ) { AppendChunk( *chunk, end, size ); } );
+		pos = end;
+	} while( pos < size );
+}
+
+void SourceViewDialog::AppendChunk( std::string const &chunk, size_t loaded, size_t total ) {
+	m_text->AppendTextRaw( chunk.data( ), static_cast<int>( chunk.size( ) ) );
+	if( loaded < total ) {
+		m_progress->SetValue( static_cast<int>( loaded * source_progress_range / total ) );
+	} else {
+		m_text->SetReadOnly( true );
+		// Room for the widest line number
+		auto const widest = "_" + std::to_string( m_text->GetLineCount( ) );
+		m_text->SetMarginWidth( 1, m_text->TextWidth( wxSTC_STYLE_LINENUMBER, widest ) );
+		m_progress->Hide( );
+		Layout( );
+	}
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		--m_chunks_in_flight;
+	}
+	m_cv.notify_one( );
+}
+#endif
+
+#if WBA_HAS_FEATURE( SEARCH )
+PageSearchDialog::PageSearchDialog( WebFrame *frame )
+    : wxDialog{frame, wxID_ANY, _( "Find in Pages" ), wxDefaultPosition, wxSize{700, 400},
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER}
+    , m_frame{frame}
+    , m_terms{nullptr}
+    , m_results{nullptr}
+    , m_patterns{}
+    , m_generation{0}
+    , m_search{} {
+
+	auto terms = std::make_unique<wxTextCtrl>( this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+	                                           wxTE_PROCESS_ENTER );
+	terms->SetHint( _( "Terms, separated by commas" ) );
+	auto results = std::make_unique<wxListCtrl>( this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+	                                             wxLC_REPORT | wxLC_SINGLE_SEL );
+	results->AppendColumn( _( "Page" ), wxLIST_FORMAT_LEFT, 250 );
+	results->AppendColumn( _( "Title" ), wxLIST_FORMAT_LEFT, 200 );
+	results->AppendColumn( _( "Hits" ), wxLIST_FORMAT_RIGHT, 60 );
+	results->AppendColumn( _( "By Term" ), wxLIST_FORMAT_LEFT, 170 );
+
+	auto sizer = std::make_unique<wxBoxSizer>( wxVERTICAL );
+	m_terms = terms.get( );
+	m_results = results.get( );
+	sizer->Add( terms.release( ), wxSizerFlags( ).Expand( ).Border( ) );
+	sizer->Add( results.release( ), wxSizerFlags( 1 ).Expand( ).Border( wxLEFT | wxRIGHT | wxBOTTOM ) );
 	SetSizer( sizer.release( ) );
+
+	m_terms->Bind( wxEVT_TEXT_ENTER, &PageSearchDialog::OnSearch, this );
+	m_results->Bind( wxEVT_LIST_ITEM_ACTIVATED, &PageSearchDialog::OnActivated, this );
+
+	m_search = std::make_unique<page_search_t>( [this]( uint64_t generation, page_hits_t hits ) {
+		auto result = std::make_shared<page_hits_t>( std::move( hits ) );
+		CallAfter( [this, generation, result]( ) { OnHits( generation, *result ); } );
+	} );
+}
+
+PageSearchDialog::~PageSearchDialog( ) {
+	m_search.reset( );
+}
+
+void PageSearchDialog::AddPage( std::shared_ptr<page_text_t const> page ) {
+	m_search->add_page( std::move( page ) );
+}
+
+void PageSearchDialog::OnSearch( wxCommandEvent &WXUNUSED( evt ) ) {
+	auto const value = to_utf8( m_terms->GetValue( ) );
+	m_patterns.clear( );
+	size_t total_size = 0;
+	size_t pos = 0;
+	while( pos <= value.size( ) ) {
+		auto end = value.find( ',', pos );
+		if( end == std::string::npos ) {
+			end = value.size( );
+		}
+		auto first = pos;
+		auto last = end;
+		while( first < last && std::isspace( static_cast<unsigned char>( value[first] ) ) ) {
+			++first;
+		}
+		while( last > first && std::isspace( static_cast<unsigned char>( value[last - 1] ) ) ) {
+			--last;
+		}
+		total_size += last - first;
+		if( first < last && total_size <= max_page_search_bytes ) {
+			m_patterns.push_back( value.substr( first, last - first ) );
+		}
+		pos = end + 1;
+	}
+	m_results->DeleteAllItems( );
+	m_generation = m_search->search( m_patterns, m_frame->GetPageTexts( ) );
+}
+
+void PageSearchDialog::OnActivated( wxListEvent &evt ) {
+	m_frame->Navigate( to_utf8( m_results->GetItemText( evt.GetIndex( ) ) ) );
+}
+
+void PageSearchDialog::OnHits( uint64_t generation, page_hits_t const &hits ) {
+	if( generation != m_generation ) {
+		return;
+	}
+	auto const url = wxString::FromUTF8( hits.url.data( ), hits.url.size( ) );
+	// A reload replaces the page's row, or removes it once the terms are gone from it
+	auto row = m_results->FindItem( -1, url );
+	if( hits.total == 0 ) {
+		if( row != wxNOT_FOUND ) {
+			m_results->DeleteItem( row );
+		}
+		return;
+	}
+	if( row == wxNOT_FOUND ) {
+		row = m_results->InsertItem( m_results->GetItemCount( ), url );
+	}
+	std::string by_term;
+	for( size_t n = 0; n < m_patterns.size( ) && n < hits.counts.size( ); ++n ) {
+		if( !by_term.empty( ) ) {
+			by_term += ", ";
+		}
+		by_term += m_patterns[n] + ": " + std::to_string( hits.counts[n] );
+	}
+	m_results->SetItem( row, 1, wxString::FromUTF8( hits.title.data( ), hits.title.size( ) ) );
+	m_results->SetItem( row, 2, std::to_string( hits.total ) );
+	m_results->SetItem( row, 3, wxString::FromUTF8( by_term.data( ), by_term.size( ) ) );
 }
+#endif
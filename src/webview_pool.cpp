@@ -0,0 +1,78 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "webview_pool.h"
+
+webview_pool_t::parking_frame_t::parking_frame_t( ) : wxFrame{nullptr, wxID_ANY, wxEmptyString} {}
+
+webview_pool_t::parking_frame_t::~parking_frame_t( ) {}
+
+bool webview_pool_t::parking_frame_t::ShouldPreventAppExit( ) const {
+	return false;
+}
+
+webview_pool_t::webview_pool_t( size_t size ) : m_parking{new parking_frame_t{}}, m_views{}, m_size{size} {
+	m_views.reserve( m_size );
+	wxTheApp->Bind( wxEVT_IDLE, &webview_pool_t::OnIdle, this );
+}
+
+webview_pool_t::~webview_pool_t( ) {
+	wxTheApp->Unbind( wxEVT_IDLE, &webview_pool_t::OnIdle, this );
+	// The parked views are its children
+	m_parking->Destroy( );
+}
+
+void webview_pool_t::OnIdle( wxIdleEvent &evt ) {
+	evt.Skip( );
+	if( m_views.size( ) >= m_size ) {
+		return;
+	}
+	m_views.push_back( wxWebView::New( m_parking, wxID_ANY ) );
+	m_views.back( )->Hide( );
+	if( m_views.size( ) < m_size ) {
+		evt.RequestMore( );
+	}
+}
+
+wxWebView *webview_pool_t::acquire( wxWindow *parent ) {
+	if( m_views.empty( ) ) {
+		return wxWebView::New( parent, wxID_ANY );
+	}
+	auto const view = m_views.back( );
+	m_views.pop_back( );
+	view->Reparent( parent );
+	view->Show( );
+	return view;
+}
+
+void webview_pool_t::set_size( size_t size ) {
+	m_size = size;
+	while( m_views.size( ) > m_size ) {
+		m_views.back( )->Destroy( );
+		m_views.pop_back( );
+	}
+}
+
+size_t webview_pool_t::available( ) const noexcept {
+	return m_views.size( );
+}
@@ -0,0 +1,264 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <boost/crc.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "zip_archive.h"
+
+namespace {
+	constexpr uint32_t const local_header_signature = 0x04034b50;
+	constexpr uint32_t const directory_signature = 0x02014b50;
+	constexpr uint32_t const end_signature = 0x06054b50;
+	constexpr uint32_t const zip64_locator_signature = 0x07064b50;
+	constexpr uint32_t const zip64_end_signature = 0x06064b50;
+	constexpr uint16_t const zip64_extra_id = 0x0001;
+
+	constexpr size_t const local_header_size = 30;
+	constexpr size_t const directory_header_size = 46;
+	constexpr size_t const end_size = 22;
+	constexpr size_t const zip64_locator_size = 20;
+	constexpr size_t const zip64_end_size = 56;
+	constexpr size_t const max_comment_size = 0xFFFF;
+
+	constexpr uint16_t const method_stored = 0;
+	constexpr uint16_t const method_deflated = 8;
+	constexpr uint16_t const flag_encrypted = 0x0001;
+
+	// Only members up to this size are kept once inflated
+	constexpr uint64_t const max_cached_inflate_size = 1024 * 1024;
+
+	// Little endian fields regardless of the host
+	class reader_t {
+		char const *m_data;
+		size_t m_size;
+
+	  public:
+		reader_t( char const *data, size_t size ) : m_data{data}, m_size{size} {}
+
+		void check( uint64_t offset, uint64_t count ) const {
+			if( offset > m_size || count > m_size - offset ) {
+				throw zip_archive_error{"Zip archive is truncated or corrupt"};
+			}
+		}
+
+		template<typename T>
+		T get( uint64_t offset ) const {
+			check( offset, sizeof( T ) );
+			uint64_t result = 0;
+			for( size_t n = 0; n < sizeof( T ); ++n ) {
+				result |= static_cast<uint64_t>( static_cast<unsigned char>( m_data[offset + n] ) ) << ( 8 * n );
+			}
+			return static_cast<T>( result );
+		}
+
+		boost::string_view view( uint64_t offset, uint64_t count ) const {
+			check( offset, count );
+			return boost::string_view{m_data + offset, static_cast<size_t>( count )};
+		}
+	};
+} // namespace
+
+zip_archive_error::zip_archive_error( std::string const &message ) : std::runtime_error{message} {}
+
+zip_archive_error::~zip_archive_error( ) {}
+
+char const *zip_blob_t::data( ) const noexcept {
+	return contents.data( );
+}
+
+size_t zip_blob_t::size( ) const noexcept {
+	return contents.size( );
+}
+
+zip_archive_t::zip_archive_t( std::string const &path, size_t inflated_cache_size )
+    : m_file{}, m_members{}, m_inflated{inflated_cache_size} {
+
+	try {
+		m_file = std::make_shared<boost::iostreams::mapped_file_source>( path );
+	} catch( std::exception const &ex ) {
+		throw zip_archive_error{"Error opening zip archive; path='" + path + "', message='" + ex.what( ) + "'"};
+	}
+	read_directory( );
+}
+
+zip_archive_t::~zip_archive_t( ) {}
+
+void zip_archive_t::read_directory( ) {
+	reader_t const file{m_file->data( ), m_file->size( )};
+	auto const file_size = static_cast<uint64_t>( m_file->size( ) );
+	if( file_size < end_size ) {
+		throw zip_archive_error{"Not a zip archive"};
+	}
+
+	// The end record is last, followed only by a comment of up to 64k
+	auto end = file_size - end_size;
+	auto const search_end = end > max_comment_size ? end - max_comment_size : 0;
+	while( file.get<uint32_t>( end ) != end_signature ) {
+		if( end == search_end ) {
+			throw zip_archive_error{"Not a zip archive"};
+		}
+		--end;
+	}
+	uint64_t count = file.get<uint16_t>( end + 10 );
+	uint64_t directory_size = file.get<uint32_t>( end + 12 );
+	uint64_t directory_offset = file.get<uint32_t>( end + 16 );
+
+	if( end >= zip64_locator_size && file.get<uint32_t>( end - zip64_locator_size ) == zip64_locator_signature ) {
+		auto const zip64_end = file.get<uint64_t>( end - zip64_locator_size + 8 );
+		file.check( zip64_end, zip64_end_size );
+		if( file.get<uint32_t>( zip64_end ) != zip64_end_signature ) {
+			throw zip_archive_error{"Zip64 end of central directory is corrupt"};
+		}
+		count = file.get<uint64_t>( zip64_end + 32 );
+		directory_size = file.get<uint64_t>( zip64_end + 40 );
+		directory_offset = file.get<uint64_t>( zip64_end + 48 );
+	}
+	file.check( directory_offset, directory_size );
+	// Every record is at least a header, so a corrupt count cannot reserve much
+	m_members.reserve( static_cast<size_t>( std::min( count, directory_size / directory_header_size ) ) );
+
+	auto pos = directory_offset;
+	for( uint64_t n = 0; n < count; ++n ) {
+		if( file.get<uint32_t>( pos ) != directory_signature ) {
+			throw zip_archive_error{"Zip central directory is corrupt"};
+		}
+		auto const flags = file.get<uint16_t>( pos + 8 );
+		member_t member{0,
+		                file.get<uint32_t>( pos + 20 ),
+		                file.get<uint32_t>( pos + 24 ),
+		                file.get<uint32_t>( pos + 16 ),
+		                file.get<uint16_t>( pos + 10 )};
+		auto const name_size = file.get<uint16_t>( pos + 28 );
+		auto const extra_size = file.get<uint16_t>( pos + 30 );
+		auto const comment_size = file.get<uint16_t>( pos + 32 );
+		uint64_t local_offset = file.get<uint32_t>( pos + 42 );
+		auto const name = file.view( pos + directory_header_size, name_size );
+
+		// Zip64 sizes and offset follow in this order, each only if its 32 bit field is saturated
+		auto extra = pos + directory_header_size + name_size;
+		auto const extra_end = extra + extra_size;
+		while( extra + 4 <= extra_end ) {
+			auto const id = file.get<uint16_t>( extra );
+			auto const size = file.get<uint16_t>( extra + 2 );
+			if( id == zip64_extra_id ) {
+				auto field = extra + 4;
+				for( auto value : {&member.size, &member.compressed_size, &local_offset} ) {
+					if( *value == std::numeric_limits<uint32_t>::max( ) && field + 8 <= extra + 4 + size ) {
+						*value = file.get<uint64_t>( field );
+						field += 8;
+					}
+				}
+			}
+			extra += 4 + size;
+		}
+		pos = extra_end + comment_size;
+
+		// Directories and encrypted members are not served
+		if( name.empty( ) || name.back( ) == '/' || ( flags & flag_encrypted ) != 0 ) {
+			continue;
+		}
+		if( file.get<uint32_t>( local_offset ) != local_header_signature ) {
+			throw zip_archive_error{"Zip local header is corrupt; name='" + name.to_string( ) + "'"};
+		}
+		member.data_offset = local_offset + local_header_size + file.get<uint16_t>( local_offset + 26 ) +
+		                     file.get<uint16_t>( local_offset + 28 );
+		file.check( member.data_offset, member.compressed_size );
+		m_members.emplace( name, member );
+	}
+}
+
+std::shared_ptr<std::string const> zip_archive_t::inflate( boost::string_view name, member_t const &member ) const {
+	namespace io = boost::iostreams;
+	auto result = std::make_shared<std::string>( );
+	result->reserve( static_cast<size_t>( std::min( member.size, member.compressed_size * 1032 ) ) );
+	try {
+		io::zlib_params params;
+		// Zip members are raw deflate streams
+		params.noheader = true;
+		io::filtering_istream in;
+		in.push( io::zlib_decompressor{params} );
+		in.push( io::array_source{m_file->data( ) + member.data_offset, static_cast<size_t>( member.compressed_size )} );
+		io::copy( in, io::back_inserter( *result ) );
+	} catch( std::exception const &ex ) {
+		throw zip_archive_error{"Error inflating zip member; name='" + name.to_string( ) + "', message='" +
+		                        ex.what( ) + "'"};
+	}
+	boost::crc_32_type crc;
+	crc.process_bytes( result->data( ), result->size( ) );
+	if( result->size( ) != member.size || crc.checksum( ) != member.crc ) {
+		throw zip_archive_error{"Zip member failed its crc check; name='" + name.to_string( ) + "'"};
+	}
+	return result;
+}
+
+boost::optional<zip_blob_t> zip_archive_t::read( boost::string_view name ) {
+	auto const pos = m_members.find( name );
+	if( pos == m_members.end( ) ) {
+		return boost::none;
+	}
+	auto const &member = pos->second;
+	switch( member.method ) {
+	case method_stored:
+		if( member.compressed_size != member.size ) {
+			throw zip_archive_error{"Stored zip member has mismatched sizes; name='" + name.to_string( ) + "'"};
+		}
+		return zip_blob_t{boost::string_view{m_file->data( ) + member.data_offset, static_cast<size_t>( member.size )},
+		                  m_file};
+	case method_deflated: {
+		auto cached = m_inflated.find( name );
+		if( cached ) {
+			return zip_blob_t{boost::string_view{**cached}, *cached};
+		}
+		auto inflated = inflate( name, member );
+		if( member.size <= max_cached_inflate_size ) {
+			m_inflated.insert( name, inflated );
+		}
+		return zip_blob_t{boost::string_view{*inflated}, inflated};
+	}
+	default:
+		throw zip_archive_error{"Unsupported zip compression method " + std::to_string( member.method ) +
+		                        "; name='" + name.to_string( ) + "'"};
+	}
+}
+
+std::vector<std::string> zip_archive_t::names( ) const {
+	std::vector<std::string> result;
+	result.reserve( m_members.size( ) );
+	for( auto const &member : m_members ) {
+		result.push_back( member.first.to_string( ) );
+	}
+	std::sort( result.begin( ), result.end( ) );
+	return result;
+}
+
+size_t zip_archive_t::size( ) const noexcept {
+	return m_members.size( );
+}